@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+
+// Numeros aleatorios por contador para los generadores de grafos y mallas.
+//
+// Cada valor es una funcion pura de (semilla, flujo, indice): el indice k de un
+// flujo es el k-esimo valor de splitmix64 arrancado en una clave que mezcla la
+// semilla con el flujo. No hay estado que avance, asi que cada hilo puede
+// generar su rango de nodos o su banda de filas en cualquier orden y el
+// resultado es el mismo bit a bit para una semilla, con 1 o con 64 hilos.
+//
+// Los flujos separan los usos de una misma semilla (posiciones, pesos,
+// obstaculos...) para que agregar un sorteo en uno no cambie los demas.
+
+inline uint64_t mezclar_splitmix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+class FlujoAleatorio {
+private:
+    static constexpr uint64_t DORADO = 0x9E3779B97F4A7C15ull;
+    uint64_t clave;
+
+public:
+    FlujoAleatorio(uint64_t semilla, uint32_t flujo)
+        : clave(mezclar_splitmix(semilla * DORADO + mezclar_splitmix(flujo + DORADO))) {}
+
+    // 64 bits para el indice dado
+    uint64_t operator()(uint64_t indice) const {
+        return mezclar_splitmix(clave + (indice + 1) * DORADO);
+    }
+
+    // Uniforme en [0, 1) con 53 bits
+    double uniforme(uint64_t indice) const {
+        return ((*this)(indice) >> 11) * 0x1.0p-53;
+    }
+
+    // Uniforme en [0, n) por multiplicacion (sin el sesgo de %)
+    uint32_t entero(uint64_t indice, uint32_t n) const {
+        return (uint32_t)((((*this)(indice) >> 32) * n) >> 32);
+    }
+
+    // Uniforme en [minimo, maximo]
+    int rango(uint64_t indice, int minimo, int maximo) const {
+        return minimo + (int)entero(indice, (uint32_t)(maximo - minimo + 1));
+    }
+};
@@ -1,26 +1,56 @@
 #pragma once
 #include "grafo_arequipa.h"
 #include "estructuras.h"
+#include "busqueda_generica.h"
 #include <cmath>
 /*Plantilla de los algoritmos */
 
+/*Vista del mapa de Arequipa para las busquedas genericas (busqueda_generica.h)*/
+inline VistaCSR<double> vista_arequipa() {
+    return { OFFSET, NEIGHBOR, WEIGHT, POS_X, POS_Y, NODE_COUNT };
+}
+
+/*Motor de busqueda reentrante: guarda sus colas y arreglos de trabajo y los
+  reutiliza entre consultas. No comparte estado, asi que varios hilos pueden
+  buscar en paralelo con un motor cada uno. Cada metodo se define en el .cpp
+  de su algoritmo.*/
+class MotorBusquedaArequipa {
+private:
+    EspacioBusqueda espacio;
+    ColaInt cola;
+    PilaInt pila;
+    ColaPrioridad cola_prioridad;
+
+public:
+    void bfs(int origen, int destino, ResultadoRuta& ruta);
+    void dfs(int origen, int destino, ResultadoRuta& ruta);
+    void best_first(int origen, int destino, ResultadoRuta& ruta);
+    void a_estrella(int origen, int destino, ResultadoRuta& ruta);
+    void dijkstra(int origen, int destino, ResultadoRuta& ruta);
+};
+
+/*Motor propio de cada hilo que usan las funciones buscar_* */
+inline MotorBusquedaArequipa& motor_del_hilo() {
+    static thread_local MotorBusquedaArequipa motor;
+    return motor;
+}
+
 
 /*algoritmo BFS*/
-void buscar_BFS(int origen, int destino, int camino[], int& largo);
+void buscar_BFS(int origen, int destino, ResultadoRuta& ruta);
 
 /*algoritmo DFS*/ 
-void buscar_DFS(int origen, int destino, int camino[], int& largo);
-void dfs(int actual, int destino, bool visitado[], int anterior[]);
+void buscar_DFS(int origen, int destino, ResultadoRuta& ruta);
 
 /*algoritmo Best first search*/ 
-void buscar_BestFirst(int origen, int destino, int camino[], int& largo);
+void buscar_BestFirst(int origen, int destino, ResultadoRuta& ruta);
 
 /*algoritmo A* */ 
-void buscar_AStar(int origen, int destino, int camino[], int& largo);
+void buscar_AStar(int origen, int destino, ResultadoRuta& ruta);
 
 /*algoritmo Dijkstra*/ 
-void buscar_DIJKSTRA(int origen, int destino, int camino[], int& largo);
+void buscar_DIJKSTRA(int origen, int destino, ResultadoRuta& ruta);
 
 float heuristica(int nodo, int destino);
 
-void intercambiar(int& a, int& b);
\ No newline at end of file
+void intercambiar(int& a, int& b);
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include "arena.h"
+#include <atomic>
+#include <new>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+const size_t PAGINA_GRANDE = (size_t)2 << 20;
+
+atomic<size_t> tam_bloque_arenas{TAM_BLOQUE_ARENA};
+atomic<bool> paginas_grandes_arenas{false};
+
+size_t redondear(size_t bytes, size_t multiplo) {
+    return (bytes + multiplo - 1) / multiplo * multiplo;
+}
+
+} // namespace
+
+ArenaBusqueda::ArenaBusqueda(size_t tam_bloque, bool paginas_grandes)
+    : tam_bloque(tam_bloque), paginas_grandes(paginas_grandes) {}
+
+ArenaBusqueda::~ArenaBusqueda() {
+    registrar_liberacion(bytes_vivos);
+    Bloque* bloque = primero;
+    while (bloque) {
+        Bloque* siguiente = bloque->siguiente;
+        desmapear_bloque(bloque);
+        bloque = siguiente;
+    }
+}
+
+// Pide al sistema un bloque con al menos 'minimo' bytes utiles. Con paginas
+// grandes el tamano se redondea a 2 MB y se sugiere THP al kernel (madvise);
+// si el kernel no las da, el bloque sigue funcionando con paginas normales.
+ArenaBusqueda::Bloque* ArenaBusqueda::mapear_bloque(size_t minimo) {
+    size_t tam = minimo + CABECERA_BLOQUE;
+    if (tam < tam_bloque) tam = tam_bloque;
+
+    void* memoria = nullptr;
+#ifdef _WIN32
+    tam = redondear(tam, 64 * 1024);
+    memoria = VirtualAlloc(nullptr, tam, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if (!memoria) throw bad_alloc();
+#else
+    tam = redondear(tam, paginas_grandes ? PAGINA_GRANDE : (size_t)sysconf(_SC_PAGESIZE));
+    memoria = mmap(nullptr, tam, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memoria == MAP_FAILED) throw bad_alloc();
+#ifdef MADV_HUGEPAGE
+    if (paginas_grandes) madvise(memoria, tam, MADV_HUGEPAGE);
+#endif
+#endif
+    registrar_llamada_asignador();
+
+    Bloque* bloque = static_cast<Bloque*>(memoria);
+    bloque->siguiente = nullptr;
+    bloque->capacidad = tam - CABECERA_BLOQUE;
+    bloque->tam_mapeo = tam;
+    return bloque;
+}
+
+void ArenaBusqueda::desmapear_bloque(Bloque* bloque) {
+#ifdef _WIN32
+    VirtualFree(bloque, 0, MEM_RELEASE);
+#else
+    munmap(bloque, bloque->tam_mapeo);
+#endif
+}
+
+// Camino lento: el bloque actual no alcanza. Se pasa al siguiente bloque ya
+// mapeado si tiene espacio; si no, se mapea uno nuevo y se inserta despues del
+// actual (los siguientes se conservan para consultas futuras).
+void* ArenaBusqueda::reservar_en_otro_bloque(size_t bytes, size_t alineacion) {
+    Bloque* siguiente = actual ? actual->siguiente : primero;
+    if (!siguiente || alinear(siguiente, 0, alineacion) + bytes > siguiente->capacidad) {
+        Bloque* nuevo = mapear_bloque(bytes + alineacion);
+        nuevo->siguiente = siguiente;
+        if (actual) {
+            actual->siguiente = nuevo;
+        } else {
+            primero = nuevo;
+        }
+        siguiente = nuevo;
+    }
+
+    actual = siguiente;
+    size_t inicio = alinear(actual, 0, alineacion);
+    usado = inicio + bytes;
+    bytes_vivos += bytes;
+    registrar_uso(bytes);
+    return datos(actual) + inicio;
+}
+
+size_t ArenaBusqueda::bytes_mapeados() const {
+    size_t total = 0;
+    for (Bloque* bloque = primero; bloque; bloque = bloque->siguiente) {
+        total += bloque->tam_mapeo;
+    }
+    return total;
+}
+
+int ArenaBusqueda::num_bloques() const {
+    int total = 0;
+    for (Bloque* bloque = primero; bloque; bloque = bloque->siguiente) {
+        total++;
+    }
+    return total;
+}
+
+void configurar_arenas(size_t tam_bloque, bool paginas_grandes) {
+    tam_bloque_arenas.store(tam_bloque, memory_order_relaxed);
+    paginas_grandes_arenas.store(paginas_grandes, memory_order_relaxed);
+}
+
+ArenaBusqueda& arena_del_hilo() {
+    static thread_local ArenaBusqueda arena(tam_bloque_arenas.load(memory_order_relaxed),
+                                            paginas_grandes_arenas.load(memory_order_relaxed));
+    return arena;
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include "memoria.h"
+#include <cstddef>
+#include <cstdint>
+
+// Arena de memoria temporal por hilo para las busquedas.
+//
+// Reservar es avanzar un puntero dentro de un bloque grande. Una consulta toma
+// un punto de control al empezar y lo restaura al terminar (AlcanceArena): todo
+// lo reservado desde entonces queda libre en O(1), sin recorrer nada. Los
+// bloques no se devuelven al sistema hasta que termina el hilo, asi que a partir
+// de la primera consulta (la mas grande, en rigor) las busquedas no llaman al
+// asignador global ni tocan paginas nuevas.
+//
+// La memoria reservada no se inicializa. Lo vivo en la arena se suma al
+// contador de memoria temporal del hilo (memoria.h); pedir un bloque nuevo al
+// sistema cuenta como una asignacion.
+
+constexpr size_t ALINEACION_ARENA = 64;               // Linea de cache
+constexpr size_t TAM_BLOQUE_ARENA = (size_t)32 << 20; // 32 MB
+
+class ArenaBusqueda {
+private:
+    // Cabecera al inicio de cada bloque; los datos empiezan en CABECERA_BLOQUE
+    struct Bloque {
+        Bloque* siguiente;
+        size_t capacidad;        // Bytes utiles despues de la cabecera
+        size_t tam_mapeo;        // Bytes pedidos al sistema (incluye la cabecera)
+    };
+    static constexpr size_t CABECERA_BLOQUE = 64;
+
+    Bloque* primero = nullptr;
+    Bloque* actual = nullptr;    // nullptr: todavia no se uso ningun bloque
+    size_t usado = 0;            // Bytes ocupados en 'actual'
+    size_t bytes_vivos = 0;      // Bytes entregados y no restaurados
+    size_t tam_bloque;
+    bool paginas_grandes;
+
+    static char* datos(Bloque* bloque) {
+        return reinterpret_cast<char*>(bloque) + CABECERA_BLOQUE;
+    }
+
+    // Posicion alineada dentro del bloque para un puntero a partir de 'desde'
+    static size_t alinear(Bloque* bloque, size_t desde, size_t alineacion) {
+        uintptr_t dir = reinterpret_cast<uintptr_t>(datos(bloque)) + desde;
+        uintptr_t alineada = (dir + alineacion - 1) & ~(uintptr_t)(alineacion - 1);
+        return desde + (alineada - dir);
+    }
+
+    Bloque* mapear_bloque(size_t minimo);
+    static void desmapear_bloque(Bloque* bloque);
+    void* reservar_en_otro_bloque(size_t bytes, size_t alineacion);
+
+public:
+    struct PuntoControl {
+        Bloque* bloque;
+        size_t usado;
+        size_t bytes_vivos;
+    };
+
+    explicit ArenaBusqueda(size_t tam_bloque = TAM_BLOQUE_ARENA, bool paginas_grandes = false);
+    ~ArenaBusqueda();
+
+    ArenaBusqueda(const ArenaBusqueda&) = delete;
+    ArenaBusqueda& operator=(const ArenaBusqueda&) = delete;
+
+    // 'alineacion' debe ser potencia de 2 (como maximo el tamano de pagina)
+    void* reservar_bytes(size_t bytes, size_t alineacion = ALINEACION_ARENA) {
+        if (actual) {
+            size_t inicio = alinear(actual, usado, alineacion);
+            if (inicio + bytes <= actual->capacidad) {
+                usado = inicio + bytes;
+                bytes_vivos += bytes;
+                registrar_uso(bytes);
+                return datos(actual) + inicio;
+            }
+        }
+        return reservar_en_otro_bloque(bytes, alineacion);
+    }
+
+    template<typename T>
+    T* reservar(size_t cantidad, size_t alineacion = ALINEACION_ARENA) {
+        if (alineacion < alignof(T)) alineacion = alignof(T);
+        return static_cast<T*>(reservar_bytes(cantidad * sizeof(T), alineacion));
+    }
+
+    PuntoControl marca() const {
+        return { actual, usado, bytes_vivos };
+    }
+
+    // Libera todo lo reservado despues de 'punto' (los bloques se conservan)
+    void restaurar(const PuntoControl& punto) {
+        registrar_liberacion(bytes_vivos - punto.bytes_vivos);
+        actual = punto.bloque;
+        usado = punto.usado;
+        bytes_vivos = punto.bytes_vivos;
+    }
+
+    size_t bytes_en_uso() const { return bytes_vivos; }
+    size_t bytes_mapeados() const;
+    int num_bloques() const;
+    bool usa_paginas_grandes() const { return paginas_grandes; }
+};
+
+// Restaura la arena al salir del alcance: una por consulta
+class AlcanceArena {
+private:
+    ArenaBusqueda& arena;
+    ArenaBusqueda::PuntoControl punto;
+
+public:
+    explicit AlcanceArena(ArenaBusqueda& arena) : arena(arena), punto(arena.marca()) {}
+    ~AlcanceArena() { arena.restaurar(punto); }
+
+    AlcanceArena(const AlcanceArena&) = delete;
+    AlcanceArena& operator=(const AlcanceArena&) = delete;
+};
+
+// Configuracion de las arenas que se creen despues de la llamada (cada hilo
+// crea la suya en su primer uso de arena_del_hilo()).
+void configurar_arenas(size_t tam_bloque, bool paginas_grandes);
+
+ArenaBusqueda& arena_del_hilo();
@@ -0,0 +1,9 @@
+#include "algoritmos.h"
+
+void MotorBusquedaArequipa::bfs(int origen, int destino, ResultadoRuta& ruta) {
+    buscar_bfs(vista_arequipa(), cola, espacio, origen, destino, ruta);
+}
+
+void buscar_BFS(int origen, int destino, ResultadoRuta& ruta) {
+    motor_del_hilo().bfs(origen, destino, ruta);
+}
@@ -0,0 +1,270 @@
+#include "bfs_bits_malla.h"
+#include "arena.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// Cada fila de los mapas de bits: 4 palabras de guarda en 0 y despues los
+// datos, rellenados a multiplo de 4 palabras. Hay una fila de guarda arriba y
+// otra abajo, asi el nucleo lee w - 1, w + 1, y - 1 e y + 1 sin comprobar bordes.
+static const int GUARDA = 4;
+
+// Operaciones sobre una palabra (Escalar) o cuatro (Avx2). mas_x mueve cada
+// celda a x + 1 (el bit 63 pasa a la palabra siguiente) y menos_x a x - 1.
+struct Escalar {
+    using T = uint64_t;
+    static constexpr int ANCHO = 1;
+    static T cargar(const uint64_t* p) { return *p; }
+    static void guardar(uint64_t* p, T a) { *p = a; }
+    static T o(T a, T b) { return a | b; }
+    static T y(T a, T b) { return a & b; }
+    static T y_no(T a, T b) { return ~a & b; }
+    static bool vacio(T a) { return a == 0; }
+    static T mas_x(const uint64_t* r) { return (r[0] << 1) | (r[-1] >> 63); }
+    static T menos_x(const uint64_t* r) { return (r[0] >> 1) | (r[1] << 63); }
+    static T mas_x(const uint64_t* r, const uint64_t* m) { return ((r[0] & m[0]) << 1) | ((r[-1] & m[-1]) >> 63); }
+    static T menos_x(const uint64_t* r, const uint64_t* m) { return ((r[0] & m[0]) >> 1) | ((r[1] & m[1]) << 63); }
+};
+
+#ifdef __AVX2__
+struct Avx2 {
+    using T = __m256i;
+    static constexpr int ANCHO = 4;
+    static T cargar(const uint64_t* p) { return _mm256_loadu_si256((const __m256i*)p); }
+    static void guardar(uint64_t* p, T a) { _mm256_storeu_si256((__m256i*)p, a); }
+    static T o(T a, T b) { return _mm256_or_si256(a, b); }
+    static T y(T a, T b) { return _mm256_and_si256(a, b); }
+    static T y_no(T a, T b) { return _mm256_andnot_si256(a, b); }
+    static bool vacio(T a) { return _mm256_testz_si256(a, a); }
+    static T mas_x(const uint64_t* r) {
+        return o(_mm256_slli_epi64(cargar(r), 1), _mm256_srli_epi64(cargar(r - 1), 63));
+    }
+    static T menos_x(const uint64_t* r) {
+        return o(_mm256_srli_epi64(cargar(r), 1), _mm256_slli_epi64(cargar(r + 1), 63));
+    }
+    static T mas_x(const uint64_t* r, const uint64_t* m) {
+        return o(_mm256_slli_epi64(y(cargar(r), cargar(m)), 1), _mm256_srli_epi64(y(cargar(r - 1), cargar(m - 1)), 63));
+    }
+    static T menos_x(const uint64_t* r, const uint64_t* m) {
+        return o(_mm256_srli_epi64(y(cargar(r), cargar(m)), 1), _mm256_slli_epi64(y(cargar(r + 1), cargar(m + 1)), 63));
+    }
+};
+using Vector = Avx2;
+#else
+using Vector = Escalar;
+#endif
+
+// Un grupo de Op::ANCHO palabras de una fila desde w: nueva = vecinos de la
+// frontera, libres y sin visitar; las marca como visitadas. Los punteros
+// apuntan al comienzo de los datos de la fila (la de arriba y la de abajo
+// estan a -paso y +paso). true si hay celdas nuevas.
+template<typename Op, Conectividad C>
+static inline bool expandir_grupo(const uint64_t* libre, const uint64_t* diagonal, const uint64_t* frontera,
+                                  uint64_t* nueva, uint64_t* visitado, int paso, int w) {
+    const uint64_t* arriba = frontera + w - paso;
+    const uint64_t* propia = frontera + w;
+    const uint64_t* abajo = frontera + w + paso;
+    typename Op::T vecinos;
+    if (C == Conectividad::OCHO) {
+        vecinos = Op::o(Op::o(Op::cargar(arriba), Op::cargar(abajo)), Op::o(Op::mas_x(arriba), Op::menos_x(arriba)));
+        vecinos = Op::o(vecinos, Op::o(Op::mas_x(abajo), Op::menos_x(abajo)));
+    } else {
+        vecinos = Op::o(Op::cargar(arriba), Op::cargar(abajo));
+    }
+    vecinos = Op::o(vecinos, Op::o(Op::mas_x(propia), Op::menos_x(propia)));
+    if (C == Conectividad::DIAGONALES_PARCIALES) {
+        const uint64_t* d_arriba = diagonal + w - paso;
+        const uint64_t* d_abajo = diagonal + w + paso;
+        vecinos = Op::o(vecinos, Op::o(Op::mas_x(arriba, d_arriba), Op::menos_x(arriba, d_arriba)));
+        vecinos = Op::o(vecinos, Op::o(Op::mas_x(abajo, d_abajo), Op::menos_x(abajo, d_abajo)));
+    }
+    typename Op::T ya = Op::cargar(visitado + w);
+    typename Op::T n = Op::y_no(ya, Op::y(vecinos, Op::cargar(libre + w)));
+    Op::guardar(nueva + w, n);
+    if (Op::vacio(n)) return false;
+    Op::guardar(visitado + w, Op::o(ya, n));
+    return true;
+}
+
+BfsBitsMalla::BfsBitsMalla(const MallaImplicita& malla)
+    : ancho(malla.get_ancho()), alto(malla.get_alto()), palabras_fila(malla.get_palabras_fila()),
+      paso(GUARDA + ((malla.get_palabras_fila() + 3) & ~3)) {
+    libres.assign(palabras_totales(), 0);
+    diagonales.assign(palabras_totales(), 0);
+    const uint64_t* bits = malla.get_bits();
+    #pragma omp parallel for schedule(static)
+    for (int y = 0; y < alto; ++y) {
+        memcpy(&libres[(size_t)(y + 1) * paso + GUARDA], bits + (size_t)y * palabras_fila,
+               palabras_fila * sizeof(uint64_t));
+    }
+    // Regla del CSR: diagonales desde la celda con (id + x + y) par. La paridad
+    // del id (celdas libres anteriores, en orden de filas) sale de un XOR
+    // prefijo dentro de la palabra mas la que arrastran las anteriores.
+    uint64_t arrastre = 0;
+    for (int y = 0; y < alto; ++y) {
+        const uint64_t impar_xy = (y & 1) ? 0x5555555555555555ull : 0xAAAAAAAAAAAAAAAAull;
+        for (int w = 0; w < palabras_fila; ++w) {
+            const size_t i = (size_t)(y + 1) * paso + GUARDA + w;
+            const uint64_t b = libres[i];
+            uint64_t prefijo = b;
+            for (int s = 1; s < 64; s <<= 1) prefijo ^= prefijo << s;
+            const uint64_t impar_id = (prefijo ^ b) ^ (0 - arrastre);
+            diagonales[i] = b & ~(impar_id ^ impar_xy);
+            arrastre ^= __builtin_popcountll(b) & 1;
+        }
+    }
+}
+
+template<Conectividad C>
+ResultadoBfsBits BfsBitsMalla::recorrer(int origen, int destino, int* distancia, int hilos) const {
+    ResultadoBfsBits resultado;
+    const int celdas = ancho * alto;
+    if (distancia) {
+        #pragma omp parallel for num_threads(hilos) schedule(static)
+        for (int c = 0; c < celdas; ++c) distancia[c] = -1;
+    }
+    auto indice = [&](int celda) {
+        return (size_t)(celda / ancho + 1) * paso + GUARDA + (celda % ancho >> 6);
+    };
+    auto bit = [&](int celda) { return 1ull << (celda % ancho & 63); };
+    if (origen < 0 || origen >= celdas || !(libres[indice(origen)] & bit(origen))) return resultado;
+    if (destino >= celdas) destino = -1;
+
+    // Mapas de bits de celdas y, por fila, resumenes con un bit por palabra no
+    // nula. Cada nivel solo recorre las palabras junto a la frontera (las
+    // vecinas de las marcadas en su fila y en las de al lado) y las que quedaron
+    // escritas en 'nueva' de la frontera anterior, para limpiarlas.
+    ArenaBusqueda& arena = arena_del_hilo();
+    AlcanceArena alcance(arena);
+    const size_t total = palabras_totales();
+    const int palabras_datos = paso - GUARDA;
+    const int por_resumen = (palabras_datos + 63) / 64;
+    const size_t total_resumen = (size_t)(alto + 2) * por_resumen;
+    const uint64_t ultimo_resumen = palabras_datos % 64 ? (1ull << (palabras_datos % 64)) - 1 : ~0ull;
+    uint64_t* frontera = arena.reservar<uint64_t>(total);
+    uint64_t* nueva = arena.reservar<uint64_t>(total);
+    uint64_t* visitado = arena.reservar<uint64_t>(total);
+    uint64_t* activas = arena.reservar<uint64_t>(total_resumen);      // De frontera
+    uint64_t* anteriores = arena.reservar<uint64_t>(total_resumen);   // De lo que queda en nueva
+    uint64_t* siguientes = arena.reservar<uint64_t>(total_resumen);
+    memset(frontera, 0, total * sizeof(uint64_t));
+    memset(nueva, 0, total * sizeof(uint64_t));
+    memset(visitado, 0, total * sizeof(uint64_t));
+    memset(activas, 0, total_resumen * sizeof(uint64_t));
+    memset(anteriores, 0, total_resumen * sizeof(uint64_t));
+    memset(siguientes, 0, total_resumen * sizeof(uint64_t));
+
+    frontera[indice(origen)] |= bit(origen);
+    visitado[indice(origen)] |= bit(origen);
+    const int oy = origen / ancho, ow = origen % ancho >> 6;
+    activas[(size_t)(oy + 1) * por_resumen + ow / 64] |= 1ull << (ow % 64);
+    resultado.alcanzadas = 1;
+    if (distancia) distancia[origen] = 0;
+    if (origen == destino) {
+        resultado.saltos = 0;
+        return resultado;
+    }
+
+    // Filas de la frontera actual y de la anterior
+    int fy0 = oy, fy1 = oy, py0 = oy, py1 = oy;
+    for (int nivel = 1;; ++nivel) {
+        const int y0 = max(0, min(fy0 - 1, py0));
+        const int y1 = min(alto - 1, max(fy1 + 1, py1));
+        int ny0 = INT_MAX, ny1 = -1;
+        int64_t nuevas = 0;
+        #pragma omp parallel for num_threads(hilos) schedule(static) if (hilos > 1 && y1 - y0 >= 32) \
+            reduction(min : ny0) reduction(max : ny1) reduction(+ : nuevas)
+        for (int y = y0; y <= y1; ++y) {
+            const size_t base = (size_t)(y + 1) * paso + GUARDA;
+            const uint64_t* arriba = activas + (size_t)y * por_resumen;
+            const uint64_t* propia = arriba + por_resumen;
+            const uint64_t* abajo = propia + por_resumen;
+            uint64_t* salida = siguientes + (size_t)(y + 1) * por_resumen;
+            uint64_t acarreo = 0;
+            bool fila_nueva = false;
+            for (int r = 0; r < por_resumen; ++r) {
+                const uint64_t m = arriba[r] | propia[r] | abajo[r];
+                const uint64_t siguiente = r + 1 < por_resumen ? arriba[r + 1] | propia[r + 1] | abajo[r + 1] : 0;
+                uint64_t candidatas = m | (m << 1) | acarreo | (m >> 1) | (siguiente << 63);
+                candidatas |= anteriores[(size_t)(y + 1) * por_resumen + r];
+                if (r + 1 == por_resumen) candidatas &= ultimo_resumen;
+                acarreo = m >> 63;
+                if (Vector::ANCHO == 4) {
+                    // Un bit por grupo de 4 palabras, en la primera
+                    candidatas |= candidatas >> 1;
+                    candidatas |= candidatas >> 2;
+                    candidatas &= 0x1111111111111111ull;
+                }
+                uint64_t marcadas = 0;
+                for (; candidatas; candidatas &= candidatas - 1) {
+                    const int w = r * 64 + __builtin_ctzll(candidatas);
+                    if (!expandir_grupo<Vector, C>(&libres[base], &diagonales[base], frontera + base,
+                                                   nueva + base, visitado + base, paso, w)) continue;
+                    for (int k = w; k < w + Vector::ANCHO; ++k) {
+                        uint64_t palabra = nueva[base + k];
+                        if (!palabra) continue;
+                        marcadas |= 1ull << (k % 64);
+                        nuevas += __builtin_popcountll(palabra);
+                        if (!distancia) continue;
+                        int* fila_distancia = distancia + (size_t)y * ancho + k * 64;
+                        for (; palabra; palabra &= palabra - 1) fila_distancia[__builtin_ctzll(palabra)] = nivel;
+                    }
+                }
+                salida[r] = marcadas;
+                fila_nueva |= marcadas != 0;
+            }
+            if (fila_nueva) {
+                ny0 = min(ny0, y);
+                ny1 = max(ny1, y);
+            }
+        }
+        if (nuevas == 0) break;
+        resultado.niveles = nivel;
+        resultado.alcanzadas += nuevas;
+        // Lo de la frontera anterior en 'nueva' ya se piso; su resumen pasa a ser
+        // el de la proxima salida y se limpia
+        swap(frontera, nueva);
+        uint64_t* libre_resumen = anteriores;
+        anteriores = activas;
+        activas = siguientes;
+        siguientes = libre_resumen;
+        memset(siguientes + (size_t)(py0 + 1) * por_resumen, 0, (size_t)(py1 - py0 + 1) * por_resumen * sizeof(uint64_t));
+        py0 = fy0, py1 = fy1;
+        fy0 = ny0, fy1 = ny1;
+        if (destino >= 0 && (frontera[indice(destino)] & bit(destino))) {
+            resultado.saltos = nivel;
+            break;
+        }
+    }
+    return resultado;
+}
+
+ResultadoBfsBits BfsBitsMalla::despachar(Conectividad conectividad, int origen, int destino, int* distancia,
+                                         int hilos) const {
+    hilos = max(1, hilos);
+    switch (conectividad) {
+        case Conectividad::CUATRO:
+            return recorrer<Conectividad::CUATRO>(origen, destino, distancia, hilos);
+        case Conectividad::OCHO:
+            return recorrer<Conectividad::OCHO>(origen, destino, distancia, hilos);
+        default:
+            return recorrer<Conectividad::DIAGONALES_PARCIALES>(origen, destino, distancia, hilos);
+    }
+}
+
+ResultadoBfsBits BfsBitsMalla::saltos(Conectividad conectividad, int origen, int destino, int hilos) const {
+    return despachar(conectividad, origen, destino, nullptr, hilos);
+}
+
+ResultadoBfsBits BfsBitsMalla::distancias(Conectividad conectividad, int origen, int* distancia, int hilos) const {
+    return despachar(conectividad, origen, -1, distancia, hilos);
+}
+
+size_t BfsBitsMalla::memoria_usada() const {
+    return (libres.capacity() + diagonales.capacity()) * sizeof(uint64_t);
+}
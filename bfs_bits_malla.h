@@ -0,0 +1,63 @@
+#pragma once
+#include "malla_implicita.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// BFS por saltos sobre el mapa de bits de la malla, de a 64 celdas por palabra.
+//
+// Cada nivel es una dilatacion de la frontera: desplazamientos de un bit
+// (vecinos en x) y de una fila (vecinos en y), OR entre ellos y AND con las
+// celdas libres no visitadas. Con AVX2 se procesan 4 palabras por instruccion
+// y las filas se reparten entre hilos (OpenMP). Solo se recorre el rectangulo
+// que contiene la frontera, agrandado en una celda por nivel.
+//
+// Las conectividades son las de malla_implicita.h. DIAGONALES_PARCIALES usa
+// una segunda mascara con las celdas desde las que salen diagonales (la regla
+// del CSR solo depende de la celda de origen), asi que los saltos coinciden
+// con los de buscar_BFS_grande sobre el grafo de la malla.
+//
+// Da saltos y celdas alcanzadas, no el camino. Los arreglos de trabajo (tres
+// mapas de bits) salen de la arena del hilo; la instancia es de solo lectura y
+// se comparte entre hilos.
+//
+// distancias() no es mas rapido que el BFS de la cola: no corta en un destino,
+// asi que recorre toda la componente, y escribe un entero por celda alcanzada.
+// En la malla de 2M celdas la dilatacion sola tarda unos 23 ms y las
+// escrituras unos 10 ms mas, la mitad por fallos de cache en el arreglo de
+// 8 MB y la otra mitad por sacar los bits de a uno. Escribir las palabras con
+// maskstore de AVX2 no lo mejoro. Sirve cuando se necesitan los saltos a
+// muchas celdas desde el mismo origen; para saltos punto a punto, saltos().
+
+struct ResultadoBfsBits {
+    int saltos = -1;               // Hasta el destino (-1 = no se alcanza o no habia destino)
+    int niveles = 0;               // Niveles expandidos
+    int64_t alcanzadas = 0;        // Celdas alcanzadas, incluido el origen
+};
+
+class BfsBitsMalla {
+private:
+    int ancho, alto;
+    int palabras_fila;             // Palabras con datos por fila
+    int paso;                      // Palabras por fila con la guarda, multiplo de 4
+    std::vector<uint64_t> libres;      // (alto + 2) filas de 'paso' palabras; guardas en 0
+    std::vector<uint64_t> diagonales;  // Celdas libres desde las que salen diagonales (regla parcial)
+
+    size_t palabras_totales() const { return (size_t)(alto + 2) * paso + 4; }
+
+    template<Conectividad C>
+    ResultadoBfsBits recorrer(int origen, int destino, int* distancia, int hilos) const;
+    ResultadoBfsBits despachar(Conectividad conectividad, int origen, int destino, int* distancia,
+                               int hilos) const;
+
+public:
+    explicit BfsBitsMalla(const MallaImplicita& malla);
+
+    // Saltos de origen a destino (indices de celda); corta al llegar
+    ResultadoBfsBits saltos(Conectividad conectividad, int origen, int destino, int hilos = 1) const;
+    // distancia[celda] = saltos desde el origen, -1 si no se alcanza (ancho * alto enteros).
+    // Recorre toda la componente del origen (ver arriba)
+    ResultadoBfsBits distancias(Conectividad conectividad, int origen, int* distancia, int hilos = 1) const;
+
+    size_t memoria_usada() const;
+};
@@ -0,0 +1,296 @@
+#pragma once
+#include "busqueda_generica.h"
+#include <algorithm>
+#include <chrono>
+
+// Busquedas con cota de suboptimalidad: devuelven una ruta de costo a lo sumo
+// epsilon veces el optimo a cambio de asentar menos nodos que A*.
+//
+// La cota solo vale con una heuristica admisible y consistente (por ejemplo
+// HeuristicaEscalada sobre la euclidiana). Cada busqueda informa en ruta.cota
+// la cota que realmente alcanzo: costo / (minimo g + h que quedaba abierto),
+// que suele ser bastante menor que el epsilon pedido.
+//
+//  - buscar_ara_estrella: ARA*. Corre A* ponderado (prioridad g + eps * h) y,
+//    mientras quede tiempo, baja eps y vuelve a mejorar la ruta reutilizando g
+//    y la lista abierta de la pasada anterior: solo se reexpanden los nodos
+//    cuyo g bajo (lista INCONS). Con eps inicial == final es A* ponderado.
+//  - buscar_focal: A*_eps (Pearl y Kim). La lista FOCAL tiene los nodos abiertos
+//    con f <= eps * f_min y de ahi se expande el que parece mas cerca del
+//    destino (menor h). Reabrir cada nodo que mejora dispara la busqueda en
+//    la malla, asi que, como en ARA*, un nodo cerrado cuyo g baja queda
+//    inconsistente: su f cuenta para la cota inferior que define FOCAL y solo
+//    se reabre si FOCAL se queda sin nodos por su culpa.
+//
+// Los arreglos de trabajo salen de la arena que se pasa (un AlcanceArena por
+// consulta); las colas las pone quien llama, como en busqueda_generica.h.
+
+struct ParametrosARA {
+    float epsilon_inicial = 3.0f;   // Primera pasada
+    float epsilon_final = 1.0f;     // Cota pedida: se deja de mejorar al alcanzarla
+    float paso = 0.5f;              // Cuanto baja eps entre pasadas
+    double plazo_ms = 0.0;          // Deja de mejorar al vencer (0: sin plazo)
+};
+
+namespace busqueda_detalle {
+
+constexpr char EN_ABIERTA = 1;
+constexpr char EN_INCONS = 2;
+constexpr char JUNTADO = 4;
+
+} // namespace busqueda_detalle
+
+template<typename Grafo, typename Heuristica, typename ColaPrioridad>
+void buscar_ara_estrella(const Grafo& grafo, const Heuristica& h, ColaPrioridad& cola, ArenaBusqueda& arena,
+                         int origen, int destino, const ParametrosARA& parametros, ResultadoRuta& ruta) {
+    using namespace busqueda_detalle;
+    CONTAR_REINICIAR();
+    ruta.reiniciar();
+    const int num_nodos = grafo.num_nodos();
+    if (!nodos_validos(num_nodos, origen, destino)) return;
+
+    const auto inicio = std::chrono::steady_clock::now();
+    auto plazo_vencido = [&]() {
+        if (parametros.plazo_ms <= 0.0) return false;
+        std::chrono::duration<double, std::milli> pasado = std::chrono::steady_clock::now() - inicio;
+        return pasado.count() >= parametros.plazo_ms;
+    };
+
+    float* g = arena.reservar<float>(num_nodos);
+    int* anterior = arena.reservar<int>(num_nodos);
+    int* cerrado_en = arena.reservar<int>(num_nodos);     // Pasada en que se expandio (0: nunca)
+    char* estado = arena.reservar<char>(num_nodos);
+    int* lista = arena.reservar<int>(num_nodos);          // INCONS y, al cerrar la pasada, tambien la abierta
+    for (int i = 0; i < num_nodos; ++i) {
+        g[i] = 1e9f;
+        anterior[i] = -1;
+        cerrado_en[i] = 0;
+        estado[i] = 0;
+    }
+
+    const float epsilon_final = std::max(1.0f, parametros.epsilon_final);
+    float eps = std::max(epsilon_final, parametros.epsilon_inicial);
+    int pasada = 1;
+    g[origen] = 0.0f;
+    estado[origen] = EN_ABIERTA;
+    cola.limpiar();
+    cola.insertar(origen, eps * h(origen));
+    CONTAR(inserciones_cola);
+
+    bool agotado = false, vencido = false, hay_ruta = false;
+    float cota = 0.0f;
+    int asentados = 0;
+    while (true) {
+        // Mejorar la ruta con este eps: expandir mientras algo abierto la pueda acortar
+        int num_incons = 0;
+        while (!cola.vacia() && cola.prioridad_min() < g[destino] + eps * h(destino)) {
+            int actual = cola.extraer_min();
+            CONTAR(nodos_extraidos);
+            if (!(estado[actual] & EN_ABIERTA)) {
+                CONTAR(extracciones_obsoletas);
+                continue;
+            }
+            if (ruta.presupuesto_agotado(asentados)) {
+                agotado = true;
+                break;
+            }
+            if (hay_ruta && (asentados & 255) == 0 && plazo_vencido()) {
+                vencido = true;
+                break;
+            }
+            estado[actual] &= ~EN_ABIERTA;
+            cerrado_en[actual] = pasada;
+            asentados++;
+
+            const float g_actual = g[actual];
+            grafo.para_cada_vecino(actual, [&](int vecino, float peso) {
+                CONTAR(aristas_revisadas);
+                float nuevo_g = g_actual + peso;
+                if (nuevo_g >= g[vecino]) return;
+                g[vecino] = nuevo_g;
+                anterior[vecino] = actual;
+                CONTAR(relajaciones);
+                if (cerrado_en[vecino] != pasada) {
+                    estado[vecino] |= EN_ABIERTA;
+                    cola.insertar(vecino, nuevo_g + eps * h(vecino));
+                    CONTAR(inserciones_cola);
+                    CONTAR_MAX(pico_cola, cola.tamano());
+                } else if (!(estado[vecino] & EN_INCONS)) {
+                    estado[vecino] |= EN_INCONS;
+                    lista[num_incons++] = vecino;
+                }
+            });
+        }
+        if (agotado || vencido || g[destino] >= 1e9f) break;
+        hay_ruta = true;
+
+        // Cota de la pasada: el optimo no baja del minimo g + h entre abiertos e INCONS
+        int num_pendientes = num_incons;
+        while (!cola.vacia()) {
+            int v = cola.extraer_min();
+            if ((estado[v] & EN_ABIERTA) && !(estado[v] & (EN_INCONS | JUNTADO))) {
+                estado[v] |= JUNTADO;
+                lista[num_pendientes++] = v;
+            }
+        }
+        float minimo = g[destino];
+        for (int i = 0; i < num_pendientes; ++i) {
+            minimo = std::min(minimo, g[lista[i]] + h(lista[i]));
+        }
+        cota = minimo > 0.0f ? std::min(eps, g[destino] / minimo) : 1.0f;
+        if (eps <= epsilon_final || cota <= epsilon_final || plazo_vencido()) break;
+
+        // Siguiente pasada: abierta = abierta + INCONS con las prioridades del nuevo eps
+        eps = std::max(epsilon_final, eps - parametros.paso);
+        pasada++;
+        for (int i = 0; i < num_pendientes; ++i) {
+            int v = lista[i];
+            estado[v] = EN_ABIERTA;
+            cola.insertar(v, g[v] + eps * h(v));
+            CONTAR(inserciones_cola);
+        }
+        CONTAR_MAX(pico_cola, cola.tamano());
+    }
+
+    ruta.nodos_asentados = asentados;
+    // Aun cortada a mitad de pasada, 'anterior' lleva a una ruta que no es peor
+    // que la de la ultima pasada completa
+    terminar_busqueda(grafo, anterior, nullptr, destino, hay_ruta, agotado, ruta);
+    if (hay_ruta) ruta.cota = cota;
+}
+
+// A* ponderado: una sola pasada de ARA*
+template<typename Grafo, typename Heuristica, typename ColaPrioridad>
+void buscar_a_estrella_ponderado(const Grafo& grafo, const Heuristica& h, ColaPrioridad& cola,
+                                 ArenaBusqueda& arena, int origen, int destino, float epsilon,
+                                 ResultadoRuta& ruta) {
+    ParametrosARA parametros;
+    parametros.epsilon_inicial = parametros.epsilon_final = epsilon;
+    buscar_ara_estrella(grafo, h, cola, arena, origen, destino, parametros, ruta);
+}
+
+// 'por_f' ordena por f los abiertos y los inconsistentes (da la cota
+// inferior), 'pendientes' los abiertos que aun no entraron a FOCAL y 'focal'
+// los de FOCAL por h. Las tres con borrado perezoso.
+//
+// Cota inferior del optimo: el minimo f en por_f. En el camino optimo, el
+// primer nodo que no esta cerrado con su g optimo tiene ese g (lo relajo el
+// anterior) y esta abierto o es inconsistente: su f no pasa del optimo. Esa
+// cota puede bajar, asi que al sacar un nodo de FOCAL se vuelve a comprobar.
+template<typename Grafo, typename Heuristica, typename ColaPrioridad>
+void buscar_focal(const Grafo& grafo, const Heuristica& h, ColaPrioridad& por_f, ColaPrioridad& pendientes,
+                  ColaPrioridad& focal, ArenaBusqueda& arena, int origen, int destino, float epsilon,
+                  ResultadoRuta& ruta) {
+    using namespace busqueda_detalle;
+    CONTAR_REINICIAR();
+    ruta.reiniciar();
+    const int num_nodos = grafo.num_nodos();
+    if (!nodos_validos(num_nodos, origen, destino)) return;
+    epsilon = std::max(1.0f, epsilon);
+
+    float* g = arena.reservar<float>(num_nodos);
+    int* anterior = arena.reservar<int>(num_nodos);
+    bool* cerrado = arena.reservar<bool>(num_nodos);
+    bool* inconsistente = arena.reservar<bool>(num_nodos);   // Cerrado y con g mejor que al expandirlo
+    for (int i = 0; i < num_nodos; ++i) {
+        g[i] = 1e9f;
+        anterior[i] = -1;
+        cerrado[i] = false;
+        inconsistente[i] = false;
+    }
+    auto f = [&](int v) { return g[v] + h(v); };
+    // Una entrada vale si el nodo sigue con esa f y (salvo en por_f) abierto
+    auto tope_valido = [&](const ColaPrioridad& cola, bool con_inconsistentes) {
+        int v = cola.ver_min();
+        return cola.prioridad_min() == f(v) && (!cerrado[v] || (con_inconsistentes && inconsistente[v]));
+    };
+
+    g[origen] = 0.0f;
+    por_f.limpiar();
+    pendientes.limpiar();
+    focal.limpiar();
+    por_f.insertar(origen, f(origen));
+    pendientes.insertar(origen, f(origen));
+    CONTAR_N(inserciones_cola, 2);
+
+    bool encontrado = false, agotado = false;
+    float cota_inferior = 0.0f;
+    int asentados = 0;
+    while (true) {
+        while (!por_f.vacia() && !tope_valido(por_f, true)) {
+            por_f.extraer_min();
+            CONTAR(extracciones_obsoletas);
+        }
+        if (por_f.vacia()) break;
+        cota_inferior = por_f.prioridad_min();
+        const float limite = epsilon * cota_inferior;
+
+        while (!pendientes.vacia() && pendientes.prioridad_min() <= limite) {
+            bool valida = tope_valido(pendientes, false);
+            int v = pendientes.extraer_min();
+            if (!valida) continue;
+            focal.insertar(v, h(v));
+            CONTAR(inserciones_cola);
+        }
+
+        int actual = -1;
+        while (!focal.vacia()) {
+            int v = focal.extraer_min();
+            CONTAR(nodos_extraidos);
+            if (cerrado[v]) {
+                CONTAR(extracciones_obsoletas);
+                continue;
+            }
+            if (f(v) > limite) {                // El limite bajo desde que entro
+                pendientes.insertar(v, f(v));
+                continue;
+            }
+            actual = v;
+            break;
+        }
+        if (actual < 0) {
+            // Nada abierto entra al limite: lo sostiene un inconsistente, que se reabre
+            int v = por_f.ver_min();
+            if (!cerrado[v]) break;
+            cerrado[v] = inconsistente[v] = false;
+            pendientes.insertar(v, f(v));
+            CONTAR(inserciones_cola);
+            continue;
+        }
+
+        if (actual == destino) {
+            encontrado = true;
+            break;
+        }
+        if (ruta.presupuesto_agotado(asentados)) {
+            agotado = true;
+            break;
+        }
+        cerrado[actual] = true;
+        asentados++;
+
+        const float g_actual = g[actual];
+        grafo.para_cada_vecino(actual, [&](int vecino, float peso) {
+            CONTAR(aristas_revisadas);
+            float nuevo_g = g_actual + peso;
+            if (nuevo_g >= g[vecino]) return;
+            g[vecino] = nuevo_g;
+            anterior[vecino] = actual;
+            CONTAR(relajaciones);
+            por_f.insertar(vecino, f(vecino));
+            CONTAR(inserciones_cola);
+            if (cerrado[vecino]) {
+                inconsistente[vecino] = true;
+                return;
+            }
+            pendientes.insertar(vecino, f(vecino));
+            CONTAR(inserciones_cola);
+            CONTAR_MAX(pico_cola, por_f.tamano() + pendientes.tamano() + focal.tamano());
+        });
+    }
+
+    ruta.nodos_asentados = asentados;
+    // Sin reabrir todo, g del destino puede quedar por encima del costo del camino que lleva 'anterior'
+    terminar_busqueda(grafo, anterior, nullptr, destino, encontrado, agotado, ruta);
+    if (encontrado) ruta.cota = cota_inferior > 0.0f ? std::min(epsilon, ruta.costo / cota_inferior) : 1.0f;
+}
@@ -0,0 +1,428 @@
+#pragma once
+#include "vista_grafo.h"
+#include "contadores_busqueda.h"
+#include "memoria.h"
+#include "arena.h"
+#include "resultado_ruta.h"
+
+// Busquedas genericas sobre el concepto de grafo de vista_grafo.h.
+//
+// Una sola implementacion de BFS, DFS, Best First, Dijkstra y A* para la Parte I
+// (mapa de Arequipa) y la Parte II (grafos grandes). Cada plantilla recibe:
+//  - el grafo (VistaCSR u otro tipo que cumpla el concepto),
+//  - la politica de heuristica (HeuristicaCero, HeuristicaEuclidiana, ...),
+//  - la cola: FIFO (encolar/desencolar), pila (apilar/desapilar) o de prioridad
+//    (insertar/extraer_min), todas con vacia(), tamano() y limpiar(),
+//  - opcionalmente un EspacioBusqueda con los arreglos de trabajo.
+// Las plantillas no tienen estado global: con cola y espacio propios, cada hilo
+// puede buscar en paralelo sobre el mismo grafo. El resultado (camino en orden,
+// costo, nodos asentados y estado) va a un ResultadoRuta de quien llama; si
+// trae limite_nodos, la busqueda se corta al asentar esa cantidad de nodos.
+
+// Arreglos de trabajo de una busqueda, propiedad de quien llama. Solo crecen:
+// reutilizar el mismo espacio entre consultas evita reservar memoria en cada una.
+// Con una arena, los arreglos salen de ella y viven hasta que se restaura su
+// punto de control (un espacio por consulta, dentro de un AlcanceArena).
+class EspacioBusqueda {
+private:
+    ArenaBusqueda* arena = nullptr;
+    int capacidad = 0;
+    int capacidad_costo = 0;
+
+    template<typename T>
+    T* reservar(int cantidad) {
+        return arena ? arena->reservar<T>(cantidad) : reservar_temporal<T>(cantidad);
+    }
+
+    template<typename T>
+    void devolver(T* ptr, int cantidad) {
+        if (!arena) liberar_temporal(ptr, cantidad);
+    }
+
+public:
+    bool* visitado = nullptr;
+    int* anterior = nullptr;
+    float* g = nullptr;          // Costo acumulado: solo si se pidio con_costo
+
+    EspacioBusqueda() = default;
+    explicit EspacioBusqueda(ArenaBusqueda& arena) : arena(&arena) {}
+    ~EspacioBusqueda() { liberar(); }
+
+    EspacioBusqueda(const EspacioBusqueda&) = delete;
+    EspacioBusqueda& operator=(const EspacioBusqueda&) = delete;
+
+    // Garantiza espacio para num_nodos (no inicializa)
+    void preparar(int num_nodos, bool con_costo = false) {
+        if (num_nodos > capacidad) {
+            if (capacidad > 0) {
+                devolver(visitado, capacidad);
+                devolver(anterior, capacidad);
+            }
+            capacidad = num_nodos;
+            visitado = reservar<bool>(capacidad);
+            anterior = reservar<int>(capacidad);
+        }
+        if (con_costo && num_nodos > capacidad_costo) {
+            if (capacidad_costo > 0) devolver(g, capacidad_costo);
+            capacidad_costo = num_nodos;
+            g = reservar<float>(capacidad_costo);
+        }
+    }
+
+    void liberar() {
+        if (capacidad > 0) {
+            devolver(visitado, capacidad);
+            devolver(anterior, capacidad);
+        }
+        if (capacidad_costo > 0) devolver(g, capacidad_costo);
+        visitado = nullptr;
+        anterior = nullptr;
+        g = nullptr;
+        capacidad = 0;
+        capacidad_costo = 0;
+    }
+
+    size_t memoria_usada() const {
+        return (size_t)capacidad * (sizeof(bool) + sizeof(int)) + (size_t)capacidad_costo * sizeof(float);
+    }
+};
+
+namespace busqueda_detalle {
+
+// Costo de un camino sumando, para cada par consecutivo, la arista mas barata
+template<typename Grafo>
+inline float costo_camino(const Grafo& grafo, const int* camino, int largo) {
+    float costo = 0.0f;
+    for (int k = 0; k + 1 < largo; ++k) {
+        int v = camino[k + 1];
+        float mejor = -1.0f;
+        grafo.para_cada_vecino(camino[k], [&](int vecino, float peso) {
+            if (vecino == v && (mejor < 0 || peso < mejor)) mejor = peso;
+        });
+        costo += mejor;
+    }
+    return costo;
+}
+
+// Escribe el camino desde 'anterior' directamente en orden: una pasada mide el
+// largo y la segunda llena el buffer desde el final (sin invertir despues)
+inline void reconstruir_camino(const int* anterior, int destino, ResultadoRuta& ruta) {
+    int largo = 0;
+    for (int actual = destino; actual != -1; actual = anterior[actual]) {
+        largo++;
+    }
+    ruta.vaciar_camino();
+    int* camino = ruta.extender(largo);
+    for (int actual = destino; actual != -1; actual = anterior[actual]) {
+        camino[--largo] = actual;
+    }
+    ruta.estado = EstadoRuta::ENCONTRADA;
+}
+
+// Cierre comun: camino y costo si se llego, estado si se corto por presupuesto.
+// Con g (A*/Dijkstra) el costo ya esta calculado.
+template<typename Grafo>
+inline void terminar_busqueda(const Grafo& grafo, const int* anterior, const float* g, int destino,
+                              bool encontrado, bool agotado, ResultadoRuta& ruta) {
+    if (encontrado) {
+        reconstruir_camino(anterior, destino, ruta);
+        ruta.costo = g ? g[destino] : costo_camino(grafo, ruta.camino(), ruta.largo());
+    } else if (agotado) {
+        ruta.estado = EstadoRuta::PRESUPUESTO_AGOTADO;
+    }
+    CONTAR_FIJAR(largo_camino, ruta.largo());
+}
+
+inline bool nodos_validos(int num_nodos, int origen, int destino) {
+    return origen >= 0 && origen < num_nodos && destino >= 0 && destino < num_nodos;
+}
+
+} // namespace busqueda_detalle
+
+template<typename Grafo, typename ColaFifo>
+void buscar_bfs(const Grafo& grafo, ColaFifo& cola, EspacioBusqueda& espacio,
+                int origen, int destino, ResultadoRuta& ruta) {
+    CONTAR_REINICIAR();
+    ruta.reiniciar();
+    const int num_nodos = grafo.num_nodos();
+    if (!busqueda_detalle::nodos_validos(num_nodos, origen, destino)) return;
+
+    espacio.preparar(num_nodos);
+    bool* visitado = espacio.visitado;
+    int* anterior = espacio.anterior;
+    for (int i = 0; i < num_nodos; ++i) {
+        visitado[i] = false;
+        anterior[i] = -1;
+    }
+
+    cola.limpiar();
+    cola.encolar(origen);
+    CONTAR(inserciones_cola);
+    CONTAR_MAX(pico_cola, cola.tamano());
+    visitado[origen] = true;
+
+    bool encontrado = false, agotado = false;
+    int asentados = 0;
+    while (!cola.vacia()) {
+        int actual = cola.desencolar();
+        CONTAR(nodos_extraidos);
+
+        if (actual == destino) {
+            encontrado = true;
+            break;
+        }
+        if (ruta.presupuesto_agotado(asentados)) {
+            agotado = true;
+            break;
+        }
+        asentados++;
+
+        grafo.para_cada_vecino(actual, [&](int vecino, float) {
+            CONTAR(aristas_revisadas);
+            if (!visitado[vecino]) {
+                cola.encolar(vecino);
+                CONTAR(inserciones_cola);
+                CONTAR_MAX(pico_cola, cola.tamano());
+                visitado[vecino] = true;
+                anterior[vecino] = actual;
+                CONTAR(relajaciones);
+            }
+        });
+    }
+
+    ruta.nodos_asentados = asentados;
+    busqueda_detalle::terminar_busqueda(grafo, anterior, nullptr, destino, encontrado, agotado, ruta);
+}
+
+// DFS iterativo con pila explicita: la profundidad no depende de la pila del hilo
+template<typename Grafo, typename Pila>
+void buscar_dfs(const Grafo& grafo, Pila& pila, EspacioBusqueda& espacio,
+                int origen, int destino, ResultadoRuta& ruta) {
+    CONTAR_REINICIAR();
+    ruta.reiniciar();
+    const int num_nodos = grafo.num_nodos();
+    if (!busqueda_detalle::nodos_validos(num_nodos, origen, destino)) return;
+
+    espacio.preparar(num_nodos);
+    bool* visitado = espacio.visitado;
+    int* anterior = espacio.anterior;
+    for (int i = 0; i < num_nodos; ++i) {
+        visitado[i] = false;
+        anterior[i] = -1;
+    }
+
+    pila.limpiar();
+    pila.apilar(origen);
+    CONTAR(inserciones_cola);
+    CONTAR_MAX(pico_cola, pila.tamano());
+
+    bool encontrado = false, agotado = false;
+    int asentados = 0;
+    while (!pila.vacio()) {
+        int actual = pila.desapilar();
+        CONTAR(nodos_extraidos);
+
+        if (visitado[actual]) {
+            CONTAR(extracciones_obsoletas);
+            continue;
+        }
+        visitado[actual] = true;
+
+        if (actual == destino) {
+            encontrado = true;
+            break;
+        }
+        if (ruta.presupuesto_agotado(asentados)) {
+            agotado = true;
+            break;
+        }
+        asentados++;
+
+        grafo.para_cada_vecino(actual, [&](int vecino, float) {
+            CONTAR(aristas_revisadas);
+            if (!visitado[vecino]) {
+                pila.apilar(vecino);
+                CONTAR(inserciones_cola);
+                CONTAR_MAX(pico_cola, pila.tamano());
+                if (anterior[vecino] == -1) {
+                    anterior[vecino] = actual;
+                    CONTAR(relajaciones);
+                }
+            }
+        });
+    }
+
+    ruta.nodos_asentados = asentados;
+    busqueda_detalle::terminar_busqueda(grafo, anterior, nullptr, destino, encontrado, agotado, ruta);
+}
+
+// Best First voraz: la prioridad es solo la heuristica
+template<typename Grafo, typename Heuristica, typename ColaPrioridad>
+void buscar_best_first(const Grafo& grafo, const Heuristica& h, ColaPrioridad& cola, EspacioBusqueda& espacio,
+                       int origen, int destino, ResultadoRuta& ruta) {
+    CONTAR_REINICIAR();
+    ruta.reiniciar();
+    const int num_nodos = grafo.num_nodos();
+    if (!busqueda_detalle::nodos_validos(num_nodos, origen, destino)) return;
+
+    espacio.preparar(num_nodos);
+    bool* visitado = espacio.visitado;
+    int* anterior = espacio.anterior;
+    for (int i = 0; i < num_nodos; ++i) {
+        visitado[i] = false;
+        anterior[i] = -1;
+    }
+
+    cola.limpiar();
+    cola.insertar(origen, h(origen));
+    CONTAR(inserciones_cola);
+    CONTAR_MAX(pico_cola, cola.tamano());
+
+    bool encontrado = false, agotado = false;
+    int asentados = 0;
+    while (!cola.vacia()) {
+        int actual = cola.extraer_min();
+        CONTAR(nodos_extraidos);
+
+        if (actual == destino) {
+            encontrado = true;
+            break;
+        }
+        if (visitado[actual]) {
+            CONTAR(extracciones_obsoletas);
+            continue;
+        }
+        if (ruta.presupuesto_agotado(asentados)) {
+            agotado = true;
+            break;
+        }
+        visitado[actual] = true;
+        asentados++;
+
+        grafo.para_cada_vecino(actual, [&](int vecino, float) {
+            CONTAR(aristas_revisadas);
+            if (!visitado[vecino]) {
+                anterior[vecino] = actual;
+                CONTAR(relajaciones);
+                cola.insertar(vecino, h(vecino));
+                CONTAR(inserciones_cola);
+                CONTAR_MAX(pico_cola, cola.tamano());
+            }
+        });
+    }
+
+    ruta.nodos_asentados = asentados;
+    busqueda_detalle::terminar_busqueda(grafo, anterior, nullptr, destino, encontrado, agotado, ruta);
+}
+
+// A*: prioridad g + h. Con HeuristicaCero es exactamente Dijkstra.
+template<typename Grafo, typename Heuristica, typename ColaPrioridad>
+void buscar_a_estrella(const Grafo& grafo, const Heuristica& h, ColaPrioridad& cola, EspacioBusqueda& espacio,
+                       int origen, int destino, ResultadoRuta& ruta) {
+    CONTAR_REINICIAR();
+    ruta.reiniciar();
+    const int num_nodos = grafo.num_nodos();
+    if (!busqueda_detalle::nodos_validos(num_nodos, origen, destino)) return;
+
+    espacio.preparar(num_nodos, true);
+    bool* visitado = espacio.visitado;
+    int* anterior = espacio.anterior;
+    float* g = espacio.g;
+    for (int i = 0; i < num_nodos; ++i) {
+        visitado[i] = false;
+        anterior[i] = -1;
+        g[i] = 1e9f;  // Valor muy grande en lugar de INFINITY
+    }
+
+    g[origen] = 0.0f;
+    cola.limpiar();
+    cola.insertar(origen, h(origen));
+    CONTAR(inserciones_cola);
+    CONTAR_MAX(pico_cola, cola.tamano());
+
+    bool encontrado = false, agotado = false;
+    int asentados = 0;
+    while (!cola.vacia()) {
+        int actual = cola.extraer_min();
+        CONTAR(nodos_extraidos);
+
+        if (actual == destino) {
+            encontrado = true;
+            break;
+        }
+        if (visitado[actual]) {
+            CONTAR(extracciones_obsoletas);
+            continue;
+        }
+        if (ruta.presupuesto_agotado(asentados)) {
+            agotado = true;
+            break;
+        }
+        visitado[actual] = true;
+        asentados++;
+
+        const float g_actual = g[actual];
+        grafo.para_cada_vecino(actual, [&](int vecino, float peso) {
+            CONTAR(aristas_revisadas);
+            if (visitado[vecino]) return;
+            float nuevo_g = g_actual + peso;
+            if (nuevo_g < g[vecino]) {
+                g[vecino] = nuevo_g;
+                anterior[vecino] = actual;
+                CONTAR(relajaciones);
+                cola.insertar(vecino, nuevo_g + h(vecino));
+                CONTAR(inserciones_cola);
+                CONTAR_MAX(pico_cola, cola.tamano());
+            }
+        });
+    }
+
+    ruta.nodos_asentados = asentados;
+    busqueda_detalle::terminar_busqueda(grafo, anterior, g, destino, encontrado, agotado, ruta);
+}
+
+template<typename Grafo, typename ColaPrioridad>
+void buscar_dijkstra(const Grafo& grafo, ColaPrioridad& cola, EspacioBusqueda& espacio,
+                     int origen, int destino, ResultadoRuta& ruta) {
+    buscar_a_estrella(grafo, HeuristicaCero(), cola, espacio, origen, destino, ruta);
+}
+
+// Variantes sin espacio propio: toman los arreglos de la arena del hilo y los
+// devuelven al terminar
+
+template<typename Grafo, typename ColaFifo>
+void buscar_bfs(const Grafo& grafo, ColaFifo& cola, int origen, int destino, ResultadoRuta& ruta) {
+    AlcanceArena alcance(arena_del_hilo());
+    EspacioBusqueda espacio(arena_del_hilo());
+    buscar_bfs(grafo, cola, espacio, origen, destino, ruta);
+}
+
+template<typename Grafo, typename Pila>
+void buscar_dfs(const Grafo& grafo, Pila& pila, int origen, int destino, ResultadoRuta& ruta) {
+    AlcanceArena alcance(arena_del_hilo());
+    EspacioBusqueda espacio(arena_del_hilo());
+    buscar_dfs(grafo, pila, espacio, origen, destino, ruta);
+}
+
+template<typename Grafo, typename Heuristica, typename ColaPrioridad>
+void buscar_best_first(const Grafo& grafo, const Heuristica& h, ColaPrioridad& cola,
+                       int origen, int destino, ResultadoRuta& ruta) {
+    AlcanceArena alcance(arena_del_hilo());
+    EspacioBusqueda espacio(arena_del_hilo());
+    buscar_best_first(grafo, h, cola, espacio, origen, destino, ruta);
+}
+
+template<typename Grafo, typename Heuristica, typename ColaPrioridad>
+void buscar_a_estrella(const Grafo& grafo, const Heuristica& h, ColaPrioridad& cola,
+                       int origen, int destino, ResultadoRuta& ruta) {
+    AlcanceArena alcance(arena_del_hilo());
+    EspacioBusqueda espacio(arena_del_hilo());
+    buscar_a_estrella(grafo, h, cola, espacio, origen, destino, ruta);
+}
+
+template<typename Grafo, typename ColaPrioridad>
+void buscar_dijkstra(const Grafo& grafo, ColaPrioridad& cola, int origen, int destino, ResultadoRuta& ruta) {
+    AlcanceArena alcance(arena_del_hilo());
+    EspacioBusqueda espacio(arena_del_hilo());
+    buscar_dijkstra(grafo, cola, espacio, origen, destino, ruta);
+}
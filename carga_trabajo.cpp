@@ -0,0 +1,294 @@
+#include "carga_trabajo.h"
+#include "grafo_grande.h"
+#include "estructuras_grandes.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <limits>
+#include <algorithm>
+
+using namespace std;
+
+static const char* CABECERA_CONSULTAS = "# consultas_benchmark 1";
+
+string ConjuntoConsultas::nombre_banda(int banda) const {
+    ostringstream nombre;
+    switch (criterio) {
+        case CriterioConsultas::RANGO:
+            nombre << "2^" << (banda_min + banda);
+            break;
+        case CriterioConsultas::DISTANCIA:
+            nombre << "[" << distancia_base * (1 << banda) << "," << distancia_base * (2 << banda) << ")";
+            break;
+        default:
+            nombre << "todas";
+            break;
+    }
+    return nombre.str();
+}
+
+vector<string> ConjuntoConsultas::nombres_bandas() const {
+    vector<string> nombres;
+    for (int b = 0; b < num_bandas; ++b) {
+        nombres.push_back(nombre_banda(b));
+    }
+    return nombres;
+}
+
+const char* nombre_criterio(CriterioConsultas criterio) {
+    switch (criterio) {
+        case CriterioConsultas::RANGO: return "rango";
+        case CriterioConsultas::DISTANCIA: return "distancia";
+        default: return "uniforme";
+    }
+}
+
+bool parsear_criterio(const string& nombre, CriterioConsultas& criterio) {
+    if (nombre == "uniforme") criterio = CriterioConsultas::UNIFORME;
+    else if (nombre == "rango") criterio = CriterioConsultas::RANGO;
+    else if (nombre == "distancia") criterio = CriterioConsultas::DISTANCIA;
+    else return false;
+    return true;
+}
+
+ConjuntoConsultas generar_consultas_uniformes(const GrafoGrande& grafo, int cantidad, uint32_t semilla) {
+    ConjuntoConsultas conjunto;
+    conjunto.criterio = CriterioConsultas::UNIFORME;
+    conjunto.semilla = semilla;
+    conjunto.num_nodos = grafo.get_num_nodos_reales();
+
+    mt19937 gen(semilla);
+    uniform_int_distribution<> dis(0, conjunto.num_nodos - 1);
+
+    for (int i = 0; i < cantidad; ++i) {
+        int origen = dis(gen);
+        int destino = dis(gen);
+        while (destino == origen) {
+            destino = dis(gen);
+        }
+        conjunto.consultas.push_back({origen, destino, -1});
+    }
+    return conjunto;
+}
+
+// Dijkstra desde un origen que entrega los nodos en orden de asentamiento.
+// Reutiliza sus arreglos entre origenes y solo reinicia los nodos tocados.
+class DijkstraMuestreo {
+private:
+    const GrafoGrande& grafo;
+    vector<float> distancia;
+    vector<char> asentado;
+    vector<int> tocados;
+    ColaPrioridadGrande cola;
+
+public:
+    explicit DijkstraMuestreo(const GrafoGrande& g)
+        : grafo(g), distancia(g.get_num_nodos_reales(), numeric_limits<float>::infinity()),
+          asentado(g.get_num_nodos_reales(), 0), cola(capacidad_cola_grande(g.get_num_nodos_reales())) {}
+
+    // visitar(nodo, orden, distancia) devuelve false para detener la busqueda
+    template<typename Visitar>
+    void recorrer(int origen, Visitar visitar) {
+        for (int v : tocados) {
+            distancia[v] = numeric_limits<float>::infinity();
+            asentado[v] = 0;
+        }
+        tocados.clear();
+        cola.limpiar();
+
+        distancia[origen] = 0;
+        tocados.push_back(origen);
+        cola.insertar(origen, 0);
+        int orden = 0;
+
+        while (!cola.vacia()) {
+            int u = cola.extraer_min();
+            if (asentado[u]) continue;
+            asentado[u] = 1;
+            if (!visitar(u, orden++, distancia[u])) return;
+
+            IndiceArista inicio = grafo.get_offset_inicio(u);
+            IndiceArista fin = grafo.get_offset_fin(u);
+            for (IndiceArista i = inicio; i < fin; ++i) {
+                int v = grafo.get_vecino(i);
+                float nueva = distancia[u] + grafo.get_peso(i);
+                if (nueva < distancia[v]) {
+                    if (distancia[v] == numeric_limits<float>::infinity()) tocados.push_back(v);
+                    distancia[v] = nueva;
+                    cola.insertar(v, nueva);
+                }
+            }
+        }
+    }
+};
+
+// Origenes al azar hasta llenar todas las bandas o agotar los intentos
+static const int INTENTOS_POR_CONSULTA = 10;
+
+ConjuntoConsultas generar_consultas_por_rango(const GrafoGrande& grafo, int por_banda, int banda_min, int banda_max,
+                                              uint32_t semilla) {
+    ConjuntoConsultas conjunto;
+    conjunto.criterio = CriterioConsultas::RANGO;
+    conjunto.semilla = semilla;
+    conjunto.num_nodos = grafo.get_num_nodos_reales();
+    conjunto.banda_min = banda_min;
+    conjunto.num_bandas = banda_max - banda_min + 1;
+
+    mt19937 gen(semilla);
+    uniform_int_distribution<> dis(0, conjunto.num_nodos - 1);
+    DijkstraMuestreo dijkstra(grafo);
+    vector<int> llenas(conjunto.num_bandas, 0);
+
+    for (int intento = 0; intento < por_banda * INTENTOS_POR_CONSULTA; ++intento) {
+        int ultima = -1;
+        for (int b = 0; b < conjunto.num_bandas; ++b) {
+            if (llenas[b] < por_banda) ultima = b;
+        }
+        if (ultima < 0) break;
+
+        int origen = dis(gen);
+        int limite = 1 << (banda_min + ultima);
+        dijkstra.recorrer(origen, [&](int nodo, int orden, float) {
+            if (orden > 0 && (orden & (orden - 1)) == 0) {
+                int b = __builtin_ctz(orden) - banda_min;
+                if (b >= 0 && b < conjunto.num_bandas && llenas[b] < por_banda) {
+                    conjunto.consultas.push_back({origen, nodo, b});
+                    llenas[b]++;
+                }
+            }
+            return orden < limite;
+        });
+    }
+
+    for (int b = 0; b < conjunto.num_bandas; ++b) {
+        if (llenas[b] < por_banda) {
+            cout << "ADVERTENCIA: banda " << conjunto.nombre_banda(b) << " con " << llenas[b]
+                 << "/" << por_banda << " consultas (componentes chicas)" << endl;
+        }
+    }
+    return conjunto;
+}
+
+ConjuntoConsultas generar_consultas_por_distancia(const GrafoGrande& grafo, int por_banda, double distancia_base,
+                                                  int num_bandas, uint32_t semilla) {
+    ConjuntoConsultas conjunto;
+    conjunto.criterio = CriterioConsultas::DISTANCIA;
+    conjunto.semilla = semilla;
+    conjunto.num_nodos = grafo.get_num_nodos_reales();
+    conjunto.distancia_base = distancia_base;
+    conjunto.num_bandas = num_bandas;
+
+    mt19937 gen(semilla);
+    uniform_int_distribution<> dis(0, conjunto.num_nodos - 1);
+    DijkstraMuestreo dijkstra(grafo);
+    vector<int> llenas(num_bandas, 0);
+    vector<int> elegido(num_bandas);
+    vector<int> vistos(num_bandas);
+
+    for (int intento = 0; intento < por_banda * INTENTOS_POR_CONSULTA; ++intento) {
+        int ultima = -1;
+        for (int b = 0; b < num_bandas; ++b) {
+            if (llenas[b] < por_banda) ultima = b;
+        }
+        if (ultima < 0) break;
+
+        int origen = dis(gen);
+        double limite = distancia_base * (2 << ultima);
+        fill(elegido.begin(), elegido.end(), -1);
+        fill(vistos.begin(), vistos.end(), 0);
+
+        // Un destino uniforme por banda (muestreo de reservorio de tamano 1)
+        dijkstra.recorrer(origen, [&](int nodo, int, float d) {
+            if (d >= limite) return false;
+            if (d < distancia_base) return true;
+            int b = 0;
+            while (distancia_base * (2 << b) <= d) b++;
+            if (uniform_int_distribution<>(0, vistos[b]++)(gen) == 0) elegido[b] = nodo;
+            return true;
+        });
+
+        for (int b = 0; b < num_bandas; ++b) {
+            if (elegido[b] >= 0 && llenas[b] < por_banda) {
+                conjunto.consultas.push_back({origen, elegido[b], b});
+                llenas[b]++;
+            }
+        }
+    }
+
+    for (int b = 0; b < num_bandas; ++b) {
+        if (llenas[b] < por_banda) {
+            cout << "ADVERTENCIA: banda " << conjunto.nombre_banda(b) << " con " << llenas[b]
+                 << "/" << por_banda << " consultas" << endl;
+        }
+    }
+    return conjunto;
+}
+
+bool guardar_consultas(const ConjuntoConsultas& conjunto, const string& archivo) {
+    ofstream salida(archivo);
+    if (!salida.is_open()) {
+        cerr << "No se pudo crear el archivo de consultas: " << archivo << endl;
+        return false;
+    }
+
+    salida << CABECERA_CONSULTAS << "\n";
+    salida << "criterio " << nombre_criterio(conjunto.criterio) << "\n";
+    salida << "semilla " << conjunto.semilla << "\n";
+    salida << "num_nodos " << conjunto.num_nodos << "\n";
+    salida << "banda_min " << conjunto.banda_min << "\n";
+    salida << "distancia_base " << conjunto.distancia_base << "\n";
+    salida << "num_bandas " << conjunto.num_bandas << "\n";
+    salida << "consultas " << conjunto.consultas.size() << "\n";
+    for (const auto& c : conjunto.consultas) {
+        salida << c.origen << " " << c.destino << " " << c.banda << "\n";
+    }
+    return salida.good();
+}
+
+bool cargar_consultas(ConjuntoConsultas& conjunto, const string& archivo, int num_nodos) {
+    ifstream entrada(archivo);
+    if (!entrada.is_open()) {
+        cerr << "No se pudo abrir el archivo de consultas: " << archivo << endl;
+        return false;
+    }
+
+    string linea;
+    if (!getline(entrada, linea) || linea != CABECERA_CONSULTAS) {
+        cerr << "Formato de consultas no reconocido: " << archivo << endl;
+        return false;
+    }
+
+    ConjuntoConsultas leido;
+    string clave, criterio;
+    size_t cantidad = 0;
+    entrada >> clave >> criterio;
+    entrada >> clave >> leido.semilla;
+    entrada >> clave >> leido.num_nodos;
+    entrada >> clave >> leido.banda_min;
+    entrada >> clave >> leido.distancia_base;
+    entrada >> clave >> leido.num_bandas;
+    entrada >> clave >> cantidad;
+    if (!entrada || !parsear_criterio(criterio, leido.criterio)) {
+        cerr << "Cabecera de consultas invalida: " << archivo << endl;
+        return false;
+    }
+
+    if (leido.num_nodos != num_nodos) {
+        cerr << "Las consultas son de un grafo de " << leido.num_nodos << " nodos, el actual tiene "
+             << num_nodos << " (revisar --semilla-grafo y --malla)" << endl;
+        return false;
+    }
+
+    leido.consultas.resize(cantidad);
+    for (auto& c : leido.consultas) {
+        if (!(entrada >> c.origen >> c.destino >> c.banda) ||
+            c.origen < 0 || c.origen >= num_nodos || c.destino < 0 || c.destino >= num_nodos) {
+            cerr << "Consulta invalida en " << archivo << endl;
+            return false;
+        }
+    }
+
+    conjunto = move(leido);
+    return true;
+}
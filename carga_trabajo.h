@@ -0,0 +1,60 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+
+class GrafoGrande;
+
+// Conjuntos de consultas reproducibles para el benchmark.
+//
+// Los pares uniformes mezclan consultas triviales con consultas que cruzan todo
+// el grafo, y el promedio esconde en cual de las dos gana una tecnica. Aqui las
+// consultas se estratifican en bandas:
+//  - RANGO: para cada origen s se corre Dijkstra y el destino de la banda k es el
+//    nodo asentado en la posicion 2^k (rango de Dijkstra).
+//  - DISTANCIA: el destino se elige al azar entre los nodos asentados con distancia
+//    de red en [d0 * 2^b, d0 * 2^(b+1)).
+// Todo depende solo de la semilla y del grafo, y el conjunto se puede guardar y
+// cargar para comparar corridas (o versiones) sobre exactamente las mismas consultas.
+
+constexpr uint32_t SEMILLA_CONSULTAS_DEFECTO = 777;
+
+enum class CriterioConsultas {
+    UNIFORME,
+    RANGO,
+    DISTANCIA
+};
+
+struct ConsultaPrueba {
+    int origen;
+    int destino;
+    int banda;              // -1 en consultas uniformes
+};
+
+struct ConjuntoConsultas {
+    CriterioConsultas criterio = CriterioConsultas::UNIFORME;
+    uint32_t semilla = 0;
+    int num_nodos = 0;              // Nodos del grafo con el que se generaron
+    int banda_min = 0;              // RANGO: exponente k de la primera banda
+    double distancia_base = 0;      // DISTANCIA: d0 de la primera banda
+    int num_bandas = 0;
+    std::vector<ConsultaPrueba> consultas;
+
+    std::string nombre_banda(int banda) const;
+    std::vector<std::string> nombres_bandas() const;
+};
+
+// Generadores sobre el grafo dado
+ConjuntoConsultas generar_consultas_uniformes(const GrafoGrande& grafo, int cantidad, uint32_t semilla);
+ConjuntoConsultas generar_consultas_por_rango(const GrafoGrande& grafo, int por_banda, int banda_min, int banda_max,
+                                              uint32_t semilla);
+ConjuntoConsultas generar_consultas_por_distancia(const GrafoGrande& grafo, int por_banda, double distancia_base,
+                                                  int num_bandas, uint32_t semilla);
+
+// Archivo de texto: cabecera "clave valor" y una linea "origen destino banda" por consulta
+bool guardar_consultas(const ConjuntoConsultas& conjunto, const std::string& archivo);
+// Falla si el archivo se genero con un grafo de otro tamano que 'num_nodos'
+bool cargar_consultas(ConjuntoConsultas& conjunto, const std::string& archivo, int num_nodos);
+
+bool parsear_criterio(const std::string& nombre, CriterioConsultas& criterio);
+const char* nombre_criterio(CriterioConsultas criterio);
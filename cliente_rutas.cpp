@@ -0,0 +1,199 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "protocolo_rutas.h"
+#include "histograma_latencia.h"
+
+using namespace std;
+using namespace chrono;
+
+// Generador de carga para servidor_rutas: abre varias conexiones locales, mantiene
+// 'profundidad' solicitudes en vuelo por conexion y mide QPS sostenido y latencia
+// de extremo a extremo (incluye cola, lote y socket).
+
+struct ConfiguracionCliente {
+    string socket = "/tmp/rutas.sock";
+    int conexiones = 4;
+    int solicitudes = 1000;        // Por conexion
+    int profundidad = 16;          // Solicitudes en vuelo por conexion
+    int max_nodos = 1000000;       // Rango de nodos aleatorios
+    uint32_t semilla = 12345;
+    uint16_t grafo = 0;            // Id del grafo en el servidor
+    AlgoritmoRuta algoritmo = AlgoritmoRuta::ASTAR;
+    bool incluir_camino = false;
+};
+
+struct ResultadoConexion {
+    HistogramaLatencia latencias;  // Por conexion; se combinan al terminar
+    int encontrados = 0;
+    int sin_camino = 0;
+    int agotados = 0;
+    int errores = 0;
+};
+
+static int conectar(const string& ruta) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    sockaddr_un direccion;
+    memset(&direccion, 0, sizeof(direccion));
+    direccion.sun_family = AF_UNIX;
+    strncpy(direccion.sun_path, ruta.c_str(), sizeof(direccion.sun_path) - 1);
+
+    if (connect(fd, reinterpret_cast<sockaddr*>(&direccion), sizeof(direccion)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void ejecutar_conexion(const ConfiguracionCliente& config, int indice, ResultadoConexion& resultado) {
+    int fd = conectar(config.socket);
+    if (fd < 0) {
+        cerr << "No se pudo conectar a " << config.socket << endl;
+        resultado.errores = config.solicitudes;
+        return;
+    }
+
+    mt19937 gen(config.semilla + indice);
+    uniform_int_distribution<> nodo_dist(0, config.max_nodos - 1);
+    vector<steady_clock::time_point> enviada(config.solicitudes);
+
+    int siguiente = 0;
+    auto enviar = [&](int cantidad) {
+        vector<SolicitudRuta> bloque;
+        for (int k = 0; k < cantidad && siguiente < config.solicitudes; ++k, ++siguiente) {
+            SolicitudRuta sol;
+            memset(&sol, 0, sizeof(sol));
+            sol.magia = PROTOCOLO_MAGIA;
+            sol.id = siguiente;
+            sol.algoritmo = static_cast<uint8_t>(config.algoritmo);
+            sol.opciones = config.incluir_camino ? SOLICITUD_INCLUIR_CAMINO : 0;
+            sol.grafo = config.grafo;
+            sol.origen = nodo_dist(gen);
+            sol.destino = nodo_dist(gen);
+            enviada[siguiente] = steady_clock::now();
+            bloque.push_back(sol);
+        }
+        return bloque.empty() || escribir_completo(fd, bloque.data(), bloque.size() * sizeof(SolicitudRuta));
+    };
+
+    bool ok = enviar(config.profundidad);
+    vector<int32_t> nodos;
+
+    for (int recibidas = 0; ok && recibidas < config.solicitudes; ++recibidas) {
+        RespuestaRuta resp;
+        if (!leer_completo(fd, &resp, sizeof(resp))) {
+            ok = false;
+            break;
+        }
+        if (resp.nodos_enviados > 0) {
+            nodos.resize(resp.nodos_enviados);
+            if (!leer_completo(fd, nodos.data(), nodos.size() * sizeof(int32_t))) {
+                ok = false;
+                break;
+            }
+        }
+
+        auto ahora = steady_clock::now();
+        if (resp.id < enviada.size()) {
+            resultado.latencias.registrar(duration_cast<nanoseconds>(ahora - enviada[resp.id]).count());
+        }
+
+        switch (static_cast<EstadoRespuesta>(resp.estado)) {
+            case EstadoRespuesta::ENCONTRADO: resultado.encontrados++; break;
+            case EstadoRespuesta::SIN_CAMINO: resultado.sin_camino++; break;
+            case EstadoRespuesta::PRESUPUESTO_AGOTADO: resultado.agotados++; break;
+            default: resultado.errores++; break;
+        }
+
+        ok = enviar(1);
+    }
+
+    if (!ok) {
+        cerr << "Conexion " << indice << " interrumpida" << endl;
+    }
+    close(fd);
+}
+
+static bool parsear_algoritmo(const string& nombre, AlgoritmoRuta& algoritmo) {
+    if (nombre == "BFS") algoritmo = AlgoritmoRuta::BFS;
+    else if (nombre == "DFS") algoritmo = AlgoritmoRuta::DFS;
+    else if (nombre == "BestFirst") algoritmo = AlgoritmoRuta::BEST_FIRST;
+    else if (nombre == "Dijkstra") algoritmo = AlgoritmoRuta::DIJKSTRA;
+    else if (nombre == "AStar") algoritmo = AlgoritmoRuta::ASTAR;
+    else if (nombre == "CRP") algoritmo = AlgoritmoRuta::CRP;
+    else return false;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    ConfiguracionCliente config;
+
+    for (int i = 1; i < argc; ++i) {
+        string opcion = argv[i];
+        bool hay_valor = i + 1 < argc;
+        if (opcion == "--socket" && hay_valor) config.socket = argv[++i];
+        else if (opcion == "--conexiones" && hay_valor) config.conexiones = max(1, atoi(argv[++i]));
+        else if (opcion == "--solicitudes" && hay_valor) config.solicitudes = max(1, atoi(argv[++i]));
+        else if (opcion == "--profundidad" && hay_valor) config.profundidad = max(1, atoi(argv[++i]));
+        else if (opcion == "--nodos" && hay_valor) config.max_nodos = max(1, atoi(argv[++i]));
+        else if (opcion == "--semilla" && hay_valor) config.semilla = strtoul(argv[++i], nullptr, 10);
+        else if (opcion == "--grafo" && hay_valor) config.grafo = (uint16_t)max(0, atoi(argv[++i]));
+        else if (opcion == "--camino") config.incluir_camino = true;
+        else if (opcion == "--algoritmo" && hay_valor && parsear_algoritmo(argv[i + 1], config.algoritmo)) ++i;
+        else {
+            cout << "Uso: cliente_rutas [--socket RUTA] [--conexiones N] [--solicitudes N] [--profundidad N]\n"
+                 << "                    [--nodos N] [--semilla N] [--grafo ID] [--algoritmo BFS|DFS|BestFirst|Dijkstra|AStar|CRP]\n"
+                 << "                    [--camino]\n";
+            return 1;
+        }
+    }
+
+    cout << "=== CLIENTE DE CARGA ===" << endl;
+    cout << "Conexiones: " << config.conexiones << ", solicitudes por conexion: " << config.solicitudes
+         << ", en vuelo: " << config.profundidad << endl;
+
+    vector<ResultadoConexion> resultados(config.conexiones);
+    vector<thread> hilos;
+
+    auto inicio = steady_clock::now();
+    for (int c = 0; c < config.conexiones; ++c) {
+        hilos.emplace_back(ejecutar_conexion, cref(config), c, ref(resultados[c]));
+    }
+    for (auto& h : hilos) h.join();
+    double segundos = duration_cast<microseconds>(steady_clock::now() - inicio).count() / 1e6;
+
+    HistogramaLatencia latencias;
+    int encontrados = 0, sin_camino = 0, agotados = 0, errores = 0;
+    for (const auto& r : resultados) {
+        latencias.combinar(r.latencias);
+        encontrados += r.encontrados;
+        sin_camino += r.sin_camino;
+        agotados += r.agotados;
+        errores += r.errores;
+    }
+
+    cout << fixed << setprecision(2);
+    cout << "\nRespuestas: " << latencias.cantidad() << " (encontrados " << encontrados
+         << ", sin camino " << sin_camino << ", presupuesto agotado " << agotados
+         << ", errores " << errores << ")" << endl;
+    cout << "Tiempo total: " << segundos << " s" << endl;
+    cout << "QPS sostenido: " << (segundos > 0 ? latencias.cantidad() / segundos : 0.0) << endl;
+    cout << "Latencia (ms): p50 " << latencias.percentil_ms(50)
+         << "  p90 " << latencias.percentil_ms(90)
+         << "  p99 " << latencias.percentil_ms(99)
+         << "  p99.9 " << latencias.percentil_ms(99.9)
+         << "  max " << latencias.maximo() / 1e6 << endl;
+
+    return errores > 0 ? 1 : 0;
+}
@@ -0,0 +1,212 @@
+#include "grafo_grande.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <utility>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+using namespace std::chrono;
+
+// Componentes del grafo para descartar en O(1) las consultas sin camino.
+//
+// Las debiles salen de un union-find paralelo sin bloqueos: cada hilo une los
+// extremos de sus aristas con CAS y la raiz de cada conjunto es su menor nodo.
+// Las fuertes salen de Tarjan iterativo, una componente debil por tarea (son
+// disjuntas y ninguna arista las cruza). En la malla casi todo es una sola
+// componente debil, asi que esa parte es en la practica secuencial.
+
+namespace {
+
+int raiz(vector<atomic<int>>& padre, int v) {
+    while (true) {
+        int p = padre[v].load(memory_order_relaxed);
+        if (p == v) return v;
+        int abuelo = padre[p].load(memory_order_relaxed);
+        // Compresion a medias: si otro hilo cambio padre[v], no importa
+        if (abuelo != p) padre[v].compare_exchange_weak(p, abuelo, memory_order_relaxed);
+        v = abuelo;
+    }
+}
+
+// Cuelga la raiz mayor de la menor: la raiz final es el menor nodo del conjunto
+void unir(vector<atomic<int>>& padre, int a, int b) {
+    while (true) {
+        a = raiz(padre, a);
+        b = raiz(padre, b);
+        if (a == b) return;
+        if (a < b) swap(a, b);
+        int esperado = a;
+        if (padre[a].compare_exchange_strong(esperado, b, memory_order_relaxed)) return;
+    }
+}
+
+int indice_tamano(int tam) {
+    return 31 - __builtin_clz(tam);
+}
+
+} // namespace
+
+void GrafoGrande::calcular_componentes(int hilos) {
+    auto inicio = high_resolution_clock::now();
+#ifdef _OPENMP
+    if (hilos <= 0) hilos = omp_get_max_threads();
+#else
+    hilos = 1;
+#endif
+    const int n = num_nodos;
+    VistaGrande vista = this->vista();
+
+    // 1. Componentes debiles
+    vector<atomic<int>> padre(n);
+    #pragma omp parallel for num_threads(hilos) schedule(static)
+    for (int v = 0; v < n; ++v) {
+        padre[v].store(v, memory_order_relaxed);
+    }
+    #pragma omp parallel for num_threads(hilos) schedule(dynamic, 4096)
+    for (int u = 0; u < n; ++u) {
+        vista.para_cada_vecino(u, [&](int v, float) { unir(padre, u, v); });
+    }
+
+    componente.assign(n, -1);
+    tam_componentes.clear();
+    for (int v = 0; v < n; ++v) {
+        if (padre[v].load(memory_order_relaxed) == v) {
+            componente[v] = tam_componentes.size();
+            tam_componentes.push_back(0);
+        }
+    }
+    #pragma omp parallel for num_threads(hilos) schedule(static)
+    for (int v = 0; v < n; ++v) {
+        int r = raiz(padre, v);
+        if (r != v) componente[v] = componente[r];
+    }
+    const int num_debiles = tam_componentes.size();
+    for (int v = 0; v < n; ++v) {
+        tam_componentes[componente[v]]++;
+    }
+
+    // Nodos agrupados por componente debil (formato CSR)
+    vector<int> inicio_debil(num_debiles + 1, 0);
+    for (int c = 0; c < num_debiles; ++c) {
+        inicio_debil[c + 1] = inicio_debil[c] + tam_componentes[c];
+    }
+    vector<int> nodos_debil(n);
+    {
+        vector<int> posicion(inicio_debil.begin(), inicio_debil.end() - 1);
+        for (int v = 0; v < n; ++v) {
+            nodos_debil[posicion[componente[v]]++] = v;
+        }
+    }
+    vector<int> orden(num_debiles);
+    for (int c = 0; c < num_debiles; ++c) orden[c] = c;
+    sort(orden.begin(), orden.end(), [&](int a, int b) { return tam_componentes[a] > tam_componentes[b]; });
+
+    // 2. Componentes fuertes: Tarjan iterativo dentro de cada componente debil
+    fuerte.assign(n, -1);
+    vector<int> indice(n, -1), bajo(n);
+    vector<char> en_pila(n, 0);
+    vector<vector<int>> tam_por_debil(num_debiles);
+
+    #pragma omp parallel num_threads(hilos)
+    {
+        vector<int> pila;
+        vector<pair<int, IndiceArista>> llamadas;  // (nodo, proxima arista)
+        #pragma omp for schedule(dynamic, 1)
+        for (int i = 0; i < num_debiles; ++i) {
+            const int c = orden[i];
+            vector<int>& tamanos = tam_por_debil[c];
+            int contador = 0;
+            for (int k = inicio_debil[c]; k < inicio_debil[c + 1]; ++k) {
+                const int raiz_dfs = nodos_debil[k];
+                if (indice[raiz_dfs] >= 0) continue;
+                indice[raiz_dfs] = bajo[raiz_dfs] = contador++;
+                pila.push_back(raiz_dfs);
+                en_pila[raiz_dfs] = 1;
+                llamadas.push_back({ raiz_dfs, vista.offset[raiz_dfs] });
+                while (!llamadas.empty()) {
+                    const int u = llamadas.back().first;
+                    const IndiceArista e = llamadas.back().second;
+                    if (e < vista.offset[u + 1]) {
+                        llamadas.back().second++;
+                        const int w = vista.vecinos[e];
+                        if (indice[w] < 0) {
+                            indice[w] = bajo[w] = contador++;
+                            pila.push_back(w);
+                            en_pila[w] = 1;
+                            llamadas.push_back({ w, vista.offset[w] });
+                        } else if (en_pila[w]) {
+                            bajo[u] = min(bajo[u], indice[w]);
+                        }
+                        continue;
+                    }
+                    llamadas.pop_back();
+                    if (!llamadas.empty()) {
+                        const int p = llamadas.back().first;
+                        bajo[p] = min(bajo[p], bajo[u]);
+                    }
+                    if (bajo[u] == indice[u]) {
+                        // u cierra una componente fuerte: todo lo que esta sobre el en la pila
+                        const int numero = tamanos.size();
+                        int tam = 0, x;
+                        do {
+                            x = pila.back();
+                            pila.pop_back();
+                            en_pila[x] = 0;
+                            fuerte[x] = numero;
+                            tam++;
+                        } while (x != u);
+                        tamanos.push_back(tam);
+                    }
+                }
+            }
+        }
+    }
+
+    tam_fuertes.clear();
+    for (const vector<int>& tamanos : tam_por_debil) {
+        tam_fuertes.insert(tam_fuertes.end(), tamanos.begin(), tamanos.end());
+    }
+    auto fin = high_resolution_clock::now();
+    cout << "Componentes: " << num_debiles << " debiles, " << tam_fuertes.size() << " fuertes ("
+         << duration_cast<milliseconds>(fin - inicio).count() << " ms con " << hilos << " hilos)" << endl;
+}
+
+void GrafoGrande::mostrar_componentes() const {
+    if (componente.empty() || num_nodos == 0) {
+        cout << "Componentes sin calcular" << endl;
+        return;
+    }
+    struct Fila {
+        long debiles = 0, nodos_debiles = 0, fuertes = 0, nodos_fuertes = 0;
+    };
+    vector<Fila> filas(32);
+    for (int tam : tam_componentes) {
+        filas[indice_tamano(tam)].debiles++;
+        filas[indice_tamano(tam)].nodos_debiles += tam;
+    }
+    for (int tam : tam_fuertes) {
+        filas[indice_tamano(tam)].fuertes++;
+        filas[indice_tamano(tam)].nodos_fuertes += tam;
+    }
+    int mayor_debil = *max_element(tam_componentes.begin(), tam_componentes.end());
+    int mayor_fuerte = *max_element(tam_fuertes.begin(), tam_fuertes.end());
+    cout << "Componentes debiles: " << tam_componentes.size() << " (mayor: " << mayor_debil << " nodos, "
+         << fixed << setprecision(2) << 100.0 * mayor_debil / num_nodos << "%)" << endl;
+    cout << "Componentes fuertes: " << tam_fuertes.size() << " (mayor: " << mayor_fuerte << " nodos, "
+         << 100.0 * mayor_fuerte / num_nodos << "%)" << endl;
+    cout << "  " << left << setw(20) << "Tamano" << right << setw(10) << "Debiles" << setw(12) << "Nodos"
+         << setw(10) << "Fuertes" << setw(12) << "Nodos" << endl;
+    for (int b = 0; b < 32; ++b) {
+        if (filas[b].debiles == 0 && filas[b].fuertes == 0) continue;
+        long desde = 1L << b, hasta = (2L << b) - 1;
+        string rango = desde == hasta ? to_string(desde) : to_string(desde) + "-" + to_string(hasta);
+        cout << "  " << left << setw(20) << rango << right << setw(10) << filas[b].debiles
+             << setw(12) << filas[b].nodos_debiles << setw(10) << filas[b].fuertes
+             << setw(12) << filas[b].nodos_fuertes << endl;
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+
+// Contadores de trabajo de las busquedas (busqueda_generica.h, buscar_*_grande).
+// Se activan compilando con -DCONTADORES_BUSQUEDA (make ... CONTADORES=1).
+// Sin la bandera las macros se expanden a nada y sus argumentos no se evaluan,
+// asi que el lazo principal queda igual que sin instrumentar.
+struct ContadoresBusqueda {
+    uint64_t nodos_extraidos = 0;         // Extracciones de la cola/pila
+    uint64_t extracciones_obsoletas = 0;  // Extracciones de nodos ya visitados (entradas viejas)
+    uint64_t aristas_revisadas = 0;       // Aristas escaneadas
+    uint64_t relajaciones = 0;            // Aristas que mejoraron o descubrieron un nodo
+    uint64_t inserciones_cola = 0;        // Inserciones en la cola/pila
+    uint64_t pico_cola = 0;               // Tamano maximo de la cola/pila
+    uint64_t largo_camino = 0;            // Nodos en la ruta devuelta
+};
+
+// Contadores de la ultima busqueda ejecutada en este hilo
+inline thread_local ContadoresBusqueda contadores_hilo;
+
+#ifdef CONTADORES_BUSQUEDA
+constexpr bool CONTADORES_ACTIVOS = true;
+#define CONTAR_REINICIAR() (contadores_hilo = ContadoresBusqueda())
+#define CONTAR(campo) (++contadores_hilo.campo)
+#define CONTAR_N(campo, n) (contadores_hilo.campo += (n))
+#define CONTAR_MAX(campo, valor) \
+    do { uint64_t v_ = (valor); if (v_ > contadores_hilo.campo) contadores_hilo.campo = v_; } while (0)
+#define CONTAR_FIJAR(campo, valor) (contadores_hilo.campo = (valor))
+#else
+constexpr bool CONTADORES_ACTIVOS = false;
+#define CONTAR_REINICIAR() ((void)0)
+#define CONTAR(campo) ((void)0)
+#define CONTAR_N(campo, n) ((void)0)
+#define CONTAR_MAX(campo, valor) ((void)0)
+#define CONTAR_FIJAR(campo, valor) ((void)0)
+#endif
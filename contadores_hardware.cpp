@@ -0,0 +1,115 @@
+#include "contadores_hardware.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+const char* nombre_evento_hardware(int evento) {
+    switch (evento) {
+        case EVENTO_CICLOS: return "ciclos";
+        case EVENTO_INSTRUCCIONES: return "instrucciones";
+        case EVENTO_L1D_FALLOS: return "L1d-fallos";
+        case EVENTO_LLC_FALLOS: return "LLC-fallos";
+        case EVENTO_DTLB_FALLOS: return "dTLB-fallos";
+        case EVENTO_SALTOS_FALLIDOS: return "saltos-fallidos";
+        default: return "?";
+    }
+}
+
+#ifdef __linux__
+
+static uint64_t config_cache(uint64_t cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+// Con lider < 0 abre el lider del grupo (deshabilitado); los demas eventos se
+// suman a su grupo y se habilitan, deshabilitan y leen junto con el
+static int abrir_evento(uint32_t tipo, uint64_t config, int lider) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = tipo;
+    attr.config = config;
+    attr.disabled = lider < 0 ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // pid = 0, cpu = -1: el hilo que llama, en cualquier CPU
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, lider, 0);
+}
+
+ContadoresHardware::ContadoresHardware() : lider(-1), activo(false) {
+    const uint32_t tipos[NUM_EVENTOS_HARDWARE] = {
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+        PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE
+    };
+    const uint64_t configs[NUM_EVENTOS_HARDWARE] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, config_cache(PERF_COUNT_HW_CACHE_L1D),
+        config_cache(PERF_COUNT_HW_CACHE_LL), config_cache(PERF_COUNT_HW_CACHE_DTLB), PERF_COUNT_HW_BRANCH_MISSES
+    };
+    // El primer evento que abre es el lider; los siguientes entran en su grupo
+    // en orden, que es el orden en que los devuelve la lectura
+    for (int e = 0; e < NUM_EVENTOS_HARDWARE; ++e) {
+        fds[e] = abrir_evento(tipos[e], configs[e], lider);
+        if (fds[e] >= 0 && lider < 0) lider = fds[e];
+    }
+    activo = lider >= 0;
+}
+
+ContadoresHardware::~ContadoresHardware() {
+    // Los miembros antes que el lider
+    for (int e = NUM_EVENTOS_HARDWARE - 1; e >= 0; --e) {
+        if (fds[e] >= 0) close(fds[e]);
+    }
+}
+
+void ContadoresHardware::iniciar() {
+    if (!activo) return;
+    ioctl(lider, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(lider, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+LecturaHardware ContadoresHardware::detener() {
+    LecturaHardware lectura;
+    if (!activo) return lectura;
+
+    ioctl(lider, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    // Eventos del grupo, tiempo habilitado, tiempo corriendo y un valor por evento
+    uint64_t datos[3 + NUM_EVENTOS_HARDWARE];
+    ssize_t leidos = read(lider, datos, sizeof(datos));
+    if (leidos < (ssize_t)(3 * sizeof(uint64_t))) return lectura;
+    const uint64_t eventos = datos[0], habilitado = datos[1], corriendo = datos[2];
+    if (leidos < (ssize_t)((3 + eventos) * sizeof(uint64_t))) return lectura;
+    // El grupo nunca estuvo en el PMU (no entra o lo ocupa otro): no hay medicion
+    if (corriendo == 0) return lectura;
+
+    uint64_t i = 0;
+    for (int e = 0; e < NUM_EVENTOS_HARDWARE && i < eventos; ++e) {
+        if (fds[e] < 0) continue;
+        uint64_t valor = datos[3 + i++];
+        if (corriendo < habilitado) valor = (uint64_t)((double)valor * habilitado / corriendo);
+        lectura.valores[e] = valor;
+    }
+    lectura.valida = true;
+    return lectura;
+}
+
+#else
+
+ContadoresHardware::ContadoresHardware() : lider(-1), activo(false) {
+    for (int e = 0; e < NUM_EVENTOS_HARDWARE; ++e) fds[e] = -1;
+}
+
+ContadoresHardware::~ContadoresHardware() {}
+
+void ContadoresHardware::iniciar() {}
+
+LecturaHardware ContadoresHardware::detener() {
+    return LecturaHardware();
+}
+
+#endif
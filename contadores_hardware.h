@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+
+// Contadores de hardware por hilo (Linux perf_event_open).
+//
+// Se abren para el hilo que llama, solo modo usuario, como un grupo: el primer
+// evento que abre es el lider y los demas se habilitan y se leen con el, asi
+// que todos miden la misma ventana. Si el kernel no permite un evento
+// (perf_event_paranoid, contenedores, maquinas virtuales) ese evento queda en
+// 0; si no se puede abrir ninguno, disponible() es false y las lecturas salen
+// vacias sin que falle la corrida. Si el PMU multiplexa el grupo, los valores
+// se escalan por tiempo_habilitado / tiempo_corriendo; si el grupo no llego a
+// correr (no entra en los contadores del PMU), la lectura sale invalida.
+
+enum EventoHardware {
+    EVENTO_CICLOS = 0,
+    EVENTO_INSTRUCCIONES,
+    EVENTO_L1D_FALLOS,
+    EVENTO_LLC_FALLOS,
+    EVENTO_DTLB_FALLOS,
+    EVENTO_SALTOS_FALLIDOS,
+    NUM_EVENTOS_HARDWARE
+};
+
+struct LecturaHardware {
+    uint64_t valores[NUM_EVENTOS_HARDWARE] = {};
+    bool valida = false;
+
+    uint64_t ciclos() const { return valores[EVENTO_CICLOS]; }
+    uint64_t instrucciones() const { return valores[EVENTO_INSTRUCCIONES]; }
+};
+
+const char* nombre_evento_hardware(int evento);
+
+class ContadoresHardware {
+private:
+    int fds[NUM_EVENTOS_HARDWARE];
+    int lider;                     // fd del lider del grupo (-1 = ninguno)
+    bool activo;
+
+public:
+    ContadoresHardware();      // Abre los eventos para el hilo actual
+    ~ContadoresHardware();
+
+    ContadoresHardware(const ContadoresHardware&) = delete;
+    ContadoresHardware& operator=(const ContadoresHardware&) = delete;
+
+    bool disponible() const { return activo; }
+    bool evento_disponible(int evento) const { return fds[evento] >= 0; }
+
+    void iniciar();                // Reinicia y habilita
+    LecturaHardware detener();     // Deshabilita y lee
+};
@@ -1,43 +1,139 @@
-
 #pragma once
 
-const int TAM_MAX = 10000;
-const int PQ_MAX = 10000;
+// Contenedores de la Parte I. Guardan los datos en el heap y duplican su
+// capacidad cuando se llenan, asi que nunca descartan elementos (el mapa tiene
+// ~30K nodos y Dijkstra/A* pueden insertar hasta una vez por arista).
+// La capacidad se conserva entre busquedas: un motor que los reutiliza deja
+// de reservar memoria despues de las primeras consultas.
+
+const int TAM_INICIAL = 1024;
+const int PQ_INICIAL = 1024;
 
 class ColaInt {
 private:
-    int datos[TAM_MAX];
+    int* datos;
     int frente, fin;
+    int capacidad;
+
+    // Copia los elementos en orden al inicio del nuevo arreglo
+    void crecer() {
+        int nueva_capacidad = capacidad > 1 ? capacidad * 2 : TAM_INICIAL;
+        int* nuevos = new int[nueva_capacidad];
+        int n = tamano();
+        for (int i = 0; i < n; ++i) {
+            nuevos[i] = datos[(frente + i) % capacidad];
+        }
+        delete[] datos;
+        datos = nuevos;
+        capacidad = nueva_capacidad;
+        frente = 0;
+        fin = n;
+    }
 
 public:
-    ColaInt() {
+    ColaInt(int cap = TAM_INICIAL) {
+        capacidad = cap > 1 ? cap : 2;
+        datos = new int[capacidad];
         frente = 0;
         fin = 0;
     }
 
+    ~ColaInt() {
+        delete[] datos;
+    }
+
+    ColaInt(const ColaInt&) = delete;
+    ColaInt& operator=(const ColaInt&) = delete;
+
     bool vacia() const {
         return frente == fin;
     }
 
     bool llena() const {
-        return ((fin + 1) % TAM_MAX) == frente;
+        return ((fin + 1) % capacidad) == frente;
+    }
+
+    int tamano() const {
+        return (fin - frente + capacidad) % capacidad;
     }
 
     void encolar(int valor) {
-        if (!llena()) {
-            datos[fin] = valor;
-            fin = (fin + 1) % TAM_MAX;
-        }
+        if (llena()) crecer();
+        datos[fin] = valor;
+        fin = (fin + 1) % capacidad;
     }
 
     int desencolar() {
         if (!vacia()) {
             int val = datos[frente];
-            frente = (frente + 1) % TAM_MAX;
+            frente = (frente + 1) % capacidad;
             return val;
         }
         return -1;
     }
+
+    void limpiar() {
+        frente = 0;
+        fin = 0;
+    }
+};
+
+
+// Pila para el DFS iterativo (sin recursion)
+class PilaInt {
+private:
+    int* datos;
+    int tope;
+    int capacidad;
+
+    void crecer() {
+        int nueva_capacidad = capacidad > 1 ? capacidad * 2 : TAM_INICIAL;
+        int* nuevos = new int[nueva_capacidad];
+        for (int i = 0; i <= tope; ++i) {
+            nuevos[i] = datos[i];
+        }
+        delete[] datos;
+        datos = nuevos;
+        capacidad = nueva_capacidad;
+    }
+
+public:
+    PilaInt(int cap = TAM_INICIAL) {
+        capacidad = cap > 1 ? cap : 2;
+        datos = new int[capacidad];
+        tope = -1;
+    }
+
+    ~PilaInt() {
+        delete[] datos;
+    }
+
+    PilaInt(const PilaInt&) = delete;
+    PilaInt& operator=(const PilaInt&) = delete;
+
+    bool vacio() const {
+        return tope == -1;
+    }
+
+    int tamano() const {
+        return tope + 1;
+    }
+
+    void apilar(int valor) {
+        if (tope + 1 >= capacidad) crecer();
+        datos[++tope] = valor;
+    }
+
+    int desapilar() {
+        if (!vacio()) {
+            return datos[tope--];
+        }
+        return -1;
+    }
+
+    void limpiar() {
+        tope = -1;
+    }
 };
 
 
@@ -48,19 +144,45 @@ struct NodoPrioridad {
 
 class ColaPrioridad {
 private:
-    NodoPrioridad datos[PQ_MAX];
+    NodoPrioridad* datos;
     int cantidad;
+    int capacidad;
+
+    void crecer() {
+        int nueva_capacidad = capacidad > 1 ? capacidad * 2 : PQ_INICIAL;
+        NodoPrioridad* nuevos = new NodoPrioridad[nueva_capacidad];
+        for (int i = 0; i < cantidad; ++i) {
+            nuevos[i] = datos[i];
+        }
+        delete[] datos;
+        datos = nuevos;
+        capacidad = nueva_capacidad;
+    }
 
 public:
-    ColaPrioridad() {
+    ColaPrioridad(int cap = PQ_INICIAL) {
+        capacidad = cap > 1 ? cap : 2;
+        datos = new NodoPrioridad[capacidad];
         cantidad = 0;
     }
 
+    ~ColaPrioridad() {
+        delete[] datos;
+    }
+
+    ColaPrioridad(const ColaPrioridad&) = delete;
+    ColaPrioridad& operator=(const ColaPrioridad&) = delete;
+
     bool vacia() const {
         return cantidad == 0;
     }
 
+    int tamano() const {
+        return cantidad;
+    }
+
     void insertar(int id, float prioridad) {
+        if (cantidad >= capacidad) crecer();
         int i = cantidad++;
         while (i > 0 && prioridad < datos[(i - 1) / 2].prioridad) {
             datos[i] = datos[(i - 1) / 2];
@@ -86,4 +208,8 @@ public:
         datos[i] = ultimo;
         return id;
     }
+
+    void limpiar() {
+        cantidad = 0;
+    }
 };
@@ -1,27 +1,62 @@
 #pragma once
+#include "memoria.h"
+#include "arena.h"
+#include <algorithm>
 
-// Estructuras optimizadas para grafos grandes
+// Estructuras optimizadas para grafos grandes.
+// Con una arena, el arreglo sale de ella y lo libera el AlcanceArena de la
+// consulta (el destructor no hace nada); sin arena se reserva en el heap.
+// La capacidad inicial es solo una estimacion: si se llenan, duplican el
+// arreglo desde el mismo origen (en la arena el viejo queda hasta el final de
+// la consulta), asi que nunca descartan una insercion.
 const int TAM_MAX_GRANDE = 1000000;
 const int PQ_MAX_GRANDE = 1000000;
 
+// Capacidad inicial de las colas de una busqueda sobre un grafo de n nodos: la
+// fija de arriba hasta 2M nodos y despues la misma proporcion (media entrada
+// por nodo)
+inline int capacidad_cola_grande(int num_nodos) {
+    return num_nodos / 2 > PQ_MAX_GRANDE ? num_nodos / 2 : PQ_MAX_GRANDE;
+}
+
 // Cola optimizada para grafos grandes
 class ColaGrande {
 private:
     int* datos;
     int frente, fin, capacidad;
+    ArenaBusqueda* arena;
+
+    // Duplica el anillo dejando los elementos en orden desde la posicion 0
+    void crecer() {
+        int nueva_capacidad = std::max(capacidad * 2, 16);
+        int* nuevos = arena ? arena->reservar<int>(nueva_capacidad) : reservar_temporal<int>(nueva_capacidad);
+        int cantidad = tamano();
+        for (int i = 0; i < cantidad; ++i) {
+            nuevos[i] = datos[(frente + i) % capacidad];
+        }
+        if (!arena) liberar_temporal(datos, capacidad);
+        datos = nuevos;
+        capacidad = nueva_capacidad;
+        frente = 0;
+        fin = cantidad;
+    }
 
 public:
-    ColaGrande(int cap = TAM_MAX_GRANDE) {
+    ColaGrande(int cap = TAM_MAX_GRANDE, ArenaBusqueda* arena = nullptr) {
         capacidad = cap;
-        datos = new int[capacidad];
+        this->arena = arena;
+        datos = arena ? arena->reservar<int>(capacidad) : reservar_temporal<int>(capacidad);
         frente = 0;
         fin = 0;
     }
     
     ~ColaGrande() {
-        delete[] datos;
+        if (!arena) liberar_temporal(datos, capacidad);
     }
 
+    ColaGrande(const ColaGrande&) = delete;
+    ColaGrande& operator=(const ColaGrande&) = delete;
+
     bool vacia() const {
         return frente == fin;
     }
@@ -29,12 +64,19 @@ public:
     bool llena() const {
         return ((fin + 1) % capacidad) == frente;
     }
+    
+    int tamano() const {
+        return (fin - frente + capacidad) % capacidad;
+    }
+
+    size_t memoria_usada() const {
+        return (size_t)capacidad * sizeof(int);
+    }
 
     void encolar(int valor) {
-        if (!llena()) {
-            datos[fin] = valor;
-            fin = (fin + 1) % capacidad;
-        }
+        if (llena()) crecer();
+        datos[fin] = valor;
+        fin = (fin + 1) % capacidad;
     }
 
     int desencolar() {
@@ -64,18 +106,34 @@ private:
     NodoPrioridadGrande* datos;
     int cantidad;
     int capacidad;
+    ArenaBusqueda* arena;
+
+    void crecer() {
+        int nueva_capacidad = std::max(capacidad * 2, 16);
+        NodoPrioridadGrande* nuevos = arena ? arena->reservar<NodoPrioridadGrande>(nueva_capacidad)
+                                            : reservar_temporal<NodoPrioridadGrande>(nueva_capacidad);
+        std::copy(datos, datos + cantidad, nuevos);
+        if (!arena) liberar_temporal(datos, capacidad);
+        datos = nuevos;
+        capacidad = nueva_capacidad;
+    }
 
 public:
-    ColaPrioridadGrande(int cap = PQ_MAX_GRANDE) {
+    ColaPrioridadGrande(int cap = PQ_MAX_GRANDE, ArenaBusqueda* arena = nullptr) {
         capacidad = cap;
-        datos = new NodoPrioridadGrande[capacidad];
+        this->arena = arena;
+        datos = arena ? arena->reservar<NodoPrioridadGrande>(capacidad)
+                         : reservar_temporal<NodoPrioridadGrande>(capacidad);
         cantidad = 0;
     }
     
     ~ColaPrioridadGrande() {
-        delete[] datos;
+        if (!arena) liberar_temporal(datos, capacidad);
     }
 
+    ColaPrioridadGrande(const ColaPrioridadGrande&) = delete;
+    ColaPrioridadGrande& operator=(const ColaPrioridadGrande&) = delete;
+
     bool vacia() const {
         return cantidad == 0;
     }
@@ -83,9 +141,17 @@ public:
     bool llena() const {
         return cantidad >= capacidad;
     }
+    
+    int tamano() const {
+        return cantidad;
+    }
+
+    size_t memoria_usada() const {
+        return (size_t)capacidad * sizeof(NodoPrioridadGrande);
+    }
 
     void insertar(int id, float prioridad) {
-        if (llena()) return;
+        if (llena()) crecer();
         
         int i = cantidad++;
         while (i > 0 && prioridad < datos[(i - 1) / 2].prioridad) {
@@ -95,6 +161,15 @@ public:
         datos[i] = { id, prioridad };
     }
 
+    // Minimo sin extraerlo (cola no vacia)
+    int ver_min() const {
+        return datos[0].id;
+    }
+
+    float prioridad_min() const {
+        return datos[0].prioridad;
+    }
+
     int extraer_min() {
         if (vacia()) return -1;
         
@@ -125,18 +200,32 @@ private:
     int* datos;
     int tope;
     int capacidad;
+    ArenaBusqueda* arena;
+
+    void crecer() {
+        int nueva_capacidad = std::max(capacidad * 2, 16);
+        int* nuevos = arena ? arena->reservar<int>(nueva_capacidad) : reservar_temporal<int>(nueva_capacidad);
+        std::copy(datos, datos + tope + 1, nuevos);
+        if (!arena) liberar_temporal(datos, capacidad);
+        datos = nuevos;
+        capacidad = nueva_capacidad;
+    }
 
 public:
-    StackGrande(int cap = TAM_MAX_GRANDE) {
+    StackGrande(int cap = TAM_MAX_GRANDE, ArenaBusqueda* arena = nullptr) {
         capacidad = cap;
-        datos = new int[capacidad];
+        this->arena = arena;
+        datos = arena ? arena->reservar<int>(capacidad) : reservar_temporal<int>(capacidad);
         tope = -1;
     }
     
     ~StackGrande() {
-        delete[] datos;
+        if (!arena) liberar_temporal(datos, capacidad);
     }
 
+    StackGrande(const StackGrande&) = delete;
+    StackGrande& operator=(const StackGrande&) = delete;
+
     bool vacio() const {
         return tope == -1;
     }
@@ -144,11 +233,18 @@ public:
     bool lleno() const {
         return tope >= capacidad - 1;
     }
+    
+    int tamano() const {
+        return tope + 1;
+    }
+
+    size_t memoria_usada() const {
+        return (size_t)capacidad * sizeof(int);
+    }
 
     void apilar(int valor) {
-        if (!lleno()) {
-            datos[++tope] = valor;
-        }
+        if (lleno()) crecer();
+        datos[++tope] = valor;
     }
 
     int desapilar() {
@@ -162,54 +258,3 @@ public:
         tope = -1;
     }
 };
-
-// Pool de memoria para arrays temporales
-template<typename T>
-class MemoryPool {
-private:
-    T* pool;
-    bool* usado;
-    int capacidad;
-    int siguiente_libre;
-
-public:
-    MemoryPool(int cap) : capacidad(cap), siguiente_libre(0) {
-        pool = new T[capacidad];
-        usado = new bool[capacidad]();
-    }
-    
-    ~MemoryPool() {
-        delete[] pool;
-        delete[] usado;
-    }
-    
-    T* obtener_array(int tamano) {
-        if (siguiente_libre + tamano <= capacidad) {
-            T* ptr = &pool[siguiente_libre];
-            for (int i = 0; i < tamano; ++i) {
-                usado[siguiente_libre + i] = true;
-            }
-            siguiente_libre += tamano;
-            return ptr;
-        }
-        return nullptr; // Pool lleno
-    }
-    
-    void liberar_array(T* ptr, int tamano) {
-        int inicio = ptr - pool;
-        for (int i = 0; i < tamano; ++i) {
-            usado[inicio + i] = false;
-        }
-        // Recompactar si es necesario
-        if (inicio + tamano == siguiente_libre) {
-            siguiente_libre = inicio;
-        }
-    }
-    
-    void reset() {
-        siguiente_libre = 0;
-        for (int i = 0; i < capacidad; ++i) {
-            usado[i] = false;
-        }
-    }
-};
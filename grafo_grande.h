@@ -1,19 +1,68 @@
 #pragma once
 #include <vector>
 #include <memory>
+#include <string>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include "vista_grafo.h"
+#include "ubicacion_memoria.h"
+#include "resultado_ruta.h"
+#include "malla_obstaculos.h"
 
-// Configuración para grafo grande
-constexpr int MAX_NODES_LARGE = 2000000;  // 2 millones de nodos
-constexpr int AVG_DEGREE = 6;             // Grado promedio por nodo
-constexpr int MAX_EDGES_LARGE = MAX_NODES_LARGE * AVG_DEGREE;
+// Tamano por defecto del grafo sintetico; el tamano real se elige al generar
+// (generar_grafo_grande, generar_grafo_con_malla_obstaculos) sin recompilar
+constexpr int NODOS_GRAFO_DEFECTO = 2000000;  // 2 millones de nodos
+
+using VistaGrande = VistaCSR<float, IndiceArista>;
+
+// Semilla fija por defecto: dos corridas con la misma semilla generan el mismo grafo
+constexpr uint32_t SEMILLA_GRAFO_DEFECTO = 12345;
 
 // Estructura de grafo optimizada para memoria
 class GrafoGrande {
 private:
-    std::vector<int> offset;               // Offset para cada nodo
+    // Arreglos de construccion: se llenan con agregar_* y, si se ubica el grafo,
+    // se copian a regiones con la politica elegida y se liberan
+    std::vector<IndiceArista> offset;      // Offset para cada nodo
     std::vector<int> neighbors;            // Lista de vecinos
     std::vector<float> weights;            // Pesos de las aristas
     std::vector<float> pos_x, pos_y;       // Posiciones de nodos
+
+    // Punteros a la copia activa (los vectores o una region ubicada)
+    struct ArreglosCSR {
+        IndiceArista* offset = nullptr;
+        int* neighbors = nullptr;
+        float* weights = nullptr;
+        float* pos_x = nullptr;
+        float* pos_y = nullptr;
+    };
+    ArreglosCSR csr;
+    std::vector<ArreglosCSR> replicas;     // Una por nodo NUMA (DistribucionNuma::REPLICAS)
+    std::vector<std::unique_ptr<RegionMemoria>> regiones;
+    UbicacionGrafo ubicacion;
+    int64_t num_offsets = 0;
+    int64_t num_aristas = 0;
+
+    // Componentes (componentes.cpp). 'fuerte' numera las componentes fuertes de
+    // cada componente debil en el orden en que las cierra Tarjan: una arista
+    // entre dos de ellas siempre va de la de numero mayor a la de numero menor.
+    std::vector<int> componente;           // Componente debil de cada nodo (vacio = sin calcular)
+    std::vector<int> fuerte;
+    std::vector<int> tam_componentes;      // Nodos de cada componente debil
+    std::vector<int> tam_fuertes;          // Nodos de cada componente fuerte (todas las debiles juntas)
+    float factor_h = 0.0f;                 // Minimo peso / largo de arista (ver factor_heuristica)
+
+    // Transpuesto (aristas entrantes de cada nodo, formato CSR): se arma la
+    // primera vez que se pide y lo comparten todos los que buscan hacia atras
+    mutable std::vector<IndiceArista> offset_inverso;
+    mutable std::vector<int> vecinos_inversos;
+    mutable std::vector<float> pesos_inversos;
+    mutable std::atomic<bool> transpuesto_listo{false};
+    mutable std::mutex cerrojo_transpuesto;
+
+    void apuntar_a_vectores();
+    void construir_transpuesto() const;
     
 public:
     int num_nodos;                         // Número real de nodos generados
@@ -22,41 +71,135 @@ public:
     GrafoGrande();
     ~GrafoGrande();
     
-    bool inicializar();
+    // Construccion incremental: las aristas se agregan en orden de origen y
+    // cada nodo agrega su posicion; los tamanos previstos solo reservan
+    bool inicializar(int nodos_previstos = 0, int64_t aristas_previstas = 0);
     void agregar_arista(int origen, int destino, float peso);
     void agregar_posicion(float x, float y);
     void finalizar_construccion();
+    // En lugar de agregar_* y finalizar_construccion: toma arreglos CSR ya
+    // armados (generadores, importador_json.cpp). offset tiene num_nodos + 1 entradas.
+    void adoptar_csr(std::vector<IndiceArista>&& offset_csr, std::vector<int>&& vecinos, std::vector<float>&& pesos,
+                     std::vector<float>&& x, std::vector<float>&& y);
+
+    // Copia los arreglos a memoria con la politica pedida (ubicacion_memoria.h).
+    // Se llama sobre el grafo terminado, antes de compartirlo entre hilos; puede
+    // repetirse para cambiar de politica. false si no se pudo mapear la memoria
+    // (el grafo queda como estaba).
+    bool ubicar(const UbicacionGrafo& nueva);
+    const UbicacionGrafo& get_ubicacion() const { return ubicacion; }
     
     // Getters inline para performance
-    inline int get_offset_inicio(int nodo) const { return offset[nodo]; }
-    inline int get_offset_fin(int nodo) const { return offset[nodo + 1]; }
-    inline int get_vecino(int idx) const { return neighbors[idx]; }
-    inline float get_peso(int idx) const { return weights[idx]; }
-    inline float get_pos_x(int nodo) const { return pos_x[nodo]; }
-    inline float get_pos_y(int nodo) const { return pos_y[nodo]; }
+    inline IndiceArista get_offset_inicio(int nodo) const { return csr.offset[nodo]; }
+    inline IndiceArista get_offset_fin(int nodo) const { return csr.offset[nodo + 1]; }
+    inline int get_vecino(IndiceArista idx) const { return csr.neighbors[idx]; }
+    inline float get_peso(IndiceArista idx) const { return csr.weights[idx]; }
+    inline float get_pos_x(int nodo) const { return csr.pos_x[nodo]; }
+    inline float get_pos_y(int nodo) const { return csr.pos_y[nodo]; }
     inline int get_num_nodos_reales() const { return num_nodos; }
-    
-    int contar_aristas() const;
+
+    // Vista CSR sin duenos para las busquedas genericas (busqueda_generica.h).
+    // Con replicas devuelve la del nodo NUMA del hilo que llama.
+    inline VistaGrande vista() const {
+        const ArreglosCSR* a = &csr;
+        if (!replicas.empty()) {
+            size_t nodo = nodo_numa_del_hilo();
+            a = &replicas[nodo < replicas.size() ? nodo : 0];
+        }
+        return { a->offset, a->neighbors, a->weights, a->pos_x, a->pos_y, num_nodos };
+    }
+
+    // Vista del grafo transpuesto: los vecinos de v son los nodos con arista
+    // hacia v, con el mismo peso. La primera llamada lo arma (una sola vez
+    // aunque lo pidan varios hilos); las posiciones son las de vista().
+    VistaGrande vista_inversa() const;
+    size_t memoria_transpuesto() const;       // 0 si todavia no se armo
+
+    // Cambios locales de pesos (ej. obstaculos nuevos) sobre una copia que aun no
+    // se publico; requieren recustomizar el overlay. Con replicas se escriben
+    // todas (las regiones se abren y se vuelven a proteger en cada llamada). Si
+    // el transpuesto ya esta armado tambien se actualiza.
+    void set_peso(IndiceArista idx, float peso);
+
+    // Se llama al terminar la construccion o la carga; 0 hilos = todos los disponibles
+    void calcular_componentes(int hilos = 0);
+    void mostrar_componentes() const;        // Distribucion de tamanos
+    int num_componentes() const { return tam_componentes.size(); }
+    int num_componentes_fuertes() const { return tam_fuertes.size(); }
+
+    // Euclidiana * factor_heuristica() es admisible: lo usan las busquedas con
+    // cota (buscar_AStar_grande con ModoAStar). Se calcula junto con las
+    // componentes; si set_peso baja algun peso hay que recalcularlo.
+    void calcular_factor_heuristica();
+    float factor_heuristica() const { return factor_h; }
+
+    // O(1): false si destino seguro no es alcanzable desde origen (otra
+    // componente debil, o una fuerte que va antes en el orden topologico) o si
+    // algun nodo no existe. true no garantiza un camino. Las componentes miran
+    // la estructura, no los pesos: bloquear aristas con set_peso no las cambia.
+    inline bool puede_alcanzar(int origen, int destino) const {
+        if (origen < 0 || origen >= num_nodos || destino < 0 || destino >= num_nodos) return false;
+        if (componente.empty()) return true;
+        return componente[origen] == componente[destino] && fuerte[origen] >= fuerte[destino];
+    }
+
+    int64_t contar_aristas() const;
     size_t memoria_usada() const;
+    void mostrar_memoria_detallada() const;   // Por arreglo: tamano vs capacidad reservada
+    
+    // Snapshot binario (formato propio, ver grafo_grande.cpp). La carga rechaza
+    // un CSR inconsistente (offsets o ids de vecino fuera de rango)
+    bool guardar_snapshot(const std::string& archivo) const;
+    bool cargar_snapshot(const std::string& archivo);
 };
 
-// Instancia global del grafo
-extern std::unique_ptr<GrafoGrande> grafo_global;
-
-// Funciones de inicialización - NUEVAS con malla
-bool generar_grafo_grande();                    // Mantener compatibilidad
-bool generar_grafo_con_malla_obstaculos();      // NUEVO: Cumple requisito Parte II
-bool cargar_grafo_desde_archivo(const std::string& archivo);
-int contar_aristas_grandes();
-int obtener_num_nodos_reales();                 // NUEVO: Obtener número real de nodos generados
+// Un grafo terminado no se modifica: se comparte entre hilos como
+// std::shared_ptr<const GrafoGrande> (ver registro_grafos.h) y cada funcion
+// recibe el grafo que usa. Los constructores devuelven nullptr si fallan.
+// nodos / ancho x alto: tamano pedido (el de la malla son celdas; quedan como
+// nodos las libres, cerca del 88%).
+std::unique_ptr<GrafoGrande> generar_grafo_grande(uint32_t semilla = SEMILLA_GRAFO_DEFECTO,
+                                                  int nodos = NODOS_GRAFO_DEFECTO);                    // Mantener compatibilidad
+std::unique_ptr<GrafoGrande> generar_grafo_con_malla_obstaculos(uint32_t semilla = SEMILLA_GRAFO_DEFECTO,
+                                                                int ancho = GRID_WIDTH,
+                                                                int alto = GRID_HEIGHT);               // NUEVO: Cumple requisito Parte II
+// Con un objetivo en nodos (0 = el tamano por defecto): el sintetico exacto, la
+// malla cuadrada con el lado que deja unos 'nodos' transitables
+std::unique_ptr<GrafoGrande> generar_grafo_de_tamano(uint32_t semilla, bool malla, int64_t nodos);
+int lado_malla_de_tamano(int64_t nodos);      // Lado que usa generar_grafo_de_tamano (0 = GRID_WIDTH)
+std::unique_ptr<GrafoGrande> cargar_grafo_desde_archivo(const std::string& archivo);
+bool guardar_grafo_en_archivo(const GrafoGrande& grafo, const std::string& archivo);
+// Escribe el snapshot directamente desde arreglos CSR, sin armar un GrafoGrande
+bool guardar_snapshot_csr(const std::string& archivo, const IndiceArista* offset, const int* vecinos, const float* pesos,
+                          const float* pos_x, const float* pos_y, int64_t nodos, int64_t aristas);
 
 // Algoritmos adaptados para grafo grande
-void buscar_BFS_grande(int origen, int destino, int camino[], int& largo);
-void buscar_DFS_grande(int origen, int destino, int camino[], int& largo);
-void buscar_BestFirst_grande(int origen, int destino, int camino[], int& largo);
-void buscar_Dijkstra_grande(int origen, int destino, int camino[], int& largo);
-void buscar_AStar_grande(int origen, int destino, int camino[], int& largo);
+void buscar_BFS_grande(const GrafoGrande& grafo, int origen, int destino, ResultadoRuta& ruta);
+void buscar_DFS_grande(const GrafoGrande& grafo, int origen, int destino, ResultadoRuta& ruta);
+void buscar_BestFirst_grande(const GrafoGrande& grafo, int origen, int destino, ResultadoRuta& ruta);
+void buscar_Dijkstra_grande(const GrafoGrande& grafo, int origen, int destino, ResultadoRuta& ruta);
+void buscar_AStar_grande(const GrafoGrande& grafo, int origen, int destino, ResultadoRuta& ruta);
+
+// A* con cota de suboptimalidad (busqueda_acotada.h). Todas las variantes usan
+// la euclidiana escalada por factor_heuristica(), asi que el costo queda a lo
+// sumo epsilon veces el optimo; ruta.cota trae la cota alcanzada.
+enum class VarianteAStar {
+    PONDERADA,      // Prioridad g + epsilon * h
+    ARA,            // Anytime: baja epsilon desde epsilon_inicial hasta epsilon o el plazo
+    FOCAL           // Expande por h entre los abiertos con f <= epsilon * f_min
+};
+
+struct ModoAStar {
+    VarianteAStar variante = VarianteAStar::PONDERADA;
+    float epsilon = 1.5f;           // Cota pedida (>= 1)
+    float epsilon_inicial = 3.0f;   // ARA*: primera pasada
+    float paso = 0.5f;              // ARA*: baja de epsilon entre pasadas
+    double plazo_ms = 0.0;          // ARA*: deja de mejorar al vencer (0: hasta llegar a epsilon)
+};
+
+void buscar_AStar_grande(const GrafoGrande& grafo, int origen, int destino, ResultadoRuta& ruta,
+                         const ModoAStar& modo);
 
 // Funciones de utilidad
-float heuristica_grande(int nodo, int destino);
-float distancia_euclidiana(int nodo1, int nodo2);
+float heuristica_grande(const GrafoGrande& grafo, int nodo, int destino);
+float distancia_euclidiana(const GrafoGrande& grafo, int nodo1, int nodo2);
@@ -0,0 +1,100 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+
+// Histograma de latencias con cubetas logaritmicas (estilo HDR).
+//
+// Los valores (en nanosegundos) menores a 128 caen en cubetas de ancho 1. Cada
+// potencia de dos superior se divide en 64 cubetas iguales, asi que el error
+// relativo de cualquier percentil es menor a 1/64 (~1.6%) sin guardar las
+// muestras. Registrar es O(1) y sin bloqueos: cada hilo usa su propio
+// histograma y al final se combinan con combinar().
+class HistogramaLatencia {
+private:
+    static constexpr int BITS_SUBCUBETA = 6;                       // 64 cubetas por octava
+    static constexpr int SUBCUBETAS = 1 << BITS_SUBCUBETA;
+    static constexpr int LINEAL = 2 * SUBCUBETAS;                  // [0, 128) exacto
+    static constexpr int NUM_CUBETAS = LINEAL + (63 - BITS_SUBCUBETA) * SUBCUBETAS;
+
+    std::vector<uint64_t> cubetas;
+    uint64_t total;
+    uint64_t minimo_ns;
+    uint64_t maximo_ns;
+    double suma_ns;
+
+    static int indice_cubeta(uint64_t valor) {
+        if (valor < (uint64_t)LINEAL) return (int)valor;
+        int msb = 63 - __builtin_clzll(valor);
+        int desplazamiento = msb - BITS_SUBCUBETA;                 // valor >> desp. esta en [64, 128)
+        return desplazamiento * SUBCUBETAS + (int)(valor >> desplazamiento);
+    }
+
+    // Mayor valor que cae en la cubeta (los percentiles se reportan por arriba)
+    static uint64_t limite_superior(int indice) {
+        if (indice < LINEAL) return indice;
+        int desplazamiento = indice / SUBCUBETAS - 1;
+        uint64_t sub = indice % SUBCUBETAS + SUBCUBETAS;
+        return ((sub + 1) << desplazamiento) - 1;
+    }
+
+public:
+    HistogramaLatencia() : cubetas(NUM_CUBETAS, 0), total(0), minimo_ns(UINT64_MAX), maximo_ns(0), suma_ns(0) {}
+
+    void registrar(uint64_t ns) {
+        cubetas[indice_cubeta(ns)]++;
+        total++;
+        suma_ns += ns;
+        if (ns < minimo_ns) minimo_ns = ns;
+        if (ns > maximo_ns) maximo_ns = ns;
+    }
+
+    void registrar_ms(double ms) {
+        registrar(ms > 0 ? (uint64_t)(ms * 1e6 + 0.5) : 0);
+    }
+
+    void combinar(const HistogramaLatencia& otro) {
+        for (int i = 0; i < NUM_CUBETAS; ++i) {
+            cubetas[i] += otro.cubetas[i];
+        }
+        total += otro.total;
+        suma_ns += otro.suma_ns;
+        if (otro.minimo_ns < minimo_ns) minimo_ns = otro.minimo_ns;
+        if (otro.maximo_ns > maximo_ns) maximo_ns = otro.maximo_ns;
+    }
+
+    void limpiar() {
+        std::fill(cubetas.begin(), cubetas.end(), 0);
+        total = 0;
+        suma_ns = 0;
+        minimo_ns = UINT64_MAX;
+        maximo_ns = 0;
+    }
+
+    // Percentil p en [0, 100], en nanosegundos
+    uint64_t percentil(double p) const {
+        if (total == 0) return 0;
+        uint64_t objetivo = (uint64_t)(p / 100.0 * total + 0.5);
+        if (objetivo < 1) objetivo = 1;
+        if (objetivo > total) objetivo = total;
+
+        uint64_t acumulado = 0;
+        for (int i = 0; i < NUM_CUBETAS; ++i) {
+            acumulado += cubetas[i];
+            if (acumulado >= objetivo) {
+                uint64_t valor = limite_superior(i);
+                return valor < maximo_ns ? valor : maximo_ns;
+            }
+        }
+        return maximo_ns;
+    }
+
+    double percentil_ms(double p) const { return percentil(p) / 1e6; }
+
+    uint64_t cantidad() const { return total; }
+    uint64_t minimo() const { return total ? minimo_ns : 0; }
+    uint64_t maximo() const { return maximo_ns; }
+    double promedio_ns() const { return total ? suma_ns / total : 0.0; }
+    size_t memoria_usada() const { return cubetas.size() * sizeof(uint64_t); }
+};
@@ -0,0 +1,513 @@
+#include "hpa_malla.h"
+#include "estructuras_grandes.h"
+#include "arena.h"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+using namespace std;
+using namespace std::chrono;
+
+static const float INFINITO_HPA = numeric_limits<float>::infinity();
+
+namespace {
+
+// Rectangulo de celdas [x0, x1) x [y0, y1)
+struct RectanguloCluster {
+    int x0, y0, x1, y1;
+
+    bool contiene(float x, float y) const { return x >= x0 && x < x1 && y >= y0 && y < y1; }
+};
+
+// Estado de las busquedas de un hilo (locales y abstracta) con sellos de
+// generacion: una consulta solo toca los nodos que visita, no los 2M del grafo
+struct EspacioHPA {
+    uint32_t generacion = 0;
+    vector<uint32_t> sello;                    // == generacion: datos validos en esta busqueda
+    vector<float> distancia;
+    vector<int> padre;
+    vector<char> asentado;
+    // Arreglos de AbstraccionHPA::buscar: conservan la capacidad entre consultas
+    vector<float> desde_origen, hasta_destino;
+    vector<int> abstracto, tramo;
+
+    void nueva_busqueda(int n) {
+        if ((int)sello.size() < n) {
+            sello.resize(n, 0);
+            distancia.resize(n);
+            padre.resize(n);
+            asentado.resize(n);
+        }
+        if (++generacion == 0) {
+            fill(sello.begin(), sello.end(), 0);
+            generacion = 1;
+        }
+    }
+
+    float dist(int v) const { return sello[v] == generacion ? distancia[v] : INFINITO_HPA; }
+    bool es_asentado(int v) const { return sello[v] == generacion && asentado[v]; }
+    void poner(int v, float d, int p) {
+        if (sello[v] != generacion) {
+            sello[v] = generacion;
+            asentado[v] = 0;
+        }
+        distancia[v] = d;
+        padre[v] = p;
+    }
+};
+
+thread_local EspacioHPA espacio_hpa;
+
+// Menor peso finito de las aristas u -> v (infinito si no hay)
+float peso_arista(const VistaGrande& vista, int u, int v) {
+    float mejor = INFINITO_HPA;
+    vista.para_cada_vecino(u, [&](int w, float peso) {
+        if (w == v && peso < mejor) mejor = peso;
+    });
+    return mejor;
+}
+
+// Aristas entrantes de v: en la malla solo pueden venir de las 8 celdas vecinas
+template<typename F>
+void para_cada_entrante(const VistaGrande& vista, const int* nodo_en_celda, int ancho, int alto, int v, F f) {
+    const int x = (int)vista.x(v), y = (int)vista.y(v);
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            int nx = x + dx, ny = y + dy;
+            if ((dx == 0 && dy == 0) || nx < 0 || ny < 0 || nx >= ancho || ny >= alto) continue;
+            int u = nodo_en_celda[(size_t)ny * ancho + nx];
+            if (u < 0) continue;
+            vista.para_cada_vecino(u, [&](int w, float peso) {
+                if (w == v) f(u, peso);
+            });
+        }
+    }
+}
+
+// Dijkstra (o A* hacia 'meta' si meta >= 0) sin salir del rectangulo. Con
+// 'nodo_en_celda' recorre las aristas al reves. 'al_asentar(v, d)' devuelve
+// true para terminar. Las aristas con peso infinito no existen. Devuelve los
+// nodos asentados.
+template<typename AlAsentar>
+int busqueda_local(const VistaGrande& vista, const RectanguloCluster& r, const int* nodo_en_celda,
+                   int ancho, int alto, int desde, int meta, float factor, EspacioHPA& espacio,
+                   ColaPrioridadGrande& cola, AlAsentar al_asentar) {
+    auto h = [&](int v) {
+        if (meta < 0) return 0.0f;
+        float dx = vista.x(v) - vista.x(meta), dy = vista.y(v) - vista.y(meta);
+        return sqrtf(dx * dx + dy * dy) * factor;
+    };
+    espacio.nueva_busqueda(vista.num_nodos());
+    cola.limpiar();
+    espacio.poner(desde, 0.0f, -1);
+    cola.insertar(desde, h(desde));
+    int asentados = 0;
+    while (!cola.vacia()) {
+        int actual = cola.extraer_min();
+        if (espacio.es_asentado(actual)) continue;
+        espacio.asentado[actual] = 1;
+        asentados++;
+        const float d = espacio.distancia[actual];
+        if (al_asentar(actual, d) || actual == meta) break;
+
+        auto relajar = [&](int vecino, float peso) {
+            float nueva = d + peso;
+            if (peso == INFINITO_HPA || !r.contiene(vista.x(vecino), vista.y(vecino))) return;
+            if (espacio.es_asentado(vecino) || nueva >= espacio.dist(vecino)) return;
+            espacio.poner(vecino, nueva, actual);
+            cola.insertar(vecino, nueva + h(vecino));
+        };
+        if (nodo_en_celda) para_cada_entrante(vista, nodo_en_celda, ancho, alto, actual, relajar);
+        else vista.para_cada_vecino(actual, relajar);
+    }
+    return asentados;
+}
+
+} // namespace
+
+AbstraccionHPA::AbstraccionHPA(const GrafoGrande& g, int tam) : grafo(&g), tam_cluster(max(2, tam)) {}
+
+int AbstraccionHPA::cluster_de(int nodo) const {
+    int cx = (int)grafo->get_pos_x(nodo) / tam_cluster;
+    int cy = (int)grafo->get_pos_y(nodo) / tam_cluster;
+    return cy * clusters_x + cx;
+}
+
+int AbstraccionHPA::num_transiciones() const {
+    int total = 0;
+    for (const ClusterHPA& c : clusters) total += c.nodos.size();
+    return total;
+}
+
+// Transiciones del borde entre los clusters c y 'vecino' (a la derecha, izquierda,
+// arriba o abajo). Una posicion del borde esta abierta si sus dos celdas tienen
+// nodo y hay una arista finita entre ellas; desde ambos lados se ven las mismas.
+void AbstraccionHPA::agregar_transiciones(int c, int vecino, vector<int>& propias, vector<int>& ajenas) const {
+    VistaGrande vista = grafo->vista();
+    const int cx = c % clusters_x, cy = c / clusters_x;
+    const int vx = vecino % clusters_x, vy = vecino / clusters_x;
+    const bool vertical = cy == vy;            // Borde vertical: clusters uno al lado del otro
+    int largo, x_propia, y_propia, x_ajena, y_ajena;
+    if (vertical) {
+        x_propia = vx > cx ? (cx + 1) * tam_cluster - 1 : cx * tam_cluster;
+        x_ajena = vx > cx ? x_propia + 1 : x_propia - 1;
+        y_propia = y_ajena = cy * tam_cluster;
+        largo = min(tam_cluster, alto - y_propia);
+    } else {
+        y_propia = vy > cy ? (cy + 1) * tam_cluster - 1 : cy * tam_cluster;
+        y_ajena = vy > cy ? y_propia + 1 : y_propia - 1;
+        x_propia = x_ajena = cx * tam_cluster;
+        largo = min(tam_cluster, ancho - x_propia);
+    }
+    auto par = [&](int i, int& propia, int& ajena) {
+        int dx = vertical ? 0 : i, dy = vertical ? i : 0;
+        propia = nodo_en_celda[(size_t)(y_propia + dy) * ancho + x_propia + dx];
+        ajena = nodo_en_celda[(size_t)(y_ajena + dy) * ancho + x_ajena + dx];
+    };
+    auto abierta = [&](int i) {
+        int propia, ajena;
+        par(i, propia, ajena);
+        return propia >= 0 && ajena >= 0 &&
+               (peso_arista(vista, propia, ajena) < INFINITO_HPA || peso_arista(vista, ajena, propia) < INFINITO_HPA);
+    };
+    auto agregar = [&](int i) {
+        int propia, ajena;
+        par(i, propia, ajena);
+        propias.push_back(propia);
+        ajenas.push_back(ajena);
+    };
+    for (int i = 0; i < largo; ) {
+        if (!abierta(i)) {
+            ++i;
+            continue;
+        }
+        int fin = i;
+        while (fin + 1 < largo && abierta(fin + 1)) ++fin;
+        if (fin - i + 1 >= HPA_LARGO_ENTRADA_DOBLE) {
+            agregar(i);
+            agregar(fin);
+        } else {
+            agregar((i + fin) / 2);
+        }
+        i = fin + 1;
+    }
+}
+
+// Transiciones, aristas de salida y matriz de distancias de un cluster. Solo
+// escribe datos del cluster c (y indice_local de sus nodos): los clusters se
+// construyen en paralelo sin bloqueos.
+void AbstraccionHPA::construir_cluster(int c) {
+    VistaGrande vista = grafo->vista();
+    ClusterHPA& cluster = clusters[c];
+    for (int v : cluster.nodos) indice_local[v] = -1;
+
+    const int cx = c % clusters_x, cy = c / clusters_x;
+    vector<int> propias, ajenas;
+    if (cx > 0) agregar_transiciones(c, c - 1, propias, ajenas);
+    if (cx + 1 < clusters_x) agregar_transiciones(c, c + 1, propias, ajenas);
+    if (cy > 0) agregar_transiciones(c, c - clusters_x, propias, ajenas);
+    if (cy + 1 < clusters_y) agregar_transiciones(c, c + clusters_x, propias, ajenas);
+
+    // Nodos sin repetir (una esquina puede ser transicion de dos bordes)
+    cluster.nodos.clear();
+    for (int v : propias) {
+        if (indice_local[v] < 0) {
+            indice_local[v] = cluster.nodos.size();
+            cluster.nodos.push_back(v);
+        }
+    }
+    const int k = cluster.nodos.size();
+    vector<int> cuenta(k + 1, 0);
+    for (size_t t = 0; t < propias.size(); ++t) {
+        if (peso_arista(vista, propias[t], ajenas[t]) < INFINITO_HPA) cuenta[indice_local[propias[t]] + 1]++;
+    }
+    for (int i = 0; i < k; ++i) cuenta[i + 1] += cuenta[i];
+    cluster.inicio_salidas = cuenta;
+    cluster.destino_salidas.assign(cuenta[k], -1);
+    cluster.peso_salidas.assign(cuenta[k], INFINITO_HPA);
+    for (size_t t = 0; t < propias.size(); ++t) {
+        float peso = peso_arista(vista, propias[t], ajenas[t]);
+        if (peso == INFINITO_HPA) continue;
+        int idx = cuenta[indice_local[propias[t]]]++;
+        cluster.destino_salidas[idx] = ajenas[t];
+        cluster.peso_salidas[idx] = peso;
+    }
+
+    // Fila i de la matriz: Dijkstra desde la transicion i hasta asentar las demas
+    const RectanguloCluster r = { cx * tam_cluster, cy * tam_cluster,
+                                  min(ancho, (cx + 1) * tam_cluster), min(alto, (cy + 1) * tam_cluster) };
+    cluster.distancias.assign((size_t)k * k, INFINITO_HPA);
+    if (k == 0) return;
+    ArenaBusqueda& arena = arena_del_hilo();
+    AlcanceArena alcance(arena);
+    ColaPrioridadGrande cola(tam_cluster * tam_cluster * 8, &arena);
+    for (int i = 0; i < k; ++i) {
+        int pendientes = k;
+        busqueda_local(vista, r, nullptr, ancho, alto, cluster.nodos[i], -1, 0.0f, espacio_hpa, cola,
+                       [&](int v, float d) {
+                           int j = indice_local[v];
+                           if (j < 0 || cluster.nodos[j] != v) return false;
+                           cluster.distancias[(size_t)i * k + j] = d;
+                           return --pendientes == 0;
+                       });
+    }
+}
+
+// La heuristica sigue siendo admisible si los pesos nuevos bajan
+void AbstraccionHPA::ajustar_factor(int nodo) {
+    VistaGrande vista = grafo->vista();
+    vista.para_cada_vecino(nodo, [&](int v, float peso) {
+        float dx = vista.x(v) - vista.x(nodo), dy = vista.y(v) - vista.y(nodo);
+        float largo = sqrtf(dx * dx + dy * dy);
+        if (largo > 0.0f) factor_heuristica = min(factor_heuristica, peso / largo);
+    });
+}
+
+bool AbstraccionHPA::construir(int hilos) {
+    VistaGrande vista = grafo->vista();
+    const int n = vista.num_nodos();
+    if (n == 0) return false;
+
+    // Celdas de la malla a partir de las posiciones
+    ancho = alto = 0;
+    for (int v = 0; v < n; ++v) {
+        float x = vista.x(v), y = vista.y(v);
+        if (x < 0 || y < 0 || x != floorf(x) || y != floorf(y)) {
+            cerr << "HPA*: las posiciones no son celdas de una malla" << endl;
+            return false;
+        }
+        ancho = max(ancho, (int)x + 1);
+        alto = max(alto, (int)y + 1);
+    }
+    nodo_en_celda.assign((size_t)ancho * alto, -1);
+    for (int v = 0; v < n; ++v) {
+        int& celda = nodo_en_celda[(size_t)vista.y(v) * ancho + (int)vista.x(v)];
+        if (celda >= 0) {
+            cerr << "HPA*: dos nodos en la misma celda" << endl;
+            return false;
+        }
+        celda = v;
+    }
+
+    factor_heuristica = INFINITO_HPA;
+    for (int v = 0; v < n; ++v) ajustar_factor(v);
+    if (factor_heuristica == INFINITO_HPA) factor_heuristica = 0.0f;
+
+    clusters_x = (ancho + tam_cluster - 1) / tam_cluster;
+    clusters_y = (alto + tam_cluster - 1) / tam_cluster;
+    clusters.assign((size_t)clusters_x * clusters_y, ClusterHPA());
+    indice_local.assign(n, -1);
+
+    const int total = clusters.size();
+    #pragma omp parallel for num_threads(max(1, hilos)) schedule(dynamic, 4)
+    for (int c = 0; c < total; ++c) {
+        construir_cluster(c);
+    }
+    return true;
+}
+
+void AbstraccionHPA::actualizar_clusters(const vector<int>& nodos_modificados, int hilos) {
+    vector<char> marcado(clusters.size(), 0);
+    vector<int> afectados;
+    auto marcar = [&](int c) {
+        if (!marcado[c]) {
+            marcado[c] = 1;
+            afectados.push_back(c);
+        }
+    };
+    const int n = grafo->get_num_nodos_reales();
+    for (int v : nodos_modificados) {
+        if (v < 0 || v >= n) continue;
+        // Las aristas de v y las que llegan a v salen de celdas vecinas
+        ajustar_factor(v);
+        para_cada_entrante(grafo->vista(), nodo_en_celda.data(), ancho, alto, v,
+                           [&](int u, float) { ajustar_factor(u); });
+        int c = cluster_de(v);
+        int cx = c % clusters_x, cy = c / clusters_x;
+        marcar(c);
+        // Un borde cambiado tambien cambia las transiciones del vecino
+        if (cx > 0) marcar(c - 1);
+        if (cx + 1 < clusters_x) marcar(c + 1);
+        if (cy > 0) marcar(c - clusters_x);
+        if (cy + 1 < clusters_y) marcar(c + clusters_x);
+    }
+
+    #pragma omp parallel for num_threads(max(1, hilos)) schedule(dynamic, 1)
+    for (int i = 0; i < (int)afectados.size(); ++i) {
+        construir_cluster(afectados[i]);
+    }
+}
+
+void AbstraccionHPA::buscar(int origen, int destino, ResultadoRuta& ruta) const {
+    ruta.reiniciar();
+    VistaGrande vista = grafo->vista();
+    const int n = vista.num_nodos();
+    if (clusters.empty() || !grafo->puede_alcanzar(origen, destino)) return;
+    if (origen == destino) {
+        *ruta.extender(1) = origen;
+        ruta.estado = EstadoRuta::ENCONTRADA;
+        return;
+    }
+
+    ArenaBusqueda& arena = arena_del_hilo();
+    AlcanceArena alcance(arena);
+    ColaPrioridadGrande cola(capacidad_cola_grande(n), &arena);
+    EspacioHPA& espacio = espacio_hpa;
+    auto rectangulo = [&](int c) {
+        int cx = c % clusters_x, cy = c / clusters_x;
+        return RectanguloCluster{ cx * tam_cluster, cy * tam_cluster,
+                                  min(ancho, (cx + 1) * tam_cluster), min(alto, (cy + 1) * tam_cluster) };
+    };
+    const int c_origen = cluster_de(origen), c_destino = cluster_de(destino);
+    const ClusterHPA& cluster_origen = clusters[c_origen];
+    const ClusterHPA& cluster_destino = clusters[c_destino];
+    int asentados = 0;
+
+    // 1. Origen hasta las transiciones de su cluster (y el destino si esta en el mismo)
+    vector<float>& desde_origen = espacio.desde_origen;
+    desde_origen.assign(cluster_origen.nodos.size(), INFINITO_HPA);
+    float directo = INFINITO_HPA;
+    {
+        int pendientes = cluster_origen.nodos.size() + (c_origen == c_destino ? 1 : 0);
+        asentados += busqueda_local(vista, rectangulo(c_origen), nullptr, ancho, alto, origen, -1, 0.0f,
+                                    espacio, cola, [&](int v, float d) {
+            int i = indice_local[v];
+            bool objetivo = false;
+            if (i >= 0) {
+                desde_origen[i] = d;
+                objetivo = true;
+            }
+            if (v == destino) {
+                directo = d;
+                objetivo = true;
+            }
+            return objetivo && --pendientes == 0;
+        });
+    }
+    // 2. Transiciones del cluster destino hasta el destino (aristas al reves)
+    vector<float>& hasta_destino = espacio.hasta_destino;
+    hasta_destino.assign(cluster_destino.nodos.size(), INFINITO_HPA);
+    {
+        int pendientes = cluster_destino.nodos.size();
+        if (pendientes > 0) {
+            asentados += busqueda_local(vista, rectangulo(c_destino), nodo_en_celda.data(), ancho, alto, destino,
+                                        -1, 0.0f, espacio, cola, [&](int v, float d) {
+                int i = indice_local[v];
+                if (i < 0) return false;
+                hasta_destino[i] = d;
+                return --pendientes == 0;
+            });
+        }
+    }
+
+    // 3. A* sobre el grafo abstracto: origen, transiciones y destino
+    auto h = [&](int v) {
+        float dx = vista.x(v) - vista.x(destino), dy = vista.y(v) - vista.y(destino);
+        return sqrtf(dx * dx + dy * dy) * factor_heuristica;
+    };
+    espacio.nueva_busqueda(n);
+    cola.limpiar();
+    espacio.poner(origen, 0.0f, -1);
+    cola.insertar(origen, h(origen));
+    bool encontrado = false;
+    while (!cola.vacia()) {
+        int actual = cola.extraer_min();
+        if (espacio.es_asentado(actual)) continue;
+        espacio.asentado[actual] = 1;
+        asentados++;
+        if (actual == destino) {
+            encontrado = true;
+            break;
+        }
+        const float d = espacio.distancia[actual];
+        auto relajar = [&](int v, float peso) {
+            float nueva = d + peso;
+            if (peso == INFINITO_HPA || espacio.es_asentado(v) || nueva >= espacio.dist(v)) return;
+            espacio.poner(v, nueva, actual);
+            cola.insertar(v, nueva + h(v));
+        };
+        if (actual == origen) {
+            for (size_t i = 0; i < desde_origen.size(); ++i) relajar(cluster_origen.nodos[i], desde_origen[i]);
+            relajar(destino, directo);
+        }
+        const int i = indice_local[actual];
+        if (i < 0) continue;
+        const int c = cluster_de(actual);
+        const ClusterHPA& cluster = clusters[c];
+        const int k = cluster.nodos.size();
+        for (int j = 0; j < k; ++j) {
+            if (j != i) relajar(cluster.nodos[j], cluster.distancias[(size_t)i * k + j]);
+        }
+        for (int s = cluster.inicio_salidas[i]; s < cluster.inicio_salidas[i + 1]; ++s) {
+            relajar(cluster.destino_salidas[s], cluster.peso_salidas[s]);
+        }
+        if (c == c_destino) relajar(destino, hasta_destino[i]);
+    }
+    if (!encontrado) {
+        ruta.nodos_asentados = asentados;
+        return;
+    }
+    vector<int>& abstracto = espacio.abstracto;
+    abstracto.clear();
+    for (int v = destino; v != -1; v = espacio.padre[v]) abstracto.push_back(v);
+    reverse(abstracto.begin(), abstracto.end());
+
+    // 4. Refinar: los tramos entre clusters son una arista real, los demas un A*
+    //    acotado al cluster del tramo
+    *ruta.extender(1) = origen;
+    float costo = 0.0f;
+    vector<int>& tramo = espacio.tramo;
+    for (size_t t = 0; t + 1 < abstracto.size(); ++t) {
+        const int u = abstracto[t], v = abstracto[t + 1];
+        const int c = cluster_de(u);
+        if (c != cluster_de(v)) {
+            costo += peso_arista(vista, u, v);
+            *ruta.extender(1) = v;
+            continue;
+        }
+        asentados += busqueda_local(vista, rectangulo(c), nullptr, ancho, alto, u, v, factor_heuristica,
+                                    espacio, cola, [](int, float) { return false; });
+        if (!espacio.es_asentado(v)) {         // Matriz desactualizada: faltan actualizar_clusters
+            ruta.reiniciar();
+            ruta.nodos_asentados = asentados;
+            return;
+        }
+        costo += espacio.distancia[v];
+        tramo.clear();
+        for (int w = v; w != u; w = espacio.padre[w]) tramo.push_back(w);
+        int* destino_tramo = ruta.extender(tramo.size());
+        for (size_t w = 0; w < tramo.size(); ++w) destino_tramo[w] = tramo[tramo.size() - 1 - w];
+    }
+    ruta.estado = EstadoRuta::ENCONTRADA;
+    ruta.costo = costo;
+    ruta.nodos_asentados = asentados;
+}
+
+size_t AbstraccionHPA::memoria_usada() const {
+    size_t memoria = nodo_en_celda.size() * sizeof(int) + indice_local.size() * sizeof(int) +
+                     clusters.size() * sizeof(ClusterHPA);
+    for (const ClusterHPA& c : clusters) {
+        memoria += c.nodos.capacity() * sizeof(int) + c.distancias.capacity() * sizeof(float) +
+                   c.inicio_salidas.capacity() * sizeof(int) + c.destino_salidas.capacity() * sizeof(int) +
+                   c.peso_salidas.capacity() * sizeof(float);
+    }
+    return memoria;
+}
+
+unique_ptr<AbstraccionHPA> construir_abstraccion_hpa(const GrafoGrande& grafo, int tam_cluster, int hilos) {
+    cout << "=== CONSTRUYENDO ABSTRACCION HPA* ===" << endl;
+    auto hpa = make_unique<AbstraccionHPA>(grafo, tam_cluster);
+    auto inicio = high_resolution_clock::now();
+    if (!hpa->construir(hilos)) {
+        return nullptr;
+    }
+    auto fin = high_resolution_clock::now();
+    cout << "Clusters de " << tam_cluster << "x" << tam_cluster << ": " << hpa->num_clusters()
+         << ", transiciones: " << hpa->num_transiciones() << ", " << duration_cast<milliseconds>(fin - inicio).count()
+         << " ms con " << max(1, hilos) << " hilos" << endl;
+    cout << "Memoria de la abstraccion: " << (hpa->memoria_usada() / 1024.0 / 1024.0) << " MB" << endl;
+    return hpa;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "grafo_grande.h"
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+// HPA* (pathfinding jerarquico) sobre el grafo de MallaConObstaculos.
+//
+// Usa las posiciones de los nodos como celdas de la malla (enteras y sin
+// repetir) y la divide en clusters de tam_cluster x tam_cluster celdas. En
+// cada borde entre dos clusters vecinos, los tramos seguidos de celdas
+// conectadas a traves del borde son entradas: las cortas aportan una
+// transicion en el medio y las largas una en cada extremo. Cada cluster guarda
+// sus nodos de transicion, la matriz de distancias entre ellos sin salir del
+// cluster y las aristas reales que cruzan a los clusters vecinos.
+//
+// Una consulta conecta origen y destino con las transiciones de sus clusters,
+// corre A* sobre el grafo abstracto y despues refina cada tramo con un A*
+// acotado al cluster que cruza. El costo es el de una ruta real; puede ser
+// algo mayor que el optimo porque solo se cruza por las transiciones.
+//
+// Los clusters se construyen en paralelo (OpenMP) y son independientes: si
+// cambian pesos (set_peso; infinito = celda bloqueada) se reconstruyen solo
+// los clusters tocados y sus vecinos.
+
+constexpr int HPA_TAM_CLUSTER = 32;
+constexpr int HPA_LARGO_ENTRADA_DOBLE = 6;     // Entradas desde este largo usan dos transiciones
+
+struct ClusterHPA {
+    std::vector<int> nodos;                    // Nodos de transicion (ids del grafo)
+    std::vector<float> distancias;             // nodos x nodos, sin salir del cluster (infinito = no hay)
+    std::vector<int> inicio_salidas;           // Aristas a otros clusters de cada transicion (formato CSR)
+    std::vector<int> destino_salidas;
+    std::vector<float> peso_salidas;
+};
+
+// Como el overlay, apunta al grafo sobre el que se construyo; los cambios de
+// pesos posteriores se incorporan con actualizar_clusters.
+class AbstraccionHPA {
+private:
+    const GrafoGrande* grafo;
+    int tam_cluster;
+    int ancho = 0, alto = 0;                   // Malla en celdas
+    int clusters_x = 0, clusters_y = 0;
+    std::vector<int> nodo_en_celda;            // -1 = celda sin nodo
+    std::vector<ClusterHPA> clusters;
+    std::vector<int> indice_local;             // Posicion en clusters[c].nodos (-1 = no es de transicion)
+    float factor_heuristica = 0.0f;            // Minimo peso / distancia: euclidiana * factor es admisible
+
+    int cluster_de(int nodo) const;
+    void agregar_transiciones(int c, int vecino, std::vector<int>& propias, std::vector<int>& ajenas) const;
+    void construir_cluster(int c);
+    void ajustar_factor(int nodo);
+
+public:
+    AbstraccionHPA(const GrafoGrande& g, int tam_cluster);
+
+    // false si el grafo esta vacio o sus posiciones no son celdas de una malla
+    bool construir(int hilos);
+    // Tras cambiar pesos de aristas de estos nodos (en cualquier sentido)
+    void actualizar_clusters(const std::vector<int>& nodos_modificados, int hilos);
+
+    void buscar(int origen, int destino, ResultadoRuta& ruta) const;
+
+    int num_clusters() const { return clusters.size(); }
+    int num_transiciones() const;
+    size_t memoria_usada() const;
+};
+
+// nullptr si la construccion falla. El grafo debe vivir al menos lo mismo que la abstraccion.
+std::unique_ptr<AbstraccionHPA> construir_abstraccion_hpa(const GrafoGrande& grafo,
+                                                          int tam_cluster = HPA_TAM_CLUSTER, int hilos = 1);
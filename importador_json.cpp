@@ -0,0 +1,518 @@
+#include "importador_json.h"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+using namespace std::chrono;
+
+static const double RADIO_TIERRA_M = 6371000.0;
+static const double RAD = M_PI / 180.0;
+
+namespace {
+
+// Lector por bloques: nunca tiene mas de un bloque del archivo en memoria
+class LectorJson {
+private:
+    FILE* archivo;
+    vector<char> bloque;
+    size_t pos = 0, fin = 0;
+
+    bool rellenar() {
+        pos = 0;
+        fin = fread(bloque.data(), 1, bloque.size(), archivo);
+        bytes += fin;
+        return fin > 0;
+    }
+
+public:
+    int64_t bytes = 0;
+    bool error = false;
+
+    LectorJson(FILE* f, size_t tam_bloque) : archivo(f), bloque(max<size_t>(tam_bloque, 64)) {}
+
+    // -1 al final del archivo
+    int ver() {
+        if (pos == fin && !rellenar()) return -1;
+        return (unsigned char)bloque[pos];
+    }
+
+    int tomar() {
+        int c = ver();
+        if (c >= 0) pos++;
+        return c;
+    }
+
+    void saltar_espacios() {
+        int c;
+        while ((c = ver()) == ' ' || c == '\n' || c == '\r' || c == '\t') pos++;
+    }
+
+    bool esperar(char esperado) {
+        saltar_espacios();
+        if (tomar() != esperado) error = true;
+        return !error;
+    }
+
+    // Cadena entre comillas. Los escapes se copian sin traducir: las claves
+    // que importan no los tienen y al resto solo hay que saltarlo.
+    bool leer_cadena(string& texto) {
+        texto.clear();
+        if (!esperar('"')) return false;
+        int c;
+        while ((c = tomar()) != '"') {
+            if (c < 0) return !(error = true);
+            if (c == '\\') {
+                texto.push_back('\\');
+                c = tomar();
+                if (c < 0) return !(error = true);
+            }
+            texto.push_back((char)c);
+        }
+        return true;
+    }
+
+    // Numero, true/false/null o cadena con un numero adentro (ids como texto)
+    bool leer_escalar(char* token, int capacidad) {
+        saltar_espacios();
+        int largo = 0;
+        bool entre_comillas = ver() == '"';
+        if (entre_comillas) pos++;
+        int c;
+        while ((c = ver()) >= 0) {
+            if (entre_comillas ? c == '"'
+                               : (c == ',' || c == '}' || c == ']' || c == ' ' || c == '\n' || c == '\r' || c == '\t')) {
+                break;
+            }
+            if (largo + 1 >= capacidad) return !(error = true);
+            token[largo++] = (char)c;
+            pos++;
+        }
+        if (entre_comillas && tomar() != '"') error = true;
+        token[largo] = '\0';
+        if (largo == 0) error = true;
+        return !error;
+    }
+
+    // Cualquier valor, con objetos y arreglos anidados, sin guardar nada
+    bool saltar_valor() {
+        saltar_espacios();
+        int profundidad = 0;
+        do {
+            int c = tomar();
+            if (c < 0) return !(error = true);
+            if (c == '"') {
+                while ((c = tomar()) != '"') {
+                    if (c < 0) return !(error = true);
+                    if (c == '\\') tomar();
+                }
+            } else if (c == '{' || c == '[') {
+                profundidad++;
+            } else if (c == '}' || c == ']') {
+                profundidad--;
+            } else if (profundidad == 0) {
+                // Escalar suelto: hasta el separador (que queda para quien llama)
+                while ((c = ver()) >= 0 && c != ',' && c != '}' && c != ']' &&
+                       c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+                    pos++;
+                }
+            }
+        } while (profundidad > 0);
+        return true;
+    }
+
+    // Recorre un arreglo de objetos: por cada campo llama campo(clave) y, si
+    // devuelve false, salta el valor. Al cerrar cada objeto llama fin_objeto().
+    template<typename Campo, typename FinObjeto>
+    bool recorrer_objetos(Campo&& campo, FinObjeto&& fin_objeto) {
+        if (!esperar('[')) return false;
+        saltar_espacios();
+        if (ver() == ']') {
+            pos++;
+            return true;
+        }
+        string clave;
+        while (true) {
+            if (!esperar('{')) return false;
+            saltar_espacios();
+            if (ver() == '}') {
+                pos++;
+            } else {
+                while (true) {
+                    if (!leer_cadena(clave) || !esperar(':')) return false;
+                    if (!campo(clave) && !saltar_valor()) return false;
+                    if (error) return false;
+                    saltar_espacios();
+                    int c = tomar();
+                    if (c == '}') break;
+                    if (c != ',') return !(error = true);
+                }
+            }
+            fin_objeto();
+            saltar_espacios();
+            int c = tomar();
+            if (c == ']') return true;
+            if (c != ',') return !(error = true);
+        }
+    }
+};
+
+// Lo que sale de la lectura, en el orden del archivo
+struct DatosLeidos {
+    vector<int64_t> ids;
+    vector<double> lat, lon;
+    vector<int64_t> desde, hasta;
+};
+
+bool leer_json(const string& nombre, size_t tam_bloque, DatosLeidos& datos, int64_t& bytes) {
+    FILE* archivo = fopen(nombre.c_str(), "rb");
+    if (!archivo) {
+        cerr << "No se pudo abrir: " << nombre << endl;
+        return false;
+    }
+    LectorJson lector(archivo, tam_bloque);
+    char token[64];
+    bool ok = lector.esperar('{');
+    string clave;
+    while (ok) {
+        lector.saltar_espacios();
+        if (lector.ver() == '}') break;
+        if (!lector.leer_cadena(clave) || !lector.esperar(':')) break;
+
+        if (clave == "nodes") {
+            int64_t id = 0;
+            double lat = 0, lon = 0;
+            int campos = 0;
+            ok = lector.recorrer_objetos(
+                [&](const string& k) {
+                    if (k != "id" && k != "lat" && k != "lon") return false;
+                    if (!lector.leer_escalar(token, sizeof(token))) return true;
+                    if (k == "id") {
+                        id = strtoll(token, nullptr, 10);
+                        campos |= 1;
+                    } else if (k == "lat") {
+                        lat = strtod(token, nullptr);
+                        campos |= 2;
+                    } else {
+                        lon = strtod(token, nullptr);
+                        campos |= 4;
+                    }
+                    return true;
+                },
+                [&]() {
+                    if (campos == 7) {
+                        datos.ids.push_back(id);
+                        datos.lat.push_back(lat);
+                        datos.lon.push_back(lon);
+                    }
+                    campos = 0;
+                });
+        } else if (clave == "edges") {
+            int64_t desde = 0, hasta = 0;
+            int campos = 0;
+            ok = lector.recorrer_objetos(
+                [&](const string& k) {
+                    if (k != "from" && k != "to") return false;
+                    if (!lector.leer_escalar(token, sizeof(token))) return true;
+                    if (k == "from") {
+                        desde = strtoll(token, nullptr, 10);
+                        campos |= 1;
+                    } else {
+                        hasta = strtoll(token, nullptr, 10);
+                        campos |= 2;
+                    }
+                    return true;
+                },
+                [&]() {
+                    if (campos == 3) {
+                        datos.desde.push_back(desde);
+                        datos.hasta.push_back(hasta);
+                    }
+                    campos = 0;
+                });
+        } else {
+            ok = lector.saltar_valor();
+        }
+        if (!ok) break;
+        lector.saltar_espacios();
+        int c = lector.tomar();
+        if (c == '}') break;
+        if (c != ',') ok = false;
+    }
+    ok = ok && !lector.error;
+    bytes = lector.bytes;
+    fclose(archivo);
+    if (!ok) cerr << "JSON invalido cerca del byte " << lector.bytes << ": " << nombre << endl;
+    return ok;
+}
+
+double haversine(double lat1, double lon1, double lat2, double lon2) {
+    double dlat = (lat2 - lat1) * RAD, dlon = (lon2 - lon1) * RAD;
+    double a = sin(dlat / 2) * sin(dlat / 2) + cos(lat1 * RAD) * cos(lat2 * RAD) * sin(dlon / 2) * sin(dlon / 2);
+    return 2.0 * RADIO_TIERRA_M * asin(min(1.0, sqrt(a)));
+}
+
+template<typename T>
+size_t bytes_de(const vector<T>& v) {
+    return v.capacity() * sizeof(T);
+}
+
+template<typename T>
+void soltar(vector<T>& v) {
+    vector<T>().swap(v);
+}
+
+struct CSRImportado {
+    vector<IndiceArista> offset;
+    vector<int> vecinos;
+    vector<float> pesos, x, y;
+};
+
+bool importar_csr(const string& archivo, const OpcionesImportacion& opciones, CSRImportado& csr,
+                  ResumenImportacion& resumen) {
+#ifdef _OPENMP
+    const int hilos = opciones.hilos > 0 ? opciones.hilos : omp_get_max_threads();
+#else
+    const int hilos = 1;
+#endif
+    auto inicio = high_resolution_clock::now();
+    DatosLeidos datos;
+    if (!leer_json(archivo, opciones.tam_bloque, datos, resumen.bytes_leidos)) return false;
+    auto fin_lectura = high_resolution_clock::now();
+    resumen.lectura_ms = duration_cast<microseconds>(fin_lectura - inicio).count() / 1000.0;
+
+    const int64_t leidos = datos.ids.size();
+    const int64_t aristas_leidas = datos.desde.size();
+    resumen.nodos_leidos = leidos;
+    resumen.aristas_leidas = aristas_leidas;
+    if (leidos >= INT_MAX) {
+        cerr << "Demasiados nodos para indices de 32 bits: " << leidos << endl;
+        return false;
+    }
+    const int n_leidos = leidos;
+    size_t memoria = bytes_de(datos.ids) + bytes_de(datos.lat) + bytes_de(datos.lon) +
+                     bytes_de(datos.desde) + bytes_de(datos.hasta);
+    resumen.memoria_pico = memoria;
+
+    // 1. Id -> posicion en el archivo. Los extractos de OSM suelen venir
+    //    ordenados por id; si no, se ordena una permutacion. Con ids repetidos
+    //    vale el primero.
+    vector<int> orden(n_leidos);
+    iota(orden.begin(), orden.end(), 0);
+    if (!is_sorted(datos.ids.begin(), datos.ids.end())) {
+        stable_sort(orden.begin(), orden.end(), [&](int a, int b) { return datos.ids[a] < datos.ids[b]; });
+    }
+    auto buscar = [&](int64_t id) {
+        int bajo = 0, alto = n_leidos;
+        while (bajo < alto) {
+            int medio = bajo + (alto - bajo) / 2;
+            if (datos.ids[orden[medio]] < id) bajo = medio + 1;
+            else alto = medio;
+        }
+        return bajo < n_leidos && datos.ids[orden[bajo]] == id ? orden[bajo] : -1;
+    };
+
+    // 2. Extremos como posiciones (-1 = no esta) y grado de cada nodo
+    vector<int> u(aristas_leidas), v(aristas_leidas);
+    vector<int> grado(n_leidos, 0);
+    int64_t sin_nodo = 0;
+    #pragma omp parallel for num_threads(hilos) schedule(static) reduction(+ : sin_nodo)
+    for (int64_t e = 0; e < aristas_leidas; ++e) {
+        u[e] = buscar(datos.desde[e]);
+        v[e] = buscar(datos.hasta[e]);
+        if (u[e] < 0 || v[e] < 0) sin_nodo++;
+        // Como convertir.py: cuenta la arista aunque el otro extremo no exista
+        if (u[e] >= 0) {
+            #pragma omp atomic
+            grado[u[e]]++;
+        }
+        if (v[e] >= 0) {
+            #pragma omp atomic
+            grado[v[e]]++;
+        }
+    }
+    resumen.aristas_sin_nodo = sin_nodo;
+    memoria += bytes_de(orden) + bytes_de(u) + bytes_de(v) + bytes_de(grado);
+    resumen.memoria_pico = max(resumen.memoria_pico, memoria);
+    soltar(datos.desde);
+    soltar(datos.hasta);
+
+    // 3. Filtro por grado y numeracion compacta en el orden del archivo. Un id
+    //    repetido no tiene grado (las aristas van al primero), salvo con grado_minimo 0.
+    vector<int>& nuevo = grado;          // Se reutiliza: indice compacto o -1
+    #pragma omp parallel for num_threads(hilos) schedule(static)
+    for (int i = 0; i < n_leidos; ++i) {
+        nuevo[i] = grado[i] >= opciones.grado_minimo && buscar(datos.ids[i]) == i;
+    }
+    soltar(orden);
+    int n = 0;
+    for (int i = 0; i < n_leidos; ++i) {
+        nuevo[i] = nuevo[i] ? n++ : -1;
+    }
+    if (n == 0) {
+        cerr << "Ningun nodo tiene grado " << opciones.grado_minimo << " o mas: " << archivo << endl;
+        return false;
+    }
+
+    // 4. Grado de salida en el grafo (cada arista en los dos sentidos)
+    csr.offset.assign((size_t)n + 1, 0);
+    int64_t conservadas = 0;
+    #pragma omp parallel for num_threads(hilos) schedule(static) reduction(+ : conservadas)
+    for (int64_t e = 0; e < aristas_leidas; ++e) {
+        if (u[e] < 0 || v[e] < 0 || nuevo[u[e]] < 0 || nuevo[v[e]] < 0) {
+            u[e] = -1;
+            continue;
+        }
+        u[e] = nuevo[u[e]];
+        v[e] = nuevo[v[e]];
+        conservadas++;
+        #pragma omp atomic
+        csr.offset[u[e] + 1]++;
+        #pragma omp atomic
+        csr.offset[v[e] + 1]++;
+    }
+    if (2 * conservadas > numeric_limits<IndiceArista>::max()) {
+        cerr << "Demasiadas aristas para IndiceArista (compilado con GRAFO_OFFSETS_32): " << 2 * conservadas << endl;
+        return false;
+    }
+    for (int i = 0; i < n; ++i) {
+        csr.offset[i + 1] += csr.offset[i];
+    }
+    const IndiceArista m = csr.offset[n];
+
+    // Coordenadas de los nodos que quedan
+    vector<double> lat(n), lon(n);
+    for (int i = 0; i < n_leidos; ++i) {
+        if (nuevo[i] >= 0) {
+            lat[nuevo[i]] = datos.lat[i];
+            lon[nuevo[i]] = datos.lon[i];
+        }
+    }
+    soltar(datos.ids);
+    soltar(datos.lat);
+    soltar(datos.lon);
+    soltar(grado);
+
+    // 5. Llenado en paralelo con cursores atomicos y haversine por arista
+    csr.vecinos.resize(m);
+    csr.pesos.resize(m);
+    vector<IndiceArista> cursor(csr.offset.begin(), csr.offset.end() - 1);
+    memoria = bytes_de(u) + bytes_de(v) + bytes_de(lat) + bytes_de(lon) + bytes_de(cursor) +
+              bytes_de(csr.offset) + bytes_de(csr.vecinos) + bytes_de(csr.pesos);
+    resumen.memoria_pico = max(resumen.memoria_pico, memoria);
+    #pragma omp parallel for num_threads(hilos) schedule(static)
+    for (int64_t e = 0; e < aristas_leidas; ++e) {
+        const int a = u[e], b = v[e];
+        if (a < 0) continue;
+        const float peso = haversine(lat[a], lon[a], lat[b], lon[b]);
+        IndiceArista i, j;
+        #pragma omp atomic capture
+        i = cursor[a]++;
+        #pragma omp atomic capture
+        j = cursor[b]++;
+        csr.vecinos[i] = b;
+        csr.pesos[i] = peso;
+        csr.vecinos[j] = a;
+        csr.pesos[j] = peso;
+    }
+    soltar(u);
+    soltar(v);
+    soltar(cursor);
+
+    // 6. Vecinos ordenados (el llenado en paralelo no tiene orden fijo)
+    #pragma omp parallel num_threads(hilos)
+    {
+        vector<pair<int, float>> lista;
+        #pragma omp for schedule(dynamic, 4096)
+        for (int w = 0; w < n; ++w) {
+            const IndiceArista desde = csr.offset[w], hasta = csr.offset[w + 1];
+            lista.clear();
+            for (IndiceArista i = desde; i < hasta; ++i) lista.push_back({ csr.vecinos[i], csr.pesos[i] });
+            sort(lista.begin(), lista.end());
+            for (IndiceArista i = desde; i < hasta; ++i) {
+                csr.vecinos[i] = lista[i - desde].first;
+                csr.pesos[i] = lista[i - desde].second;
+            }
+        }
+    }
+
+    // 7. Proyeccion equirectangular en metros alrededor del centro
+    double lat_min = 90, lat_max = -90, lon_min = 180;
+    for (int i = 0; i < n; ++i) {
+        lat_min = min(lat_min, lat[i]);
+        lat_max = max(lat_max, lat[i]);
+        lon_min = min(lon_min, lon[i]);
+    }
+    const double escala_x = RADIO_TIERRA_M * RAD * cos((lat_min + lat_max) / 2 * RAD);
+    csr.x.resize(n);
+    csr.y.resize(n);
+    #pragma omp parallel for num_threads(hilos) schedule(static)
+    for (int i = 0; i < n; ++i) {
+        csr.x[i] = (lon[i] - lon_min) * escala_x;
+        csr.y[i] = (lat_max - lat[i]) * RADIO_TIERRA_M * RAD;
+    }
+
+    resumen.nodos = n;
+    resumen.aristas = m;
+    resumen.construccion_ms = duration_cast<microseconds>(high_resolution_clock::now() - fin_lectura).count() / 1000.0;
+    return true;
+}
+
+void mostrar_resumen(const ResumenImportacion& r) {
+    cout << "Leidos: " << r.nodos_leidos << " nodos y " << r.aristas_leidas << " aristas ("
+         << r.bytes_leidos / 1024.0 / 1024.0 << " MB) en " << r.lectura_ms << " ms" << endl;
+    if (r.aristas_sin_nodo > 0) {
+        cout << "Aristas con un extremo desconocido (descartadas): " << r.aristas_sin_nodo << endl;
+    }
+    cout << "Grafo: " << r.nodos << " nodos, " << r.aristas << " aristas dirigidas; CSR en "
+         << r.construccion_ms << " ms" << endl;
+    cout << "Memoria de trabajo del importador: " << r.memoria_pico / 1024.0 / 1024.0 << " MB" << endl;
+}
+
+} // namespace
+
+unique_ptr<GrafoGrande> importar_grafo_json(const string& archivo, const OpcionesImportacion& opciones,
+                                            ResumenImportacion* resumen) {
+    cout << "=== IMPORTANDO GRAFO DESDE JSON ===" << endl;
+    ResumenImportacion propio;
+    ResumenImportacion& r = resumen ? *resumen : propio;
+    r = ResumenImportacion();
+    CSRImportado csr;
+    if (!importar_csr(archivo, opciones, csr, r)) {
+        return nullptr;
+    }
+    mostrar_resumen(r);
+    auto grafo = make_unique<GrafoGrande>();
+    grafo->adoptar_csr(move(csr.offset), move(csr.vecinos), move(csr.pesos), move(csr.x), move(csr.y));
+    return grafo;
+}
+
+bool importar_json_a_snapshot(const string& archivo_json, const string& archivo_snapshot,
+                              const OpcionesImportacion& opciones, ResumenImportacion* resumen) {
+    cout << "=== IMPORTANDO JSON A SNAPSHOT ===" << endl;
+    ResumenImportacion propio;
+    ResumenImportacion& r = resumen ? *resumen : propio;
+    r = ResumenImportacion();
+    CSRImportado csr;
+    if (!importar_csr(archivo_json, opciones, csr, r)) {
+        return false;
+    }
+    mostrar_resumen(r);
+    if (!guardar_snapshot_csr(archivo_snapshot, csr.offset.data(), csr.vecinos.data(), csr.pesos.data(),
+                              csr.x.data(), csr.y.data(), r.nodos, r.aristas)) {
+        return false;
+    }
+    cout << "Snapshot guardado en: " << archivo_snapshot << endl;
+    return true;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "grafo_grande.h"
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+// Importador del JSON de calles que usa convertir.py ({"nodes": [{"id", "lat",
+// "lon", ...}], "edges": [{"from", "to", ...}]}) para regiones que no entran
+// en memoria como arbol JSON.
+//
+// Lee el archivo por bloques en una sola pasada, al estilo SAX: de cada nodo
+// guarda id, lat y lon, de cada arista sus dos ids, y salta cualquier otro
+// campo sin armarlo. Despues aplica lo mismo que convertir.py:
+//  - descarta los nodos con grado menor a grado_minimo (2: quedan fuera las
+//    puntas sueltas) y las aristas que tocan un nodo descartado,
+//  - numera los nodos que quedan en el orden del archivo,
+//  - cada arista vale en los dos sentidos y los vecinos quedan ordenados.
+// El peso es la distancia haversine en metros y las posiciones son una
+// proyeccion equirectangular en metros (norte arriba), asi la euclidiana
+// queda cerca del peso. El CSR se arma en paralelo (OpenMP).
+//
+// Memoria: unos 24 bytes por nodo y 16 por arista leidos mas el CSR final, en
+// lugar del arbol completo del JSON.
+
+struct OpcionesImportacion {
+    int grado_minimo = 2;                // Como convertir.py
+    int hilos = 0;                       // 0 = todos los disponibles
+    size_t tam_bloque = 1 << 20;         // Bytes que se leen por vez
+};
+
+struct ResumenImportacion {
+    int64_t bytes_leidos = 0;
+    int64_t nodos_leidos = 0;
+    int64_t aristas_leidas = 0;
+    int64_t aristas_sin_nodo = 0;        // Con un extremo que no aparece en "nodes"
+    int64_t nodos = 0;                   // En el grafo
+    int64_t aristas = 0;                 // Dirigidas, en el grafo
+    double lectura_ms = 0.0;
+    double construccion_ms = 0.0;
+    size_t memoria_pico = 0;             // Bytes de trabajo del importador
+};
+
+// nullptr si el archivo no se puede leer, no tiene el formato esperado o el
+// grafo no entra en IndiceArista (solo con GRAFO_OFFSETS_32)
+std::unique_ptr<GrafoGrande> importar_grafo_json(const std::string& archivo,
+                                                 const OpcionesImportacion& opciones = OpcionesImportacion(),
+                                                 ResumenImportacion* resumen = nullptr);
+
+// Igual, pero escribe el snapshot binario (ver grafo_grande.cpp) sin armar el grafo
+bool importar_json_a_snapshot(const std::string& archivo_json, const std::string& archivo_snapshot,
+                              const OpcionesImportacion& opciones = OpcionesImportacion(),
+                              ResumenImportacion* resumen = nullptr);
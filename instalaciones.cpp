@@ -0,0 +1,237 @@
+#include "instalaciones.h"
+#include "estructuras_grandes.h"
+#include "arena.h"
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <new>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+using namespace std::chrono;
+
+static const float INFINITO_INSTALACIONES = numeric_limits<float>::infinity();
+
+namespace {
+
+// Etiqueta (distancia, instalacion) en 64 bits: la distancia no es negativa,
+// asi que sus bits ordenan igual que el float y el minimo entero es el minimo
+// por distancia con empate a favor del menor indice.
+inline uint64_t empaquetar(float d, int instalacion) {
+    uint32_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    return ((uint64_t)bits << 32) | (uint32_t)instalacion;
+}
+
+inline float distancia_de(uint64_t etiqueta) {
+    uint32_t bits = (uint32_t)(etiqueta >> 32);
+    float d;
+    memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+const uint64_t SIN_ETIQUETA = empaquetar(INFINITO_INSTALACIONES, -1);
+
+inline bool bajar_a(atomic<uint64_t>& etiqueta, uint64_t nueva) {
+    uint64_t actual = etiqueta.load(memory_order_relaxed);
+    while (nueva < actual) {
+        if (etiqueta.compare_exchange_weak(actual, nueva, memory_order_relaxed)) return true;
+    }
+    return false;
+}
+
+// Estado de la busqueda en consulta, uno por hilo. Con sellos de generacion
+// cada consulta empieza en O(1): la busqueda suele asentar pocos nodos y no
+// conviene limpiar arreglos del tamano del grafo.
+struct EspacioConsulta {
+    uint32_t generacion = 0;
+    vector<uint32_t> sello;              // == generacion: distancia valida en esta consulta
+    vector<float> distancia;
+    vector<bool> asentado;
+
+    void nueva_busqueda(int n) {
+        if ((int)sello.size() < n) {
+            sello.resize(n, 0);
+            distancia.resize(n);
+            asentado.resize(n);
+        }
+        if (++generacion == 0) {
+            fill(sello.begin(), sello.end(), 0);
+            generacion = 1;
+        }
+    }
+
+    float dist(int v) const { return sello[v] == generacion ? distancia[v] : INFINITO_INSTALACIONES; }
+    bool es_asentado(int v) const { return sello[v] == generacion && asentado[v]; }
+    void poner(int v, float d) {
+        if (sello[v] != generacion) {
+            sello[v] = generacion;
+            asentado[v] = false;
+        }
+        distancia[v] = d;
+    }
+};
+
+thread_local EspacioConsulta espacio_consulta;
+
+} // namespace
+
+IndiceInstalaciones::IndiceInstalaciones(const GrafoGrande& g) : grafo(&g) {}
+
+bool IndiceInstalaciones::construir(const vector<int>& nodos_instalaciones, int hilos) {
+    const int n = grafo->get_num_nodos_reales();
+    if (n == 0) return false;
+    instalacion_en.assign(n, -1);
+    for (int i = (int)nodos_instalaciones.size() - 1; i >= 0; --i) {
+        int v = nodos_instalaciones[i];
+        if (v < 0 || v >= n) return false;
+        instalacion_en[v] = i;           // Repetidas: queda la de menor indice
+    }
+    instalaciones = nodos_instalaciones;
+    grafo->vista_inversa();              // Arma el transpuesto del grafo si nadie lo pidio antes
+    etiquetar(max(1, hilos));
+    return true;
+}
+
+// Un Dijkstra multi-origen por hilo con las instalaciones i % hilos == t. Cada
+// hilo guarda su propia etiqueta por nodo y solo expande un nodo si sigue
+// siendo la mejor de todas; un nodo que otro hilo alcanzo antes no se expande.
+// Sobre el camino minimo de la instalacion ganadora nadie la supera, asi que
+// cada nodo termina con el minimo exacto.
+void IndiceInstalaciones::etiquetar(int hilos) {
+    VistaGrande vista = grafo->vista();
+    const int n = vista.num_nodos();
+    const int num_instalaciones = instalaciones.size();
+    hilos = max(1, min(hilos, num_instalaciones));
+
+    ArenaBusqueda& arena = arena_del_hilo();
+    AlcanceArena alcance(arena);
+    atomic<uint64_t>* mejor = arena.reservar<atomic<uint64_t>>(n);
+
+    #pragma omp parallel num_threads(hilos)
+    {
+#ifdef _OPENMP
+        const int t = omp_get_thread_num();
+#else
+        const int t = 0;
+#endif
+        #pragma omp for schedule(static)
+        for (int v = 0; v < n; ++v) {
+            new (&mejor[v]) atomic<uint64_t>(SIN_ETIQUETA);
+        }
+
+        ArenaBusqueda& mia = arena_del_hilo();
+        AlcanceArena alcance_hilo(mia);
+        uint64_t* propia = mia.reservar<uint64_t>(n);
+        bool* asentado = mia.reservar<bool>(n);
+        for (int v = 0; v < n; ++v) {
+            propia[v] = SIN_ETIQUETA;
+        }
+        fill_n(asentado, n, false);
+        ColaPrioridadGrande cola(capacidad_cola_grande(n), &mia);
+
+        for (int i = t; i < num_instalaciones; i += hilos) {
+            int v = instalaciones[i];
+            uint64_t etiqueta_v = empaquetar(0.0f, i);
+            if (etiqueta_v < propia[v]) {
+                propia[v] = etiqueta_v;
+                bajar_a(mejor[v], etiqueta_v);
+                cola.insertar(v, 0.0f);
+            }
+        }
+        while (!cola.vacia()) {
+            int actual = cola.extraer_min();
+            if (asentado[actual]) continue;
+            asentado[actual] = true;
+            if (mejor[actual].load(memory_order_relaxed) != propia[actual]) continue;   // Otro hilo gano el nodo
+
+            const float d = distancia_de(propia[actual]);
+            const int duena = (int)(uint32_t)propia[actual];
+            vista.para_cada_vecino(actual, [&](int vecino, float peso) {
+                if (asentado[vecino]) return;
+                uint64_t nueva = empaquetar(d + peso, duena);
+                if (nueva >= propia[vecino] || !bajar_a(mejor[vecino], nueva)) return;
+                propia[vecino] = nueva;
+                cola.insertar(vecino, d + peso);
+            });
+        }
+
+        // La barrera al final de 'single' espera a que todos terminen su Dijkstra
+        #pragma omp single
+        {
+            etiqueta.resize(n);
+            distancia.resize(n);
+        }
+        #pragma omp for schedule(static)
+        for (int v = 0; v < n; ++v) {
+            uint64_t e = mejor[v].load(memory_order_relaxed);
+            etiqueta[v] = e == SIN_ETIQUETA ? -1 : (int)(uint32_t)e;
+            distancia[v] = distancia_de(e);
+        }
+    }
+}
+
+void IndiceInstalaciones::buscar_mas_cercana(int nodo, InstalacionCercana& resultado) const {
+    resultado = InstalacionCercana();
+    const int n = grafo->get_num_nodos_reales();
+    if (nodo < 0 || nodo >= n || instalaciones.empty()) return;
+    VistaGrande vista = grafo->vista_inversa();
+
+    EspacioConsulta& espacio = espacio_consulta;
+    espacio.nueva_busqueda(n);
+    ArenaBusqueda& arena = arena_del_hilo();
+    AlcanceArena alcance(arena);
+    ColaPrioridadGrande cola(capacidad_cola_grande(n), &arena);
+
+    espacio.poner(nodo, 0.0f);
+    cola.insertar(nodo, 0.0f);
+    int asentados = 0;
+    while (!cola.vacia()) {
+        int actual = cola.extraer_min();
+        if (espacio.es_asentado(actual)) continue;
+        espacio.asentado[actual] = true;
+        asentados++;
+        const float d = espacio.distancia[actual];
+        if (instalacion_en[actual] >= 0) {
+            resultado.instalacion = instalacion_en[actual];
+            resultado.nodo = actual;
+            resultado.distancia = d;
+            break;
+        }
+        vista.para_cada_vecino(actual, [&](int vecino, float peso) {
+            float nueva = d + peso;
+            if (!espacio.es_asentado(vecino) && nueva < espacio.dist(vecino)) {
+                espacio.poner(vecino, nueva);
+                cola.insertar(vecino, nueva);
+            }
+        });
+    }
+    resultado.nodos_asentados = asentados;
+}
+
+size_t IndiceInstalaciones::memoria_usada() const {
+    return instalaciones.size() * sizeof(int) + instalacion_en.size() * sizeof(int) +
+           etiqueta.size() * sizeof(int) + distancia.size() * sizeof(float);
+}
+
+unique_ptr<IndiceInstalaciones> construir_indice_instalaciones(const GrafoGrande& grafo,
+                                                               const vector<int>& nodos_instalaciones, int hilos) {
+    cout << "=== CONSTRUYENDO INDICE DE INSTALACIONES ===" << endl;
+    auto indice = make_unique<IndiceInstalaciones>(grafo);
+    auto inicio = high_resolution_clock::now();
+    if (!indice->construir(nodos_instalaciones, hilos)) {
+        return nullptr;
+    }
+    auto fin = high_resolution_clock::now();
+    cout << "Instalaciones: " << nodos_instalaciones.size() << ", etiquetas en "
+         << duration_cast<milliseconds>(fin - inicio).count() << " ms con " << max(1, hilos) << " hilos" << endl;
+    cout << "Memoria del indice: " << (indice->memoria_usada() / 1024.0 / 1024.0) << " MB (transpuesto del grafo: "
+         << (grafo.memoria_transpuesto() / 1024.0 / 1024.0) << " MB)" << endl;
+    return indice;
+}
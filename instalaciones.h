@@ -0,0 +1,69 @@
+#pragma once
+#include "grafo_grande.h"
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+// Instalacion mas cercana (ej. la base de ambulancias mas cercana a un incidente).
+// La distancia es la de viaje desde la instalacion hasta el nodo.
+//
+// Dos modos sobre el mismo indice:
+//  - Etiquetas de Voronoi precalculadas: un Dijkstra multi-origen que arranca
+//    con todas las instalaciones a distancia 0 deja en cada nodo su instalacion
+//    mas cercana. Las instalaciones se reparten entre hilos; cada hilo corre su
+//    Dijkstra multi-origen y todos comparten la etiqueta (distancia, instalacion)
+//    de cada nodo con un minimo atomico, asi un hilo deja de expandir donde otro
+//    ya llego antes. El resultado es el mismo con cualquier cantidad de hilos
+//    (empates: gana la instalacion de menor indice). La consulta es O(1).
+//  - En consulta: un Dijkstra desde el nodo sobre el transpuesto del grafo
+//    (GrafoGrande::vista_inversa) que se detiene en la primera instalacion asentada. Sirve sin precalculo cuando el
+//    grafo o las instalaciones cambian seguido.
+
+struct InstalacionCercana {
+    int instalacion = -1;                // Indice en la lista de instalaciones (-1 = ninguna alcanzable)
+    int nodo = -1;                       // Nodo de la instalacion
+    float distancia = 0.0f;
+    int nodos_asentados = 0;             // Solo en el modo de consulta
+};
+
+// Como el overlay, apunta al grafo sobre el que se construyo y no ve cambios
+// de pesos posteriores.
+class IndiceInstalaciones {
+private:
+    const GrafoGrande* grafo;
+    std::vector<int> instalaciones;      // Nodo de cada instalacion
+    std::vector<int> instalacion_en;     // Por nodo: indice de la instalacion que esta ahi (-1 = ninguna)
+
+    // Etiquetas de Voronoi: 8 bytes por nodo
+    std::vector<int> etiqueta;           // Indice de la instalacion mas cercana (-1 = inalcanzable)
+    std::vector<float> distancia;
+
+    void etiquetar(int hilos);
+
+public:
+    explicit IndiceInstalaciones(const GrafoGrande& g);
+
+    // false si el grafo esta vacio o alguna instalacion no es un nodo valido
+    bool construir(const std::vector<int>& nodos_instalaciones, int hilos);
+
+    int num_instalaciones() const { return instalaciones.size(); }
+    int nodo_instalacion(int i) const { return instalaciones[i]; }
+
+    InstalacionCercana mas_cercana(int nodo) const {
+        InstalacionCercana r;
+        if (nodo < 0 || nodo >= (int)etiqueta.size() || etiqueta[nodo] < 0) return r;
+        r.instalacion = etiqueta[nodo];
+        r.nodo = instalaciones[r.instalacion];
+        r.distancia = distancia[nodo];
+        return r;
+    }
+
+    void buscar_mas_cercana(int nodo, InstalacionCercana& resultado) const;
+
+    size_t memoria_usada() const;
+};
+
+// nullptr si la construccion falla. El grafo debe vivir al menos lo mismo que el indice.
+std::unique_ptr<IndiceInstalaciones> construir_indice_instalaciones(const GrafoGrande& grafo,
+                                                                    const std::vector<int>& nodos_instalaciones,
+                                                                    int hilos);
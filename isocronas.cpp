@@ -0,0 +1,460 @@
+#include "isocronas.h"
+#include "estructuras_grandes.h"
+#include "arena.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <new>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+
+static const float INFINITO_ISOCRONA = numeric_limits<float>::infinity();
+
+namespace {
+
+// Arreglos de trabajo de un hilo con sellos de generacion: se ponen en cero al
+// crearlos y despues cada isocrona empieza en O(1) (cobertura con muchos origenes)
+class EspacioIsocrona {
+private:
+    int n;
+    uint32_t generacion = 0;
+    uint32_t* sello;                     // == generacion: distancia valida en esta isocrona
+    bool* asentado;
+
+public:
+    float* distancia;
+
+    EspacioIsocrona(ArenaBusqueda& arena, int num_nodos)
+        : n(num_nodos),
+          sello(arena.reservar<uint32_t>(num_nodos)),
+          asentado(arena.reservar<bool>(num_nodos)),
+          distancia(arena.reservar<float>(num_nodos)) {
+        memset(sello, 0, n * sizeof(uint32_t));
+    }
+
+    EspacioIsocrona(const EspacioIsocrona&) = delete;
+    EspacioIsocrona& operator=(const EspacioIsocrona&) = delete;
+
+    void nueva_busqueda() {
+        if (++generacion == 0) {
+            memset(sello, 0, n * sizeof(uint32_t));
+            generacion = 1;
+        }
+    }
+
+    bool tocado(int v) const { return sello[v] == generacion; }
+    void tocar(int v) { sello[v] = generacion; asentado[v] = false; }
+    bool es_asentado(int v) const { return tocado(v) && asentado[v]; }
+    void asentar(int v) { asentado[v] = true; }
+};
+
+vector<float> ordenar_presupuestos(const vector<float>& presupuestos) {
+    vector<float> ordenados;
+    for (float p : presupuestos) {
+        if (p >= 0.0f) ordenados.push_back(p);
+    }
+    sort(ordenados.begin(), ordenados.end());
+    ordenados.erase(unique(ordenados.begin(), ordenados.end()), ordenados.end());
+    return ordenados;
+}
+
+// Dijkstra que no encola nada mas alla del presupuesto. false si se corto al
+// llegar a 'max_asentados' (0 = sin tope) sin agotar el presupuesto.
+bool isocrona_secuencial(const VistaGrande& vista, int origen, float presupuesto, int max_asentados,
+                         EspacioIsocrona& espacio, ColaPrioridadGrande& cola, ResultadoIsocrona& resultado) {
+    espacio.nueva_busqueda();
+    resultado.nodos.clear();
+    resultado.distancia.clear();
+    float* distancia = espacio.distancia;
+
+    espacio.tocar(origen);
+    distancia[origen] = 0.0f;
+    cola.limpiar();
+    cola.insertar(origen, 0.0f);
+    while (!cola.vacia()) {
+        int actual = cola.extraer_min();
+        if (espacio.es_asentado(actual)) continue;
+        if (max_asentados > 0 && (int)resultado.nodos.size() >= max_asentados) return false;
+        espacio.asentar(actual);
+        const float d = distancia[actual];
+        resultado.nodos.push_back(actual);
+        resultado.distancia.push_back(d);
+
+        vista.para_cada_vecino(actual, [&](int vecino, float peso) {
+            float nueva = d + peso;
+            if (nueva > presupuesto) return;
+            if (!espacio.tocado(vecino)) {
+                espacio.tocar(vecino);
+            } else if (espacio.es_asentado(vecino) || nueva >= distancia[vecino]) {
+                return;
+            }
+            distancia[vecino] = nueva;
+            cola.insertar(vecino, nueva);
+        });
+    }
+    return true;
+}
+
+// Ancho de cubeta: dos veces el peso medio de una muestra de aristas
+float ancho_cubeta(const VistaGrande& vista, float delta) {
+    if (delta > 0.0f) return delta;
+    const int n = vista.num_nodos();
+    const int paso = max(1, n / 4096);
+    double suma = 0.0;
+    long cuenta = 0;
+    for (int v = 0; v < n; v += paso) {
+        vista.para_cada_vecino(v, [&](int, float peso) {
+            suma += peso;
+            cuenta++;
+        });
+    }
+    return suma > 0.0 ? (float)(2.0 * suma / cuenta) : 1.0f;
+}
+
+// Delta-stepping: las cubetas se procesan en orden y dentro de cada una se
+// relajan todos los nodos de la frontera en paralelo, con un minimo atomico
+// por vecino. Los nodos que mejoran dentro de la misma cubeta forman la
+// frontera de la siguiente ronda; al vaciarse, esas distancias son finales.
+void isocrona_paralela(const VistaGrande& vista, int origen, float presupuesto, float delta, int hilos,
+                       ArenaBusqueda& arena, ResultadoIsocrona& resultado) {
+    const int n = vista.num_nodos();
+    atomic<float>* distancia = arena.reservar<atomic<float>>(n);
+    uint32_t* ronda_de = arena.reservar<uint32_t>(n);      // Ultima ronda en que entro a la frontera
+
+    #pragma omp parallel for num_threads(hilos) schedule(static)
+    for (int i = 0; i < n; ++i) {
+        new (&distancia[i]) atomic<float>(INFINITO_ISOCRONA);
+        ronda_de[i] = 0;
+    }
+
+    const int num_cubetas = (int)(presupuesto / delta) + 1;
+    vector<vector<vector<int>>> cubetas(hilos, vector<vector<int>>(num_cubetas));
+    vector<int> frontera;
+    uint32_t ronda = 0;
+
+    distancia[origen].store(0.0f, memory_order_relaxed);
+    cubetas[0][0].push_back(origen);
+    for (int c = 0; c < num_cubetas; ++c) {
+        while (true) {
+            // Frontera sin repetidos con lo que cada hilo dejo en la cubeta c
+            ronda++;
+            frontera.clear();
+            for (int t = 0; t < hilos; ++t) {
+                for (int v : cubetas[t][c]) {
+                    if (ronda_de[v] != ronda) {
+                        ronda_de[v] = ronda;
+                        frontera.push_back(v);
+                    }
+                }
+                cubetas[t][c].clear();
+            }
+            if (frontera.empty()) break;
+
+            #pragma omp parallel num_threads(hilos)
+            {
+#ifdef _OPENMP
+                vector<vector<int>>& mias = cubetas[omp_get_thread_num()];
+#else
+                vector<vector<int>>& mias = cubetas[0];
+#endif
+                #pragma omp for schedule(dynamic, 256)
+                for (int k = 0; k < (int)frontera.size(); ++k) {
+                    const int v = frontera[k];
+                    const float d = distancia[v].load(memory_order_relaxed);
+                    if ((int)(d / delta) != c) continue;   // Entrada vieja: ya se relajo en su cubeta
+                    vista.para_cada_vecino(v, [&](int vecino, float peso) {
+                        float nueva = d + peso;
+                        if (nueva > presupuesto) return;
+                        float actual = distancia[vecino].load(memory_order_relaxed);
+                        while (nueva < actual) {
+                            if (distancia[vecino].compare_exchange_weak(actual, nueva, memory_order_relaxed)) {
+                                mias[min(num_cubetas - 1, (int)(nueva / delta))].push_back(vecino);
+                                break;
+                            }
+                        }
+                    });
+                }
+            }
+        }
+    }
+
+    // Alcanzados ordenados por distancia, como los deja el motor secuencial
+    vector<pair<float, int>> alcanzados;
+    for (int v = 0; v < n; ++v) {
+        float d = distancia[v].load(memory_order_relaxed);
+        if (d <= presupuesto) alcanzados.push_back({ d, v });
+    }
+    sort(alcanzados.begin(), alcanzados.end());
+    resultado.nodos.clear();
+    resultado.distancia.clear();
+    for (const auto& a : alcanzados) {
+        resultado.nodos.push_back(a.second);
+        resultado.distancia.push_back(a.first);
+    }
+}
+
+// Lado de celda con ~4 nodos por celda si los nodos llenaran su rectangulo
+float tam_celda_automatico(const GrafoGrande& grafo, const int* nodos, int cantidad) {
+    if (cantidad <= 0) return 1.0f;
+    float min_x = INFINITO_ISOCRONA, max_x = -INFINITO_ISOCRONA;
+    float min_y = INFINITO_ISOCRONA, max_y = -INFINITO_ISOCRONA;
+    for (int i = 0; i < cantidad; ++i) {
+        min_x = min(min_x, grafo.get_pos_x(nodos[i]));
+        max_x = max(max_x, grafo.get_pos_x(nodos[i]));
+        min_y = min(min_y, grafo.get_pos_y(nodos[i]));
+        max_y = max(max_y, grafo.get_pos_y(nodos[i]));
+    }
+    double area = (double)(max_x - min_x) * (max_y - min_y);
+    return area > 0.0 ? (float)(2.0 * sqrt(area / cantidad)) : 1.0f;
+}
+
+void armar_anillos(const GrafoGrande& grafo, const vector<float>& presupuestos, const OpcionesIsocrona& opciones,
+                   ResultadoIsocrona& resultado) {
+    for (float presupuesto : presupuestos) {
+        AnilloIsocrona anillo;
+        anillo.presupuesto = presupuesto;
+        anillo.num_nodos = upper_bound(resultado.distancia.begin(), resultado.distancia.end(), presupuesto)
+                         - resultado.distancia.begin();
+        if (opciones.contornos) {
+            // Cada anillo con la separacion de sus propios nodos: con el lado
+            // del mayor, los anillos chicos quedan en celdas sueltas
+            float tam_celda = opciones.tam_celda > 0.0f
+                            ? opciones.tam_celda
+                            : tam_celda_automatico(grafo, resultado.nodos.data(), anillo.num_nodos);
+            contorno_de_nodos(grafo, resultado.nodos.data(), anillo.num_nodos, tam_celda, anillo.contorno);
+        }
+        resultado.anillos.push_back(move(anillo));
+    }
+}
+
+// Cierre morfologico de la rejilla (dilatar y erosionar con un vecindario de
+// 3 x 3): une celdas separadas por un hueco de una celda. Cada pasada va por
+// filas y despues por columnas; fuera de la rejilla cuenta como vacio.
+void cerrar_rejilla(vector<char>& ocupada, int ancho, int alto) {
+    vector<char> temporal(ocupada.size());
+    auto pasada = [&](bool dilatar) {
+        const char buscado = dilatar ? 1 : 0;
+        auto indice = [&](int x, int y) { return (size_t)y * ancho + x; };
+        for (int y = 0; y < alto; ++y) {
+            for (int x = 0; x < ancho; ++x) {
+                bool hay = (x > 0 && ocupada[indice(x - 1, y)] == buscado) || ocupada[indice(x, y)] == buscado ||
+                           (x + 1 < ancho && ocupada[indice(x + 1, y)] == buscado);
+                if (!dilatar && (x == 0 || x + 1 == ancho)) hay = true;
+                temporal[indice(x, y)] = hay ? buscado : !buscado;
+            }
+        }
+        for (int y = 0; y < alto; ++y) {
+            for (int x = 0; x < ancho; ++x) {
+                bool hay = (y > 0 && temporal[indice(x, y - 1)] == buscado) || temporal[indice(x, y)] == buscado ||
+                           (y + 1 < alto && temporal[indice(x, y + 1)] == buscado);
+                if (!dilatar && (y == 0 || y + 1 == alto)) hay = true;
+                ocupada[indice(x, y)] = hay ? buscado : !buscado;
+            }
+        }
+    };
+    pasada(true);
+    pasada(false);
+}
+
+// Llena los huecos: las celdas vacias que no se alcanzan desde el borde de la
+// rejilla (por lados) pasan a ocupadas, asi solo quedan bordes exteriores
+void rellenar_huecos(vector<char>& ocupada, int ancho, int alto) {
+    vector<char> exterior(ocupada.size(), 0);
+    vector<int> pila;
+    auto visitar = [&](int x, int y) {
+        size_t k = (size_t)y * ancho + x;
+        if (ocupada[k] || exterior[k]) return;
+        exterior[k] = 1;
+        pila.push_back((int)k);
+    };
+    for (int x = 0; x < ancho; ++x) {
+        visitar(x, 0);
+        visitar(x, alto - 1);
+    }
+    for (int y = 0; y < alto; ++y) {
+        visitar(0, y);
+        visitar(ancho - 1, y);
+    }
+    while (!pila.empty()) {
+        int k = pila.back();
+        pila.pop_back();
+        int x = k % ancho, y = k / ancho;
+        if (x > 0) visitar(x - 1, y);
+        if (x + 1 < ancho) visitar(x + 1, y);
+        if (y > 0) visitar(x, y - 1);
+        if (y + 1 < alto) visitar(x, y + 1);
+    }
+    for (size_t k = 0; k < ocupada.size(); ++k) {
+        if (!exterior[k]) ocupada[k] = 1;
+    }
+}
+
+} // namespace
+
+void calcular_isocrona(const GrafoGrande& grafo, int origen, const OpcionesIsocrona& opciones,
+                       ResultadoIsocrona& resultado) {
+    resultado.reiniciar();
+    VistaGrande vista = grafo.vista();
+    const int n = vista.num_nodos();
+    vector<float> presupuestos = ordenar_presupuestos(opciones.presupuestos);
+    if (origen < 0 || origen >= n || presupuestos.empty()) return;
+
+    ArenaBusqueda& arena = arena_del_hilo();
+    AlcanceArena alcance(arena);
+    const int hilos = max(1, opciones.hilos);
+    bool completa;
+    {
+        AlcanceArena alcance_secuencial(arena);
+        EspacioIsocrona espacio(arena, n);
+        ColaPrioridadGrande cola(capacidad_cola_grande(n), &arena);
+        completa = isocrona_secuencial(vista, origen, presupuestos.back(), hilos > 1 ? opciones.umbral_paralelo : 0,
+                                       espacio, cola, resultado);
+    }
+    // Presupuesto grande: lo hecho hasta el umbral se descarta y se relanza en paralelo
+    if (!completa) {
+        isocrona_paralela(vista, origen, presupuestos.back(), ancho_cubeta(vista, opciones.delta), hilos,
+                          arena, resultado);
+        resultado.paralelo = true;
+    }
+    armar_anillos(grafo, presupuestos, opciones, resultado);
+}
+
+void calcular_isocronas(const GrafoGrande& grafo, const vector<int>& origenes,
+                        const OpcionesIsocrona& opciones, vector<ResultadoIsocrona>& resultados) {
+    resultados.resize(origenes.size());
+    vector<float> presupuestos = ordenar_presupuestos(opciones.presupuestos);
+    const int n = grafo.get_num_nodos_reales();
+
+    #pragma omp parallel num_threads(max(1, opciones.hilos))
+    {
+        // Un espacio por hilo para todos sus origenes
+        VistaGrande vista = grafo.vista();
+        ArenaBusqueda& arena = arena_del_hilo();
+        AlcanceArena alcance(arena);
+        EspacioIsocrona espacio(arena, n);
+        ColaPrioridadGrande cola(capacidad_cola_grande(n), &arena);
+
+        #pragma omp for schedule(dynamic, 1)
+        for (int i = 0; i < (int)origenes.size(); ++i) {
+            ResultadoIsocrona& resultado = resultados[i];
+            resultado.reiniciar();
+            if (origenes[i] < 0 || origenes[i] >= n || presupuestos.empty()) continue;
+            isocrona_secuencial(vista, origenes[i], presupuestos.back(), 0, espacio, cola, resultado);
+            armar_anillos(grafo, presupuestos, opciones, resultado);
+        }
+    }
+}
+
+// Rasteriza los nodos, cierra la rejilla y llena los huecos; despues los
+// bordes de las celdas ocupadas, dirigidos con la celda a la izquierda, se
+// encadenan en poligonos (uno por componente). En un vertice con dos salidas (celdas que solo se
+// tocan por una esquina) se gira primero a la izquierda, asi cada poligono
+// pasa una sola vez por cada vertice. Solo se guardan las esquinas.
+void contorno_de_nodos(const GrafoGrande& grafo, const int* nodos, int cantidad, float tam_celda,
+                       ContornoIsocrona& contorno) {
+    contorno.clear();
+    if (cantidad <= 0 || tam_celda <= 0.0f) return;
+
+    float min_x = INFINITO_ISOCRONA, max_x = -INFINITO_ISOCRONA;
+    float min_y = INFINITO_ISOCRONA, max_y = -INFINITO_ISOCRONA;
+    for (int i = 0; i < cantidad; ++i) {
+        min_x = min(min_x, grafo.get_pos_x(nodos[i]));
+        max_x = max(max_x, grafo.get_pos_x(nodos[i]));
+        min_y = min(min_y, grafo.get_pos_y(nodos[i]));
+        max_y = max(max_y, grafo.get_pos_y(nodos[i]));
+    }
+    // Tope de la rejilla para celdas pedidas demasiado chicas
+    const double MAX_CELDAS = 64.0 * 1024 * 1024;
+    while ((double)((max_x - min_x) / tam_celda + 1) * ((max_y - min_y) / tam_celda + 1) > MAX_CELDAS) {
+        tam_celda *= 2.0f;
+    }
+    // Una celda de margen para la dilatacion
+    min_x -= tam_celda;
+    min_y -= tam_celda;
+    const int ancho = (int)((max_x - min_x) / tam_celda) + 2;
+    const int alto = (int)((max_y - min_y) / tam_celda) + 2;
+
+    vector<char> ocupada((size_t)ancho * alto, 0);
+    for (int i = 0; i < cantidad; ++i) {
+        int cx = min(ancho - 1, (int)((grafo.get_pos_x(nodos[i]) - min_x) / tam_celda));
+        int cy = min(alto - 1, (int)((grafo.get_pos_y(nodos[i]) - min_y) / tam_celda));
+        ocupada[(size_t)cy * ancho + cx] = 1;
+    }
+    cerrar_rejilla(ocupada, ancho, alto);
+    rellenar_huecos(ocupada, ancho, alto);
+    auto celda = [&](int cx, int cy) {
+        return cx >= 0 && cy >= 0 && cx < ancho && cy < alto && ocupada[(size_t)cy * ancho + cx];
+    };
+
+    // Direcciones: 0 = +x, 1 = +y, 2 = -x, 3 = -y. Hasta dos salidas por vertice.
+    const int ancho_v = ancho + 1;
+    vector<signed char> salida((size_t)2 * ancho_v * (alto + 1), -1);
+    auto agregar = [&](int vx, int vy, int dir) {
+        size_t k = 2 * ((size_t)vy * ancho_v + vx);
+        salida[salida[k] < 0 ? k : k + 1] = dir;
+    };
+    for (int cy = 0; cy < alto; ++cy) {
+        for (int cx = 0; cx < ancho; ++cx) {
+            if (!celda(cx, cy)) continue;
+            if (!celda(cx, cy - 1)) agregar(cx, cy, 0);
+            if (!celda(cx + 1, cy)) agregar(cx + 1, cy, 1);
+            if (!celda(cx, cy + 1)) agregar(cx + 1, cy + 1, 2);
+            if (!celda(cx - 1, cy)) agregar(cx, cy + 1, 3);
+        }
+    }
+
+    const int dx[4] = { 1, 0, -1, 0 };
+    const int dy[4] = { 0, 1, 0, -1 };
+    // Toma la salida de (vx, vy) en la direccion 'dir' si existe
+    auto tomar = [&](int vx, int vy, int dir) {
+        size_t k = 2 * ((size_t)vy * ancho_v + vx);
+        for (size_t s = k; s < k + 2; ++s) {
+            if (salida[s] == dir) {
+                salida[s] = -1;
+                return true;
+            }
+        }
+        return false;
+    };
+
+    for (int vy = 0; vy <= alto; ++vy) {
+        for (int vx = 0; vx <= ancho; ++vx) {
+            size_t k = 2 * ((size_t)vy * ancho_v + vx);
+            while (salida[k] >= 0 || salida[k + 1] >= 0) {
+                int dir = salida[k] >= 0 ? salida[k] : salida[k + 1];
+                tomar(vx, vy, dir);
+                const int primera = dir;
+                vector<PuntoContorno> poligono;
+                poligono.push_back({ min_x + vx * tam_celda, min_y + vy * tam_celda });
+                int x = vx, y = vy;
+                while (true) {
+                    x += dx[dir];
+                    y += dy[dir];
+                    if (x == vx && y == vy) break;
+                    int siguiente = -1;
+                    for (int giro : { 1, 0, 3 }) {
+                        if (tomar(x, y, (dir + giro) % 4)) {
+                            siguiente = (dir + giro) % 4;
+                            break;
+                        }
+                    }
+                    if (siguiente < 0) break;   // No pasa con bordes bien formados
+                    if (siguiente != dir) {
+                        poligono.push_back({ min_x + x * tam_celda, min_y + y * tam_celda });
+                    }
+                    dir = siguiente;
+                }
+                if (dir == primera) {
+                    poligono.erase(poligono.begin());   // El inicio quedo en medio de un lado
+                }
+                contorno.push_back(move(poligono));
+            }
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "grafo_grande.h"
+#include <vector>
+
+// Isocronas: todo lo alcanzable desde un origen con costo <= C.
+//
+// Una sola pasada acotada por el mayor presupuesto sirve para todos los
+// anillos (ej. 5/10/15 minutos): los nodos salen ordenados por distancia y
+// cada anillo es un prefijo. El motor secuencial es un Dijkstra que se detiene
+// al superar el presupuesto. Con hilos > 1 y un presupuesto grande (mas de
+// umbral_paralelo nodos asentados) se relanza con delta-stepping en paralelo
+// (OpenMP): los nodos se agrupan en cubetas de ancho delta y cada cubeta se
+// relaja entre todos los hilos con minimos atomicos.
+// El contorno de cada anillo se arma rasterizando los nodos en una rejilla,
+// cerrandola (dilatar y erosionar) y siguiendo el borde exterior de cada
+// componente de celdas ocupadas.
+
+struct PuntoContorno {
+    float x;
+    float y;
+};
+
+// Poligonos cerrados (el ultimo punto no repite el primero), en sentido
+// antihorario: uno por componente, sin huecos
+using ContornoIsocrona = std::vector<std::vector<PuntoContorno>>;
+
+struct OpcionesIsocrona {
+    std::vector<float> presupuestos;     // Costos maximos de cada anillo (en cualquier orden)
+    bool contornos = true;
+    float tam_celda = 0.0f;              // Lado de las celdas del contorno (0 = segun la densidad de nodos de cada anillo)
+    int hilos = 1;                       // > 1 habilita el motor paralelo
+    int umbral_paralelo = 200000;        // Nodos asentados a partir de los cuales conviene el paralelo
+    float delta = 0.0f;                  // Ancho de cubeta del delta-stepping (0 = segun los pesos)
+};
+
+struct AnilloIsocrona {
+    float presupuesto;
+    int num_nodos;                       // Nodos del anillo: los primeros num_nodos del resultado
+    ContornoIsocrona contorno;
+};
+
+// Lo crea quien llama y se reutiliza: los vectores solo crecen
+struct ResultadoIsocrona {
+    std::vector<int> nodos;              // Alcanzados, por distancia creciente
+    std::vector<float> distancia;        // Distancia de cada uno de 'nodos'
+    std::vector<AnilloIsocrona> anillos; // Por presupuesto creciente
+    bool paralelo = false;               // Lo resolvio el motor paralelo
+
+    void reiniciar() {
+        nodos.clear();
+        distancia.clear();
+        anillos.clear();
+        paralelo = false;
+    }
+};
+
+void calcular_isocrona(const GrafoGrande& grafo, int origen, const OpcionesIsocrona& opciones,
+                       ResultadoIsocrona& resultado);
+
+// Cobertura: una isocrona por origen, repartiendo los origenes entre
+// opciones.hilos hilos (cada isocrona es secuencial). resultados[i] es la de origenes[i].
+void calcular_isocronas(const GrafoGrande& grafo, const std::vector<int>& origenes,
+                        const OpcionesIsocrona& opciones, std::vector<ResultadoIsocrona>& resultados);
+
+// Borde exterior de las celdas de lado 'tam_celda' que contienen a algun nodo,
+// despues de cerrar la rejilla y llenar los huecos
+void contorno_de_nodos(const GrafoGrande& grafo, const int* nodos, int cantidad, float tam_celda,
+                       ContornoIsocrona& contorno);
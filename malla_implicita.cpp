@@ -0,0 +1,109 @@
+#include "malla_implicita.h"
+#include "estructuras_grandes.h"
+#include "busqueda_generica.h"
+#include "arena.h"
+#include <iostream>
+
+using namespace std;
+
+MallaImplicita::MallaImplicita(const MallaConObstaculos& malla, uint32_t semilla)
+    : ancho(malla.get_ancho()), alto(malla.get_alto()), palabras_fila((malla.get_ancho() + 63) / 64),
+      semilla(semilla) {
+    const size_t palabras = (size_t)palabras_fila * alto;
+    bits.assign(palabras, 0);
+    libres_antes.assign(palabras, 0);
+
+    // Cada fila llena sus palabras (el relleno del final queda en 0)
+    #pragma omp parallel for schedule(static)
+    for (int y = 0; y < alto; ++y) {
+        uint64_t* fila = &bits[(size_t)y * palabras_fila];
+        for (int x = 0; x < ancho; ++x) {
+            if (malla.get_cell_type(x, y) == CellType::FREE) fila[x >> 6] |= 1ull << (x & 63);
+        }
+    }
+    for (size_t p = 0; p < palabras; ++p) {
+        libres_antes[p] = libres;
+        libres += __builtin_popcountll(bits[p]);
+    }
+}
+
+bool MallaImplicita::libre(int celda) const {
+    if (celda < 0 || celda >= ancho * alto) return false;
+    return vista<Conectividad::CUATRO>().libre(celda % ancho, celda / ancho);
+}
+
+int MallaImplicita::nodo_de_celda(int celda) const {
+    if (!libre(celda)) return -1;
+    return vista<Conectividad::CUATRO>().nodo_compacto(celda % ancho, celda / ancho);
+}
+
+// Busqueda binaria de la palabra y despues el bit dentro de ella
+int MallaImplicita::celda_de_nodo(int nodo) const {
+    if (nodo < 0 || nodo >= libres) return -1;
+    size_t palabra = upper_bound(libres_antes.begin(), libres_antes.end(), nodo) - libres_antes.begin() - 1;
+    uint64_t resto = bits[palabra];
+    for (int k = nodo - libres_antes[palabra]; k > 0; --k) {
+        resto &= resto - 1;
+    }
+    int x = (int)(palabra % palabras_fila) * 64 + __builtin_ctzll(resto);
+    int y = (int)(palabra / palabras_fila);
+    return y * ancho + x;
+}
+
+size_t MallaImplicita::memoria_usada() const {
+    return bits.capacity() * sizeof(uint64_t) + libres_antes.capacity() * sizeof(int);
+}
+
+unique_ptr<MallaImplicita> generar_malla_implicita(uint32_t semilla, int ancho, int alto) {
+    MallaConObstaculos malla(ancho, alto);
+    if (!malla.generar_malla(semilla)) {
+        cerr << "Error al generar malla con obstáculos" << endl;
+        return nullptr;
+    }
+    return make_unique<MallaImplicita>(malla, semilla);
+}
+
+// Cola y espacio de la arena del hilo, como las envolturas de algoritmos_grandes.cpp
+template<Conectividad C>
+static void buscar_en_vista(const MallaImplicita& malla, bool con_heuristica,
+                            int origen, int destino, ResultadoRuta& ruta) {
+    VistaMalla<C> vista = malla.vista<C>();
+    if (!malla.libre(origen) || !malla.libre(destino)) {
+        ruta.reiniciar();
+        return;
+    }
+    ArenaBusqueda& arena = arena_del_hilo();
+    AlcanceArena alcance(arena);
+    ColaPrioridadGrande pq(capacidad_cola_grande(vista.num_nodos()), &arena);
+    EspacioBusqueda espacio(arena);
+    if (con_heuristica) {
+        buscar_a_estrella(vista, HeuristicaOctil<VistaMalla<C>>(vista, destino), pq, espacio, origen, destino, ruta);
+    } else {
+        buscar_dijkstra(vista, pq, espacio, origen, destino, ruta);
+    }
+}
+
+static void buscar_con_conectividad(const MallaImplicita& malla, Conectividad conectividad, bool con_heuristica,
+                                    int origen, int destino, ResultadoRuta& ruta) {
+    switch (conectividad) {
+        case Conectividad::CUATRO:
+            buscar_en_vista<Conectividad::CUATRO>(malla, con_heuristica, origen, destino, ruta);
+            break;
+        case Conectividad::OCHO:
+            buscar_en_vista<Conectividad::OCHO>(malla, con_heuristica, origen, destino, ruta);
+            break;
+        case Conectividad::DIAGONALES_PARCIALES:
+            buscar_en_vista<Conectividad::DIAGONALES_PARCIALES>(malla, con_heuristica, origen, destino, ruta);
+            break;
+    }
+}
+
+void buscar_Dijkstra_implicita(const MallaImplicita& malla, Conectividad conectividad,
+                               int origen, int destino, ResultadoRuta& ruta) {
+    buscar_con_conectividad(malla, conectividad, false, origen, destino, ruta);
+}
+
+void buscar_AStar_implicita(const MallaImplicita& malla, Conectividad conectividad,
+                            int origen, int destino, ResultadoRuta& ruta) {
+    buscar_con_conectividad(malla, conectividad, true, origen, destino, ruta);
+}
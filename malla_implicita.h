@@ -0,0 +1,146 @@
+#pragma once
+#include "vista_grafo.h"
+#include "malla_obstaculos.h"
+#include "aleatorio_contador.h"
+#include "resultado_ruta.h"
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+
+// Grafo implicito sobre la malla de obstaculos: las busquedas corren sobre el
+// mapa de bits de celdas libres sin armar el CSR.
+//
+// MallaImplicita guarda un bit por celda (filas rellenadas a palabras de 64
+// bits) y, por palabra, cuantas celdas libres hay antes. Con eso el id que
+// tendria la celda en el CSR de generar_grafo_con_malla_obstaculos sale de un
+// popcount, y los vecinos y pesos se calculan al expandir con las mismas
+// tablas y el mismo sorteo (peso_arista_malla). Son unos 1,5 bits por celda:
+// 0,4 MB para la malla de 1414 x 1414 frente a los cerca de 100 MB del CSR.
+//
+// VistaMalla cumple el concepto de vista_grafo.h, asi que las plantillas de
+// busqueda_generica.h y busqueda_acotada.h corren sin cambios. Los nodos de la
+// vista son indices de celda (y * ancho + x): num_nodos() cuenta tambien las
+// celdas bloqueadas, que nunca aparecen como vecino. El orden coincide con el
+// de los ids del CSR (ambos van por filas), asi que los desempates tambien.
+// La conectividad se fija al compilar:
+//  - CUATRO: solo ortogonales,
+//  - OCHO: las 8 direcciones,
+//  - DIAGONALES_PARCIALES: la regla del CSR (diagonal solo con nodo + nx + ny
+//    par); con esta el grafo es el mismo y dan los mismos costos.
+
+enum class Conectividad {
+    CUATRO,
+    OCHO,
+    DIAGONALES_PARCIALES
+};
+
+template<Conectividad C>
+struct VistaMalla {
+    static constexpr Conectividad CONECTIVIDAD = C;
+
+    const uint64_t* bits;          // 1 = celda libre
+    const int* libres_antes;       // Celdas libres en las palabras anteriores
+    int ancho, alto;
+    int palabras_fila;
+    FlujoAleatorio variacion;
+
+    int num_nodos() const { return ancho * alto; }
+    int columna(int v) const { return v % ancho; }
+    int fila(int v) const { return v / ancho; }
+    float x(int v) const { return columna(v) * CELL_SIZE; }
+    float y(int v) const { return fila(v) * CELL_SIZE; }
+
+    bool libre(int cx, int cy) const {
+        return (bits[(size_t)cy * palabras_fila + (cx >> 6)] >> (cx & 63)) & 1;
+    }
+
+    // Id de la celda libre (cx, cy) en el CSR de la malla
+    int nodo_compacto(int cx, int cy) const {
+        const size_t palabra = (size_t)cy * palabras_fila + (cx >> 6);
+        const uint64_t anteriores = bits[palabra] & ((1ull << (cx & 63)) - 1);
+        return libres_antes[palabra] + __builtin_popcountll(anteriores);
+    }
+
+    template<typename F>
+    void para_cada_vecino(int v, F&& f) const {
+        const int cx = columna(v), cy = fila(v);
+        const int nodo = nodo_compacto(cx, cy);
+        constexpr int direcciones = C == Conectividad::CUATRO ? 4 : 8;
+        for (int d = 0; d < direcciones; ++d) {
+            const int nx = cx + DX_MALLA[d];
+            const int ny = cy + DY_MALLA[d];
+            if ((unsigned)nx >= (unsigned)ancho || (unsigned)ny >= (unsigned)alto || !libre(nx, ny)) continue;
+            if (C == Conectividad::DIAGONALES_PARCIALES && d >= 4 && ((nodo ^ nx ^ ny) & 1) != 0) continue;
+            f(ny * ancho + nx, peso_arista_malla(variacion, nodo, d));
+        }
+    }
+};
+
+// Octil (Manhattan con CUATRO) en celdas, por VARIACION_MINIMA_MALLA: ningun
+// paso cuesta menos, asi que es admisible y consistente con cualquiera de las
+// tres conectividades
+template<typename Vista>
+struct HeuristicaOctil {
+    const Vista& vista;
+    int destino_x;
+    int destino_y;
+
+    HeuristicaOctil(const Vista& v, int destino)
+        : vista(v), destino_x(v.columna(destino)), destino_y(v.fila(destino)) {}
+
+    float operator()(int v) const {
+        const float dx = std::abs(vista.columna(v) - destino_x);
+        const float dy = std::abs(vista.fila(v) - destino_y);
+        if (Vista::CONECTIVIDAD == Conectividad::CUATRO) return (dx + dy) * VARIACION_MINIMA_MALLA;
+        return (std::max(dx, dy) + 0.41421356f * std::min(dx, dy)) * VARIACION_MINIMA_MALLA;
+    }
+};
+
+class MallaImplicita {
+private:
+    int ancho, alto;
+    int palabras_fila;
+    int libres = 0;
+    uint32_t semilla;
+    std::vector<uint64_t> bits;
+    std::vector<int> libres_antes;
+
+public:
+    // Empaqueta las celdas libres de la malla (en paralelo por filas); la malla
+    // puede destruirse despues. La semilla es la de sus pesos.
+    MallaImplicita(const MallaConObstaculos& malla, uint32_t semilla);
+
+    template<Conectividad C>
+    VistaMalla<C> vista() const {
+        return {bits.data(), libres_antes.data(), ancho, alto, palabras_fila,
+                FlujoAleatorio(semilla, FLUJO_PESOS_MALLA)};
+    }
+
+    int get_ancho() const { return ancho; }
+    int get_alto() const { return alto; }
+    int get_palabras_fila() const { return palabras_fila; }
+    int num_libres() const { return libres; }
+    const uint64_t* get_bits() const { return bits.data(); }
+    bool libre(int celda) const;
+
+    // Entre ids del CSR e indices de celda (-1 si la celda esta bloqueada)
+    int nodo_de_celda(int celda) const;
+    int celda_de_nodo(int nodo) const;
+
+    size_t memoria_usada() const;
+};
+
+// Genera la malla con la semilla y la empaqueta: el mismo grafo que
+// generar_grafo_con_malla_obstaculos(semilla, ancho, alto). nullptr si falla.
+std::unique_ptr<MallaImplicita> generar_malla_implicita(uint32_t semilla, int ancho = GRID_WIDTH,
+                                                        int alto = GRID_HEIGHT);
+
+// Busquedas con las colas grandes y la arena del hilo. origen y destino son
+// indices de celda; una celda bloqueada no tiene ruta.
+void buscar_Dijkstra_implicita(const MallaImplicita& malla, Conectividad conectividad,
+                               int origen, int destino, ResultadoRuta& ruta);
+void buscar_AStar_implicita(const MallaImplicita& malla, Conectividad conectividad,
+                            int origen, int destino, ResultadoRuta& ruta);
@@ -1,33 +1,52 @@
 #include "malla_obstaculos.h"
 #include "grafo_grande.h"
+#include "aleatorio_contador.h"
 #include <iostream>
-#include <random>
 #include <cmath>
 #include <algorithm>
-#include <map>
 
 using namespace std;
 
-MallaConObstaculos::MallaConObstaculos() : next_node_id(0) {
-    grid.resize(GRID_HEIGHT, vector<CellType>(GRID_WIDTH, CellType::FREE));
-    node_ids.resize(GRID_HEIGHT, vector<int>(GRID_WIDTH, -1));
+// Flujos de FlujoAleatorio de cada paso (los ríos usan FLUJO_RIOS + r)
+namespace {
+constexpr uint32_t FLUJO_OBSTACULOS = 1;
+constexpr uint32_t FLUJO_EDIFICIOS = 2;
+constexpr uint32_t FLUJO_LAGOS = 3;
+constexpr uint32_t FLUJO_RIOS = 100;
 }
 
-bool MallaConObstaculos::generar_malla() {
-    cout << "Generando malla de " << GRID_WIDTH << "x" << GRID_HEIGHT << " con obstaculos..." << endl;
+MallaConObstaculos::MallaConObstaculos(int ancho, int alto) : ancho(ancho), alto(alto), next_node_id(0) {
+    grid.resize(alto, vector<CellType>(ancho, CellType::FREE));
+    node_ids.resize(alto, vector<int>(ancho, -1));
+}
+
+// Cantidad de figuras (edificios, rios, ...) para otro tamano de malla: la
+// misma densidad que en la malla por defecto
+static int escalar(int cantidad, double factor) {
+    return max(1, (int)lround(cantidad * factor));
+}
+
+bool MallaConObstaculos::generar_malla(uint32_t semilla) {
+    cout << "Generando malla de " << ancho << "x" << alto << " con obstaculos..." << endl;
+    
+    // Los lagos se ubican a 20 celdas del borde y los ids de nodo son int
+    if (ancho < 64 || alto < 64 || (int64_t)ancho * alto > INT32_MAX) {
+        cerr << "Malla de " << ancho << "x" << alto << " fuera de rango (lado minimo 64, hasta 2^31 celdas)" << endl;
+        return false;
+    }
     
-    random_device rd;
-    mt19937 gen(rd());
+    // Cada paso sortea con FlujoAleatorio por indice de celda o de figura y pinta
+    // por bandas de filas en paralelo: la malla no depende de cuantos hilos haya
     
     // 1. Generar diferentes tipos de obstáculos
     cout << "1. Generando obstaculos aleatorios..." << endl;
-    generar_obstaculos_aleatorios(gen);
+    generar_obstaculos_aleatorios(semilla);
     
     cout << "2. Generando edificios y bloques..." << endl;
-    generar_edificios_rectangulares(gen);
+    generar_edificios_rectangulares(semilla);
     
     cout << "3. Generando rios y lagos..." << endl;
-    generar_rios_y_lagos(gen);
+    generar_rios_y_lagos(semilla);
     
     cout << "4. Creando carreteras principales..." << endl;
     generar_carreteras_principales();
@@ -37,28 +56,17 @@ bool MallaConObstaculos::generar_malla() {
     
     // 2. Asignar IDs a nodos transitables
     cout << "6. Asignando IDs a nodos transitables..." << endl;
-    next_node_id = 0;
-    
-    for (int y = 0; y < GRID_HEIGHT; ++y) {
-        for (int x = 0; x < GRID_WIDTH; ++x) {
-            if (es_transitable(x, y)) {
-                node_ids[y][x] = next_node_id++;
-            }
-        }
-        
-        if (y % 100 == 0) {
-            cout << "Procesando fila " << y << "/" << GRID_HEIGHT << endl;
-        }
-    }
+    asignar_ids();
     
     cout << "Nodos transitables generados: " << next_node_id << endl;
     
     // 3. Verificar que tenemos aproximadamente 2M nodos
-    if (next_node_id < 1800000) {
+    if (next_node_id < 0.9 * ancho * alto) {
         cout << "ADVERTENCIA: Solo se generaron " << next_node_id << " nodos. Reduciendo obstaculos..." << endl;
         // Reducir obstáculos si no hay suficientes nodos
-        for (int y = 0; y < GRID_HEIGHT; y += 3) {
-            for (int x = 0; x < GRID_WIDTH; x += 3) {
+        #pragma omp parallel for schedule(static)
+        for (int y = 0; y < alto; y += 3) {
+            for (int x = 0; x < ancho; x += 3) {
                 if (grid[y][x] == CellType::OBSTACLE) {
                     grid[y][x] = CellType::FREE;
                 }
@@ -66,101 +74,134 @@ bool MallaConObstaculos::generar_malla() {
         }
         
         // Reasignar IDs
-        next_node_id = 0;
-        for (int y = 0; y < GRID_HEIGHT; ++y) {
-            for (int x = 0; x < GRID_WIDTH; ++x) {
-                if (es_transitable(x, y)) {
-                    node_ids[y][x] = next_node_id++;
-                }
-            }
-        }
+        asignar_ids();
         cout << "Nodos después de optimización: " << next_node_id << endl;
     }
     
     return true;
 }
 
-void MallaConObstaculos::generar_obstaculos_aleatorios(mt19937& gen) {
-    uniform_real_distribution<> prob_dist(0.0, 1.0);
-    uniform_int_distribution<> type_dist(1, 3);  // OBSTACLE, WATER, BUILDING
+// Orden de filas, como antes: cuenta por fila, suma prefija y cada fila
+// numera sus celdas libres desde su propio inicio
+void MallaConObstaculos::asignar_ids() {
+    vector<int> inicio_fila(alto + 1, 0);
+    #pragma omp parallel for schedule(static)
+    for (int y = 0; y < alto; ++y) {
+        int libres = 0;
+        for (int x = 0; x < ancho; ++x) {
+            libres += grid[y][x] == CellType::FREE;
+        }
+        inicio_fila[y + 1] = libres;
+    }
+    for (int y = 0; y < alto; ++y) {
+        inicio_fila[y + 1] += inicio_fila[y];
+    }
+    #pragma omp parallel for schedule(static)
+    for (int y = 0; y < alto; ++y) {
+        int id = inicio_fila[y];
+        for (int x = 0; x < ancho; ++x) {
+            node_ids[y][x] = grid[y][x] == CellType::FREE ? id++ : -1;
+        }
+    }
+    next_node_id = inicio_fila[alto];
+}
+
+void MallaConObstaculos::generar_obstaculos_aleatorios(uint32_t semilla) {
+    // Un sorteo por celda: los 53 bits altos deciden si hay obstaculo y los
+    // bajos el tipo (OBSTACLE, WATER, BUILDING)
+    FlujoAleatorio celdas(semilla, FLUJO_OBSTACULOS);
     
-    for (int y = 0; y < GRID_HEIGHT; ++y) {
-        for (int x = 0; x < GRID_WIDTH; ++x) {
-            if (prob_dist(gen) < OBSTACLE_PROBABILITY) {
-                grid[y][x] = static_cast<CellType>(type_dist(gen));
+    #pragma omp parallel for schedule(static)
+    for (int y = 0; y < alto; ++y) {
+        for (int x = 0; x < ancho; ++x) {
+            uint64_t r = celdas((uint64_t)y * ancho + x);
+            if ((r >> 11) * 0x1.0p-53 < OBSTACLE_PROBABILITY) {
+                grid[y][x] = static_cast<CellType>(1 + (r & 0x7FF) % 3);
             }
         }
     }
 }
 
-void MallaConObstaculos::generar_edificios_rectangulares(mt19937& gen) {
-    uniform_int_distribution<> x_dist(0, GRID_WIDTH - 1);
-    uniform_int_distribution<> y_dist(0, GRID_HEIGHT - 1);
-    uniform_int_distribution<> size_dist(5, 25);  // Tamaño de edificios
+void MallaConObstaculos::generar_edificios_rectangulares(uint32_t semilla) {
+    FlujoAleatorio figuras(semilla, FLUJO_EDIFICIOS);
     
-    int num_edificios = 500;  // Número de edificios grandes
+    int num_edificios = escalar(500, (double)ancho * alto / (GRID_WIDTH * GRID_HEIGHT));  // Edificios grandes
     
+    // Cuatro sorteos por edificio: esquina y tamaño (5 a 25)
+    struct Rectangulo { int x0, y0, x1, y1; };
+    vector<Rectangulo> edificios(num_edificios);
     for (int i = 0; i < num_edificios; ++i) {
-        int start_x = x_dist(gen);
-        int start_y = y_dist(gen);
-        int width = size_dist(gen);
-        int height = size_dist(gen);
-        
-        for (int y = start_y; y < min(start_y + height, GRID_HEIGHT); ++y) {
-            for (int x = start_x; x < min(start_x + width, GRID_WIDTH); ++x) {
+        int start_x = figuras.rango(4 * i, 0, ancho - 1);
+        int start_y = figuras.rango(4 * i + 1, 0, alto - 1);
+        int width = figuras.rango(4 * i + 2, 5, 25);
+        int height = figuras.rango(4 * i + 3, 5, 25);
+        edificios[i] = {start_x, start_y, min(start_x + width, ancho), min(start_y + height, alto)};
+    }
+    
+    // Todos pintan BUILDING, asi que el orden entre edificios no importa
+    #pragma omp parallel for schedule(static)
+    for (int y = 0; y < alto; ++y) {
+        for (const Rectangulo& r : edificios) {
+            if (y < r.y0 || y >= r.y1) continue;
+            for (int x = r.x0; x < r.x1; ++x) {
                 grid[y][x] = CellType::BUILDING;
             }
         }
     }
 }
 
-void MallaConObstaculos::generar_rios_y_lagos(mt19937& gen) {
-    // Generar ríos serpenteantes
-    uniform_int_distribution<> start_dist(0, GRID_WIDTH - 1);
-    uniform_int_distribution<> dir_dist(-1, 1);
-    
-    int num_rios = 20;
+void MallaConObstaculos::generar_rios_y_lagos(uint32_t semilla) {
+    // Generar ríos serpenteantes. El recorrido de cada río es una caminata que
+    // depende solo de su propio flujo (dos sorteos por fila: ancho y desvío),
+    // así que los ríos se trazan en paralelo y después se pintan por filas
+    int num_rios = escalar(20, (double)ancho / GRID_WIDTH);
     
+    vector<int> rio_x((size_t)num_rios * alto), rio_ancho((size_t)num_rios * alto);
+    #pragma omp parallel for schedule(static)
     for (int r = 0; r < num_rios; ++r) {
-        int x = start_dist(gen);
-        int y = 0;
-        // int direction = 1;  // Dirección general hacia abajo (no usado actualmente)
+        FlujoAleatorio rio(semilla, FLUJO_RIOS + r);
+        int x = rio.rango(0, 0, ancho - 1);
         
-        while (y < GRID_HEIGHT) {
+        for (int y = 0; y < alto; ++y) {
             // Crear río de ancho variable
-            int width = 2 + (gen() % 4);  // Ancho 2-5
+            rio_x[(size_t)r * alto + y] = x;
+            rio_ancho[(size_t)r * alto + y] = rio.rango(2 * y + 1, 2, 5);  // Ancho 2-5
             
+            // Avanzar con serpenteo, dentro de límites
+            x += rio.rango(2 * y + 2, -1, 1);
+            x = max(0, min(x, ancho - 5));
+        }
+    }
+    
+    // Generar lagos circulares
+    int num_lagos = escalar(30, (double)ancho * alto / (GRID_WIDTH * GRID_HEIGHT));
+    FlujoAleatorio lagos(semilla, FLUJO_LAGOS);
+    struct Lago { int centro_x, centro_y, radio; };
+    vector<Lago> lista_lagos(num_lagos);
+    for (int l = 0; l < num_lagos; ++l) {
+        lista_lagos[l] = {lagos.rango(3 * l, 20, ancho - 20),
+                          lagos.rango(3 * l + 1, 20, alto - 20),
+                          lagos.rango(3 * l + 2, 5, 15)};
+    }
+    
+    #pragma omp parallel for schedule(static)
+    for (int y = 0; y < alto; ++y) {
+        for (int r = 0; r < num_rios; ++r) {
+            int x = rio_x[(size_t)r * alto + y];
+            int width = rio_ancho[(size_t)r * alto + y];
             for (int w = 0; w < width; ++w) {
                 if (en_limites(x + w, y)) {
                     grid[y][x + w] = CellType::WATER;
                 }
             }
-            
-            // Avanzar con serpenteo
-            y += 1;
-            x += dir_dist(gen);  // Serpentear
-            
-            // Mantener dentro de límites
-            x = max(0, min(x, GRID_WIDTH - 5));
         }
-    }
-    
-    // Generar lagos circulares
-    int num_lagos = 30;
-    uniform_int_distribution<> lago_x_dist(20, GRID_WIDTH - 20);
-    uniform_int_distribution<> lago_y_dist(20, GRID_HEIGHT - 20);
-    uniform_int_distribution<> radio_dist(5, 15);
-    
-    for (int l = 0; l < num_lagos; ++l) {
-        int centro_x = lago_x_dist(gen);
-        int centro_y = lago_y_dist(gen);
-        int radio = radio_dist(gen);
-        
-        for (int y = centro_y - radio; y <= centro_y + radio; ++y) {
-            for (int x = centro_x - radio; x <= centro_x + radio; ++x) {
+        for (const Lago& lago : lista_lagos) {
+            int dy = y - lago.centro_y;
+            if (dy < -lago.radio || dy > lago.radio) continue;
+            for (int x = lago.centro_x - lago.radio; x <= lago.centro_x + lago.radio; ++x) {
                 if (en_limites(x, y)) {
-                    float dist = sqrt((x - centro_x) * (x - centro_x) + (y - centro_y) * (y - centro_y));
-                    if (dist <= radio) {
+                    float dist = sqrt((x - lago.centro_x) * (x - lago.centro_x) + dy * dy);
+                    if (dist <= lago.radio) {
                         grid[y][x] = CellType::WATER;
                     }
                 }
@@ -170,10 +211,13 @@ void MallaConObstaculos::generar_rios_y_lagos(mt19937& gen) {
 }
 
 void MallaConObstaculos::generar_carreteras_principales() {
-    // Carreteras horizontales principales
-    for (int i = 0; i < 10; ++i) {
-        int y = (i + 1) * GRID_HEIGHT / 11;  // Distribuir uniformemente
-        for (int x = 0; x < GRID_WIDTH; ++x) {
+    // Carreteras horizontales principales (10 en la malla por defecto, con la
+    // misma separacion en otros tamanos)
+    int num_horizontales = escalar(10, (double)alto / GRID_HEIGHT);
+    int num_verticales = escalar(10, (double)ancho / GRID_WIDTH);
+    for (int i = 0; i < num_horizontales; ++i) {
+        int y = (int)((i + 1) * (int64_t)alto / (num_horizontales + 1));  // Distribuir uniformemente
+        for (int x = 0; x < ancho; ++x) {
             // Carretera de ancho 3
             for (int offset = -1; offset <= 1; ++offset) {
                 if (en_limites(x, y + offset)) {
@@ -184,9 +228,9 @@ void MallaConObstaculos::generar_carreteras_principales() {
     }
     
     // Carreteras verticales principales
-    for (int i = 0; i < 10; ++i) {
-        int x = (i + 1) * GRID_WIDTH / 11;
-        for (int y = 0; y < GRID_HEIGHT; ++y) {
+    for (int i = 0; i < num_verticales; ++i) {
+        int x = (int)((i + 1) * (int64_t)ancho / (num_verticales + 1));
+        for (int y = 0; y < alto; ++y) {
             // Carretera de ancho 3
             for (int offset = -1; offset <= 1; ++offset) {
                 if (en_limites(x + offset, y)) {
@@ -203,7 +247,7 @@ bool MallaConObstaculos::es_transitable(int x, int y) const {
 }
 
 bool MallaConObstaculos::en_limites(int x, int y) const {
-    return x >= 0 && x < GRID_WIDTH && y >= 0 && y < GRID_HEIGHT;
+    return x >= 0 && x < ancho && y >= 0 && y < alto;
 }
 
 int MallaConObstaculos::get_node_id(int x, int y) const {
@@ -216,12 +260,24 @@ CellType MallaConObstaculos::get_cell_type(int x, int y) const {
     return grid[y][x];
 }
 
+size_t MallaConObstaculos::memoria_usada() const {
+    size_t memoria = grid.capacity() * sizeof(vector<CellType>);
+    for (const auto& fila : grid) {
+        memoria += fila.capacity() * sizeof(CellType);
+    }
+    memoria += node_ids.capacity() * sizeof(vector<int>);
+    for (const auto& fila : node_ids) {
+        memoria += fila.capacity() * sizeof(int);
+    }
+    return memoria;
+}
+
 void MallaConObstaculos::exportar_estadisticas() const {
-    int total_celdas = GRID_WIDTH * GRID_HEIGHT;
+    int64_t total_celdas = (int64_t)ancho * alto;
     int libres = 0, obstaculos = 0, agua = 0, edificios = 0;
     
-    for (int y = 0; y < GRID_HEIGHT; ++y) {
-        for (int x = 0; x < GRID_WIDTH; ++x) {
+    for (int y = 0; y < alto; ++y) {
+        for (int x = 0; x < ancho; ++x) {
             switch (grid[y][x]) {
                 case CellType::FREE: libres++; break;
                 case CellType::OBSTACLE: obstaculos++; break;
@@ -232,7 +288,7 @@ void MallaConObstaculos::exportar_estadisticas() const {
     }
     
     cout << "\n=== ESTADISTICAS DE LA MALLA ===" << endl;
-    cout << "Dimensiones: " << GRID_WIDTH << "x" << GRID_HEIGHT << endl;
+    cout << "Dimensiones: " << ancho << "x" << alto << endl;
     cout << "Total de celdas: " << total_celdas << endl;
     cout << "Celdas libres: " << libres << " (" << (100.0 * libres / total_celdas) << "%)" << endl;
     cout << "Obstaculos: " << obstaculos << " (" << (100.0 * obstaculos / total_celdas) << "%)" << endl;
@@ -242,17 +298,21 @@ void MallaConObstaculos::exportar_estadisticas() const {
 }
 
 void aplicar_suavizado_obstaculos(vector<vector<CellType>>& grid) {
-    // Aplicar filtro de suavizado para hacer obstáculos más coherentes
+    // Aplicar filtro de suavizado para hacer obstáculos más coherentes.
+    // Cada fila lee de la copia y escribe solo la suya: paralelo por filas
     vector<vector<CellType>> temp_grid = grid;
+    const int alto = grid.size();
+    const int ancho = alto > 0 ? grid[0].size() : 0;
     
-    for (int y = 1; y < GRID_HEIGHT - 1; ++y) {
-        for (int x = 1; x < GRID_WIDTH - 1; ++x) {
-            // Contar vecinos del mismo tipo
-            map<CellType, int> vecinos_count;
+    #pragma omp parallel for schedule(static)
+    for (int y = 1; y < alto - 1; ++y) {
+        for (int x = 1; x < ancho - 1; ++x) {
+            // Contar vecinos de cada tipo
+            int vecinos_count[4] = {0, 0, 0, 0};
             
             for (int dy = -1; dy <= 1; ++dy) {
                 for (int dx = -1; dx <= 1; ++dx) {
-                    vecinos_count[grid[y + dy][x + dx]]++;
+                    vecinos_count[static_cast<int>(grid[y + dy][x + dx])]++;
                 }
             }
             
@@ -260,10 +320,10 @@ void aplicar_suavizado_obstaculos(vector<vector<CellType>>& grid) {
             CellType tipo_mayoritario = CellType::FREE;
             int max_count = 0;
             
-            for (const auto& [tipo, count] : vecinos_count) {
-                if (count > max_count) {
-                    max_count = count;
-                    tipo_mayoritario = tipo;
+            for (int tipo = 0; tipo < 4; ++tipo) {
+                if (vecinos_count[tipo] > max_count) {
+                    max_count = vecinos_count[tipo];
+                    tipo_mayoritario = static_cast<CellType>(tipo);
                 }
             }
             
@@ -273,7 +333,7 @@ void aplicar_suavizado_obstaculos(vector<vector<CellType>>& grid) {
         }
     }
     
-    grid = temp_grid;
+    grid.swap(temp_grid);
 }
 
 pair<float, float> coordenadas_mundo(int grid_x, int grid_y) {
@@ -286,7 +346,7 @@ bool generar_grafo_desde_malla() {
     
     cout << "=== GENERANDO GRAFO DESDE MALLA CON OBSTACULOS ===" << endl;
     
-    if (!malla.generar_malla()) {
+    if (!malla.generar_malla(SEMILLA_GRAFO_DEFECTO)) {
         cerr << "Error al generar la malla" << endl;
         return false;
     }
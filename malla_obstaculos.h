@@ -1,15 +1,33 @@
 #pragma once
 #include <vector>
-#include <random>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include "aleatorio_contador.h"
 
-// Configuración de la malla
+// Configuración de la malla (tamaño por defecto; MallaConObstaculos recibe el real)
 constexpr int GRID_WIDTH = 1414;   // sqrt(2M) aproximadamente para 2M nodos
 constexpr int GRID_HEIGHT = 1414;
 constexpr float OBSTACLE_PROBABILITY = 0.15f;  // 15% de obstáculos
 constexpr float CELL_SIZE = 1.0f;
 
+// Vecindad de la malla: las 4 ortogonales y despues las 4 diagonales. El grafo
+// de generar_grafo_con_malla_obstaculos y la vista implicita (malla_implicita.h)
+// usan estas tablas y peso_arista_malla, asi describen el mismo grafo
+constexpr int DX_MALLA[8] = {0, 0, 1, -1, 1, 1, -1, -1};
+constexpr int DY_MALLA[8] = {1, -1, 0, 0, 1, -1, 1, -1};
+constexpr uint32_t FLUJO_PESOS_MALLA = 3;
+constexpr float VARIACION_MINIMA_MALLA = 0.9f;   // Peso / largo mas chico posible
+
+// Distancia euclidiana con variacion de ±10% sorteada por (nodo, direccion)
+inline float peso_arista_malla(const FlujoAleatorio& variacion, int nodo, int d) {
+    const float peso_base = d < 4 ? 1.0f : 1.41421356f;
+    int v = variacion.entero(8 * (uint64_t)nodo + d, 100);
+    return peso_base * (0.9f + 0.2f * v / 100.0f);
+}
+
 // Tipos de celdas
-enum class CellType {
+enum class CellType : uint8_t {
     FREE = 0,      // Celda libre (transitable)
     OBSTACLE = 1,  // Obstáculo (no transitable)
     WATER = 2,     // Agua (no transitable)
@@ -21,13 +39,16 @@ class MallaConObstaculos {
 private:
     std::vector<std::vector<CellType>> grid;
     std::vector<std::vector<int>> node_ids;  // ID del nodo en cada celda
+    int ancho, alto;                         // En celdas
     int next_node_id;
     
     // Generadores de obstáculos
-    void generar_obstaculos_aleatorios(std::mt19937& gen);
-    void generar_edificios_rectangulares(std::mt19937& gen);
-    void generar_rios_y_lagos(std::mt19937& gen);
+    // (sorteos de FlujoAleatorio por celda o figura, ver aleatorio_contador.h)
+    void generar_obstaculos_aleatorios(uint32_t semilla);
+    void generar_edificios_rectangulares(uint32_t semilla);
+    void generar_rios_y_lagos(uint32_t semilla);
     void generar_carreteras_principales();
+    void asignar_ids();   // Orden de filas, en paralelo
     
     // Utilidades
     bool es_transitable(int x, int y) const;
@@ -36,17 +57,20 @@ private:
     float calcular_peso_arista(int x1, int y1, int x2, int y2) const;
 
 public:
-    MallaConObstaculos();
+    MallaConObstaculos(int ancho = GRID_WIDTH, int alto = GRID_HEIGHT);
     ~MallaConObstaculos() = default;
     
     // Métodos principales
-    bool generar_malla();
+    bool generar_malla(uint32_t semilla);
     void exportar_estadisticas() const;
     
     // Getters
     int get_node_id(int x, int y) const;
     CellType get_cell_type(int x, int y) const;
     int get_total_nodes() const { return next_node_id; }
+    int get_ancho() const { return ancho; }
+    int get_alto() const { return alto; }
+    size_t memoria_usada() const;   // grid + node_ids, incluyendo cabeceras de cada fila
     
     // Para depuración
     void exportar_malla_imagen(const std::string& filename) const;
@@ -57,6 +81,5 @@ public:
 bool generar_grafo_desde_malla();
 
 // Funciones de utilidad
-void generar_obstaculos_coherentes(std::vector<std::vector<CellType>>& grid, std::mt19937& gen);
 void aplicar_suavizado_obstaculos(std::vector<std::vector<CellType>>& grid);
 std::pair<float, float> coordenadas_mundo(int grid_x, int grid_y);
@@ -2,7 +2,7 @@
 #include <cmath>
 #include "grafo_arequipa.h" 
 #include "estructuras.h"
-#include "bfs.h"
+#include "algoritmos.h"
 
 
 const int ANCHO = 1200;
@@ -12,8 +12,7 @@ int nodoOrigen = -1;
 int nodoDestino = -1;
 const float radioSeleccion = 5.0f;
 
-int camino[NODE_COUNT];
-int largoCamino = 0;
+ResultadoRuta ruta;   // Buffer reutilizado entre busquedas
 
 int main() {
     sf::RenderWindow ventana(sf::VideoMode(ANCHO, ALTO), "Mapa de Arequipa - Grafo");
@@ -91,13 +90,13 @@ int main() {
             }
             if (evento.type == sf::Event::KeyPressed) {
                 if (evento.key.code == sf::Keyboard::B && nodoOrigen != -1 && nodoDestino != -1) {
-                    buscar_BFS(nodoOrigen, nodoDestino, camino, largoCamino);
+                    buscar_BFS(nodoOrigen, nodoDestino, ruta);
                 }
 
                 if (evento.key.code == sf::Keyboard::R) {
                     nodoOrigen = -1;
                     nodoDestino = -1;
-                    largoCamino = 0;
+                    ruta.vaciar_camino();
                 }
             }
         }
@@ -114,10 +113,10 @@ int main() {
                 ventana.draw(linea, 2, sf::Lines);
             }
         }
-        if (largoCamino > 1) {
-            for (int i = 0; i < largoCamino - 1; ++i) {
-                int u = camino[i];
-                int v = camino[i + 1];
+        if (ruta.largo() > 1) {
+            for (int i = 0; i < ruta.largo() - 1; ++i) {
+                int u = ruta[i];
+                int v = ruta[i + 1];
 
                 sf::Vertex linea[] = {
                     sf::Vertex(sf::Vector2f(POS_X[u], POS_Y[u]), sf::Color::Blue),
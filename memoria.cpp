@@ -0,0 +1,44 @@
+#include "memoria.h"
+#include <fstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+double obtener_rss_actual_mb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+        return pmc.WorkingSetSize / 1024.0 / 1024.0;
+    }
+    return 0.0;
+#else
+    // /proc/self/statm: tamano total y paginas residentes (en paginas)
+    ifstream statm("/proc/self/statm");
+    long paginas_totales = 0, paginas_residentes = 0;
+    if (!(statm >> paginas_totales >> paginas_residentes)) {
+        return 0.0;
+    }
+    return paginas_residentes * (double)sysconf(_SC_PAGESIZE) / 1024.0 / 1024.0;
+#endif
+}
+
+double obtener_rss_pico_mb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+        return pmc.PeakWorkingSetSize / 1024.0 / 1024.0;
+    }
+    return 0.0;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0; // En Linux ru_maxrss esta en KB
+#endif
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <cstddef>
+#include <new>
+
+// Contabilidad de memoria.
+//
+// ru_maxrss es el pico de todo el proceso y no sirve para medir una consulta
+// cuando varios hilos buscan a la vez. Cada hilo lleva su propio contador de
+// memoria temporal: las busquedas reservan sus arrays en la arena del hilo
+// (arena.h), con reservar_temporal() o con AsignadorContado en contenedores
+// STL, y la memoria de una consulta es el pico del contador del hilo mientras
+// se ejecuta.
+
+struct ContadorMemoriaHilo {
+    size_t bytes_actuales = 0;   // Memoria temporal viva en este hilo
+    size_t bytes_pico = 0;       // Maximo desde el ultimo iniciar_medicion_memoria()
+    size_t asignaciones = 0;     // Llamadas al asignador global (o bloques nuevos de la arena)
+};
+
+inline thread_local ContadorMemoriaHilo memoria_hilo;
+
+// Memoria temporal que pasa a estar viva (sin importar de donde salio)
+inline void registrar_uso(size_t bytes) {
+    memoria_hilo.bytes_actuales += bytes;
+    if (memoria_hilo.bytes_actuales > memoria_hilo.bytes_pico) {
+        memoria_hilo.bytes_pico = memoria_hilo.bytes_actuales;
+    }
+}
+
+// Llamada al asignador global o al sistema (new, mmap)
+inline void registrar_llamada_asignador() {
+    memoria_hilo.asignaciones++;
+}
+
+inline void registrar_asignacion(size_t bytes) {
+    registrar_llamada_asignador();
+    registrar_uso(bytes);
+}
+
+inline void registrar_liberacion(size_t bytes) {
+    memoria_hilo.bytes_actuales -= bytes;
+}
+
+// Arrays temporales contabilizados (reemplazo de new[]/delete[] en las busquedas)
+template<typename T>
+inline T* reservar_temporal(size_t cantidad, bool con_ceros = false) {
+    T* ptr = con_ceros ? new T[cantidad]() : new T[cantidad];
+    registrar_asignacion(cantidad * sizeof(T));
+    return ptr;
+}
+
+template<typename T>
+inline void liberar_temporal(T* ptr, size_t cantidad) {
+    delete[] ptr;
+    registrar_liberacion(cantidad * sizeof(T));
+}
+
+// Asignador para contenedores STL que suma al contador del hilo
+template<typename T>
+struct AsignadorContado {
+    using value_type = T;
+
+    AsignadorContado() = default;
+    template<typename U>
+    AsignadorContado(const AsignadorContado<U>&) {}
+
+    T* allocate(size_t n) {
+        T* ptr = static_cast<T*>(::operator new(n * sizeof(T)));
+        registrar_asignacion(n * sizeof(T));
+        return ptr;
+    }
+
+    void deallocate(T* ptr, size_t n) {
+        ::operator delete(ptr);
+        registrar_liberacion(n * sizeof(T));
+    }
+
+    template<typename U>
+    bool operator==(const AsignadorContado<U>&) const { return true; }
+    template<typename U>
+    bool operator!=(const AsignadorContado<U>&) const { return false; }
+};
+
+// Medicion de una consulta: marca al inicio, pico relativo al final
+inline size_t iniciar_medicion_memoria() {
+    memoria_hilo.bytes_pico = memoria_hilo.bytes_actuales;
+    return memoria_hilo.bytes_actuales;
+}
+
+inline size_t bytes_pico_desde(size_t marca) {
+    return memoria_hilo.bytes_pico - marca;
+}
+
+// Memoria del proceso
+double obtener_rss_actual_mb();      // RSS actual (Linux: /proc/self/statm)
+double obtener_rss_pico_mb();        // Pico de RSS del proceso (ru_maxrss)
@@ -6,33 +6,18 @@
 #include <cmath>
 #include <iomanip>
 
-#ifdef _WIN32
-#include <windows.h>
-#include <psapi.h>
-#else
-#include <sys/resource.h>
-#include <unistd.h>
-#endif
+#include "memoria.h"
 
 using namespace std;
 
+// Memoria residente actual del proceso (ya no el pico ru_maxrss)
 double obtener_memoria_actual() {
-#ifdef _WIN32
-    PROCESS_MEMORY_COUNTERS pmc;
-    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
-        return pmc.WorkingSetSize / 1024.0 / 1024.0; // MB
-    }
-    return 0.0;
-#else
-    struct rusage usage;
-    getrusage(RUSAGE_SELF, &usage);
-    return usage.ru_maxrss / 1024.0; // MB (en Linux ru_maxrss está en KB)
-#endif
+    return obtener_rss_actual_mb();
 }
 
 void mostrar_uso_memoria() {
-    double memoria = obtener_memoria_actual();
-    cout << "Memoria actual: " << fixed << setprecision(2) << memoria << " MB" << endl;
+    cout << "Memoria actual (RSS): " << fixed << setprecision(2) << obtener_rss_actual_mb() << " MB"
+         << ", pico del proceso: " << obtener_rss_pico_mb() << " MB" << endl;
 }
 
 ComparacionRendimiento calcular_estadisticas(const vector<PruebaRendimiento>& resultados) {
@@ -53,11 +38,38 @@ ComparacionRendimiento calcular_estadisticas(const vector<PruebaRendimiento>& re
         stats.caminos_encontrados = 0;
         
         vector<double> tiempos, memorias, longitudes;
+        HistogramaLatencia& histograma = comp.latencias[nombre];
+        vector<HistogramaLatencia>& por_banda = comp.latencias_por_banda[nombre];
+        ContadoresBusqueda suma;
+        double pico_max = 0;
+        LecturaHardware suma_hw;
+        int lecturas_hw = 0;
         
         for (const auto& prueba : pruebas) {
             tiempos.push_back(prueba.tiempo_ms);
+            histograma.registrar_ms(prueba.tiempo_ms);
+            if (prueba.banda >= 0) {
+                if ((int)por_banda.size() <= prueba.banda) por_banda.resize(prueba.banda + 1);
+                por_banda[prueba.banda].registrar_ms(prueba.tiempo_ms);
+            }
             memorias.push_back(prueba.memoria_mb);
             
+            const ContadoresBusqueda& c = prueba.contadores;
+            suma.nodos_extraidos += c.nodos_extraidos;
+            suma.extracciones_obsoletas += c.extracciones_obsoletas;
+            suma.aristas_revisadas += c.aristas_revisadas;
+            suma.relajaciones += c.relajaciones;
+            suma.inserciones_cola += c.inserciones_cola;
+            suma.pico_cola += c.pico_cola;
+            pico_max = max(pico_max, (double)c.pico_cola);
+            
+            if (prueba.hardware.valida) {
+                for (int e = 0; e < NUM_EVENTOS_HARDWARE; ++e) {
+                    suma_hw.valores[e] += prueba.hardware.valores[e];
+                }
+                lecturas_hw++;
+            }
+            
             if (prueba.encontro_camino) {
                 stats.caminos_encontrados++;
                 longitudes.push_back(prueba.longitud_camino);
@@ -76,6 +88,14 @@ ComparacionRendimiento calcular_estadisticas(const vector<PruebaRendimiento>& re
         }
         stats.tiempo_desv_std = sqrt(suma_cuadrados / tiempos.size());
         
+        // Percentiles (se recalculan en aplicar_latencias con los histogramas de los hilos)
+        stats.tiempo_p50_ms = histograma.percentil_ms(50);
+        stats.tiempo_p90_ms = histograma.percentil_ms(90);
+        stats.tiempo_p99_ms = histograma.percentil_ms(99);
+        stats.tiempo_p999_ms = histograma.percentil_ms(99.9);
+        double tiempo_total_s = accumulate(tiempos.begin(), tiempos.end(), 0.0) / 1000.0;
+        stats.qps_por_hilo = tiempo_total_s > 0 ? pruebas.size() / tiempo_total_s : 0;
+        
         // Estadísticas de memoria
         stats.memoria_promedio_mb = accumulate(memorias.begin(), memorias.end(), 0.0) / memorias.size();
         stats.memoria_max_mb = *max_element(memorias.begin(), memorias.end());
@@ -93,6 +113,43 @@ ComparacionRendimiento calcular_estadisticas(const vector<PruebaRendimiento>& re
             stats.longitud_max = 0;
         }
         
+        // Contadores de trabajo
+        double n = pruebas.size();
+        stats.nodos_extraidos_prom = suma.nodos_extraidos / n;
+        stats.extracciones_obsoletas_prom = suma.extracciones_obsoletas / n;
+        stats.aristas_revisadas_prom = suma.aristas_revisadas / n;
+        stats.relajaciones_prom = suma.relajaciones / n;
+        stats.inserciones_cola_prom = suma.inserciones_cola / n;
+        stats.pico_cola_prom = suma.pico_cola / n;
+        stats.pico_cola_max = pico_max;
+        
+        double tiempo_total_ns = accumulate(tiempos.begin(), tiempos.end(), 0.0) * 1e6;
+        uint64_t asentados = suma.nodos_extraidos - suma.extracciones_obsoletas;
+        stats.ns_por_nodo_asentado = asentados > 0 ? tiempo_total_ns / asentados : 0;
+        stats.ns_por_relajacion = suma.relajaciones > 0 ? tiempo_total_ns / suma.relajaciones : 0;
+        
+        if (suma.nodos_extraidos > 0) {
+            comp.contadores_activos = true;
+        }
+        
+        // Contadores de hardware: por consulta, y por nodo asentado si hay contadores de trabajo
+        double nh = max(1, lecturas_hw);
+        stats.ciclos_prom = suma_hw.valores[EVENTO_CICLOS] / nh;
+        stats.instrucciones_prom = suma_hw.valores[EVENTO_INSTRUCCIONES] / nh;
+        stats.ipc = stats.ciclos_prom > 0 ? stats.instrucciones_prom / stats.ciclos_prom : 0;
+        stats.l1d_fallos_prom = suma_hw.valores[EVENTO_L1D_FALLOS] / nh;
+        stats.llc_fallos_prom = suma_hw.valores[EVENTO_LLC_FALLOS] / nh;
+        stats.dtlb_fallos_prom = suma_hw.valores[EVENTO_DTLB_FALLOS] / nh;
+        stats.saltos_fallidos_prom = suma_hw.valores[EVENTO_SALTOS_FALLIDOS] / nh;
+        double asentados_hw = asentados > 0 ? (double)asentados : 0;
+        stats.l1d_por_nodo = asentados_hw > 0 ? suma_hw.valores[EVENTO_L1D_FALLOS] / asentados_hw : 0;
+        stats.llc_por_nodo = asentados_hw > 0 ? suma_hw.valores[EVENTO_LLC_FALLOS] / asentados_hw : 0;
+        stats.dtlb_por_nodo = asentados_hw > 0 ? suma_hw.valores[EVENTO_DTLB_FALLOS] / asentados_hw : 0;
+        stats.saltos_por_nodo = asentados_hw > 0 ? suma_hw.valores[EVENTO_SALTOS_FALLIDOS] / asentados_hw : 0;
+        if (lecturas_hw > 0) {
+            comp.hardware_activo = true;
+        }
+        
         comp.stats[nombre] = stats;
     }
     
@@ -124,12 +181,44 @@ ComparacionRendimiento calcular_estadisticas(const vector<PruebaRendimiento>& re
     return comp;
 }
 
+void aplicar_latencias(ComparacionRendimiento& comp, const vector<LatenciasPorAlgoritmo>& por_hilo,
+                       double duracion_s) {
+    LatenciasPorAlgoritmo combinadas;
+    for (const auto& hilo : por_hilo) {
+        for (const auto& [nombre, histograma] : hilo) {
+            combinadas[nombre].combinar(histograma);
+        }
+    }
+    
+    uint64_t total_consultas = 0;
+    for (auto& [nombre, histograma] : combinadas) {
+        total_consultas += histograma.cantidad();
+        auto it = comp.stats.find(nombre);
+        if (it == comp.stats.end() || histograma.cantidad() == 0) continue;
+        
+        EstadisticasAlgoritmo& stats = it->second;
+        stats.tiempo_p50_ms = histograma.percentil_ms(50);
+        stats.tiempo_p90_ms = histograma.percentil_ms(90);
+        stats.tiempo_p99_ms = histograma.percentil_ms(99);
+        stats.tiempo_p999_ms = histograma.percentil_ms(99.9);
+        stats.tiempo_max_ms = histograma.maximo() / 1e6;
+        comp.latencias[nombre] = histograma;
+    }
+    
+    comp.duracion_s = duracion_s;
+    comp.qps_total = duracion_s > 0 ? total_consultas / duracion_s : 0;
+}
+
 void mostrar_resumen_ejecutivo(const ComparacionRendimiento& comp) {
     cout << "\n=== RESUMEN EJECUTIVO ===" << endl;
     cout << "Algoritmo mas rapido: " << comp.algoritmo_mas_rapido << endl;
     cout << "Algoritmo mas lento: " << comp.algoritmo_mas_lento << endl;
     cout << "Mejor uso de memoria: " << comp.algoritmo_mejor_memoria << endl;
     cout << "Mejor calidad de ruta: " << comp.algoritmo_mejor_calidad << endl;
+    if (comp.duracion_s > 0) {
+        cout << "QPS total: " << fixed << setprecision(1) << comp.qps_total
+             << " (" << comp.duracion_s << " s)" << endl;
+    }
 }
 
 void mostrar_estadisticas_detalladas(const ComparacionRendimiento& comp) {
@@ -155,28 +244,160 @@ void mostrar_estadisticas_detalladas(const ComparacionRendimiento& comp) {
              << setw(12) << stats.tasa_exito
              << setw(12) << stats.longitud_promedio << endl;
     }
+    
+    cout << "\n=== LATENCIA (ms) ===" << endl;
+    cout << left << setw(12) << "Algoritmo"
+         << setw(12) << "p50"
+         << setw(12) << "p90"
+         << setw(12) << "p99"
+         << setw(12) << "p99.9"
+         << setw(12) << "max"
+         << setw(12) << "QPS/hilo" << endl;
+    
+    cout << string(84, '-') << endl;
+    
+    for (const auto& [nombre, stats] : comp.stats) {
+        cout << left << setw(12) << nombre
+             << setw(12) << stats.tiempo_p50_ms
+             << setw(12) << stats.tiempo_p90_ms
+             << setw(12) << stats.tiempo_p99_ms
+             << setw(12) << stats.tiempo_p999_ms
+             << setw(12) << stats.tiempo_max_ms
+             << setw(12) << setprecision(1) << stats.qps_por_hilo << setprecision(3) << endl;
+    }
+    
+    if (comp.hardware_activo) {
+        cout << "\n=== CONTADORES DE HARDWARE (promedio por consulta) ===" << endl;
+        cout << left << setw(12) << "Algoritmo"
+             << setw(14) << "Ciclos"
+             << setw(14) << "Instrucc."
+             << setw(8) << "IPC"
+             << setw(12) << "L1d-fallos"
+             << setw(12) << "LLC-fallos"
+             << setw(12) << "dTLB-fallos"
+             << setw(12) << "Saltos-fall." << endl;
+        
+        cout << string(96, '-') << endl;
+        
+        for (const auto& [nombre, stats] : comp.stats) {
+            cout << left << setw(12) << nombre << setprecision(0)
+                 << setw(14) << stats.ciclos_prom
+                 << setw(14) << stats.instrucciones_prom
+                 << setw(8) << setprecision(2) << stats.ipc << setprecision(0)
+                 << setw(12) << stats.l1d_fallos_prom
+                 << setw(12) << stats.llc_fallos_prom
+                 << setw(12) << stats.dtlb_fallos_prom
+                 << setw(12) << stats.saltos_fallidos_prom << endl;
+        }
+        
+        if (comp.contadores_activos) {
+            cout << "\nFallos por nodo asentado:" << endl;
+            cout << left << setw(12) << "Algoritmo"
+                 << setw(12) << "L1d"
+                 << setw(12) << "LLC"
+                 << setw(12) << "dTLB"
+                 << setw(12) << "Saltos" << endl;
+            cout << setprecision(3);
+            for (const auto& [nombre, stats] : comp.stats) {
+                cout << left << setw(12) << nombre
+                     << setw(12) << stats.l1d_por_nodo
+                     << setw(12) << stats.llc_por_nodo
+                     << setw(12) << stats.dtlb_por_nodo
+                     << setw(12) << stats.saltos_por_nodo << endl;
+            }
+        }
+        cout << setprecision(3);
+    }
+    
+    if (!comp.contadores_activos) return;
+    
+    cout << "\n=== TRABAJO POR CONSULTA (promedios) ===" << endl;
+    cout << left << setw(12) << "Algoritmo"
+         << setw(14) << "Asentados"
+         << setw(12) << "Obsoletos"
+         << setw(14) << "Aristas"
+         << setw(14) << "Relajac."
+         << setw(14) << "Inserc."
+         << setw(12) << "PicoCola"
+         << setw(12) << "ns/nodo"
+         << setw(12) << "ns/relaj." << endl;
+    
+    cout << string(116, '-') << endl;
+    cout << setprecision(1);
+    
+    for (const auto& [nombre, stats] : comp.stats) {
+        cout << left << setw(12) << nombre
+             << setw(14) << (stats.nodos_extraidos_prom - stats.extracciones_obsoletas_prom)
+             << setw(12) << stats.extracciones_obsoletas_prom
+             << setw(14) << stats.aristas_revisadas_prom
+             << setw(14) << stats.relajaciones_prom
+             << setw(14) << stats.inserciones_cola_prom
+             << setw(12) << stats.pico_cola_max
+             << setw(12) << stats.ns_por_nodo_asentado
+             << setw(12) << stats.ns_por_relajacion << endl;
+    }
+}
+
+void mostrar_latencia_por_banda(const ComparacionRendimiento& comp) {
+    size_t num_bandas = 0;
+    for (const auto& [nombre, bandas] : comp.latencias_por_banda) {
+        num_bandas = max(num_bandas, bandas.size());
+    }
+    if (num_bandas == 0) return;
+    
+    cout << "\n=== LATENCIA POR BANDA (ms) ===" << endl;
+    cout << fixed << setprecision(3);
+    cout << left << setw(12) << "Algoritmo"
+         << setw(16) << "Banda"
+         << setw(10) << "N"
+         << setw(12) << "Prom"
+         << setw(12) << "p50"
+         << setw(12) << "p90"
+         << setw(12) << "p99"
+         << setw(12) << "max" << endl;
+    
+    cout << string(98, '-') << endl;
+    
+    for (const auto& [nombre, bandas] : comp.latencias_por_banda) {
+        for (size_t b = 0; b < bandas.size(); ++b) {
+            const HistogramaLatencia& h = bandas[b];
+            if (h.cantidad() == 0) continue;
+            string banda = b < comp.nombres_bandas.size() ? comp.nombres_bandas[b] : to_string(b);
+            cout << left << setw(12) << nombre
+                 << setw(16) << banda
+                 << setw(10) << h.cantidad()
+                 << setw(12) << h.promedio_ns() / 1e6
+                 << setw(12) << h.percentil_ms(50)
+                 << setw(12) << h.percentil_ms(90)
+                 << setw(12) << h.percentil_ms(99)
+                 << setw(12) << h.maximo() / 1e6 << endl;
+        }
+    }
 }
 
 void analizar_resultados(const vector<PruebaRendimiento>& resultados, int num_pruebas) {
+    analizar_resultados(calcular_estadisticas(resultados), resultados.size(), num_pruebas);
+}
+
+void analizar_resultados(const ComparacionRendimiento& comp, size_t total_pruebas, int num_pruebas) {
     cout << "\n=== ANALISIS DE RESULTADOS ===" << endl;
-    cout << "Total de pruebas realizadas: " << resultados.size() << endl;
+    cout << "Total de pruebas realizadas: " << total_pruebas << endl;
     cout << "Pruebas por algoritmo: " << num_pruebas << endl;
     
-    ComparacionRendimiento comp = calcular_estadisticas(resultados);
-    
     mostrar_resumen_ejecutivo(comp);
     mostrar_estadisticas_detalladas(comp);
+    mostrar_latencia_por_banda(comp);
     
     // Análisis adicional
     cout << "\n=== ANALISIS COMPARATIVO ===" << endl;
     
     if (comp.stats.count("Dijkstra") && comp.stats.count("AStar")) {
-        double speedup = comp.stats["Dijkstra"].tiempo_promedio_ms / comp.stats["AStar"].tiempo_promedio_ms;
+        double speedup = comp.stats.at("Dijkstra").tiempo_promedio_ms / comp.stats.at("AStar").tiempo_promedio_ms;
         cout << "A* es " << speedup << "x " << (speedup > 1 ? "mas rapido" : "mas lento") << " que Dijkstra" << endl;
     }
     
     if (comp.stats.count("BFS") && comp.stats.count("Dijkstra")) {
-        double speedup = comp.stats["Dijkstra"].tiempo_promedio_ms / comp.stats["BFS"].tiempo_promedio_ms;
+        double speedup = comp.stats.at("Dijkstra").tiempo_promedio_ms / comp.stats.at("BFS").tiempo_promedio_ms;
         cout << "BFS es " << speedup << "x " << (speedup < 1 ? "mas rapido" : "mas lento") << " que Dijkstra" << endl;
     }
 }
@@ -190,23 +411,130 @@ void guardar_resultados_csv(const vector<PruebaRendimiento>& resultados, const s
     }
     
     // Header
-    file << "Origen,Destino,Algoritmo,Tiempo_ms,Longitud_Camino,Memoria_MB,Encontro_Camino\n";
+    file << "Origen,Destino,Banda,Algoritmo,Tiempo_ms,Longitud_Camino,Memoria_MB,Encontro_Camino,"
+         << "Nodos_Extraidos,Extracciones_Obsoletas,Aristas_Revisadas,Relajaciones,Inserciones_Cola,Pico_Cola,"
+         << "Ciclos,Instrucciones,L1d_Fallos,LLC_Fallos,dTLB_Fallos,Saltos_Fallidos,Asignaciones\n";
     
     // Datos
     for (const auto& resultado : resultados) {
+        const ContadoresBusqueda& c = resultado.contadores;
         file << resultado.origen << ","
              << resultado.destino << ","
+             << resultado.banda << ","
              << resultado.algoritmo << ","
              << resultado.tiempo_ms << ","
              << resultado.longitud_camino << ","
              << resultado.memoria_mb << ","
-             << (resultado.encontro_camino ? "1" : "0") << "\n";
+             << (resultado.encontro_camino ? "1" : "0") << ","
+             << c.nodos_extraidos << ","
+             << c.extracciones_obsoletas << ","
+             << c.aristas_revisadas << ","
+             << c.relajaciones << ","
+             << c.inserciones_cola << ","
+             << c.pico_cola;
+        for (int e = 0; e < NUM_EVENTOS_HARDWARE; ++e) {
+            file << "," << resultado.hardware.valores[e];
+        }
+        file << "," << resultado.asignaciones << "\n";
     }
     
     file.close();
     cout << "Resultados guardados en: " << archivo << endl;
 }
 
+void guardar_estadisticas_csv(const ComparacionRendimiento& comp, const string& archivo) {
+    ofstream file(archivo);
+    
+    if (!file.is_open()) {
+        cerr << "Error al abrir archivo CSV: " << archivo << endl;
+        return;
+    }
+    
+    file << "Algoritmo,Consultas,Tiempo_Prom_ms,Tiempo_Min_ms,P50_ms,P90_ms,P99_ms,P999_ms,Tiempo_Max_ms,"
+         << "QPS_Hilo,QPS_Total,Memoria_Prom_MB,Tasa_Exito,Ciclos_Prom,Instrucciones_Prom,IPC,"
+         << "L1d_Fallos_Prom,LLC_Fallos_Prom,dTLB_Fallos_Prom,Saltos_Fallidos_Prom,"
+         << "L1d_Por_Nodo,LLC_Por_Nodo,dTLB_Por_Nodo,Saltos_Por_Nodo";
+    // Trabajo por consulta: solo si se compilo con CONTADORES_BUSQUEDA
+    if (comp.contadores_activos) {
+        file << ",Nodos_Extraidos_Prom,Extracciones_Obsoletas_Prom,Aristas_Revisadas_Prom,Relajaciones_Prom,"
+             << "Inserciones_Cola_Prom,Pico_Cola_Prom,Pico_Cola_Max,Ns_Por_Nodo_Asentado,Ns_Por_Relajacion";
+    }
+    file << "\n";
+    
+    for (const auto& [nombre, stats] : comp.stats) {
+        file << nombre << ","
+             << stats.caminos_totales << ","
+             << stats.tiempo_promedio_ms << ","
+             << stats.tiempo_min_ms << ","
+             << stats.tiempo_p50_ms << ","
+             << stats.tiempo_p90_ms << ","
+             << stats.tiempo_p99_ms << ","
+             << stats.tiempo_p999_ms << ","
+             << stats.tiempo_max_ms << ","
+             << stats.qps_por_hilo << ","
+             << comp.qps_total << ","
+             << stats.memoria_promedio_mb << ","
+             << stats.tasa_exito << ","
+             << stats.ciclos_prom << ","
+             << stats.instrucciones_prom << ","
+             << stats.ipc << ","
+             << stats.l1d_fallos_prom << ","
+             << stats.llc_fallos_prom << ","
+             << stats.dtlb_fallos_prom << ","
+             << stats.saltos_fallidos_prom << ","
+             << stats.l1d_por_nodo << ","
+             << stats.llc_por_nodo << ","
+             << stats.dtlb_por_nodo << ","
+             << stats.saltos_por_nodo;
+        if (comp.contadores_activos) {
+            file << "," << stats.nodos_extraidos_prom
+                 << "," << stats.extracciones_obsoletas_prom
+                 << "," << stats.aristas_revisadas_prom
+                 << "," << stats.relajaciones_prom
+                 << "," << stats.inserciones_cola_prom
+                 << "," << stats.pico_cola_prom
+                 << "," << stats.pico_cola_max
+                 << "," << stats.ns_por_nodo_asentado
+                 << "," << stats.ns_por_relajacion;
+        }
+        file << "\n";
+    }
+    
+    file.close();
+    cout << "Estadisticas guardadas en: " << archivo << endl;
+}
+
+void guardar_latencia_por_banda_csv(const ComparacionRendimiento& comp, const string& archivo) {
+    ofstream file(archivo);
+    
+    if (!file.is_open()) {
+        cerr << "Error al abrir archivo CSV: " << archivo << endl;
+        return;
+    }
+    
+    file << "Algoritmo,Banda,Nombre_Banda,Consultas,Tiempo_Prom_ms,P50_ms,P90_ms,P99_ms,P999_ms,Tiempo_Max_ms\n";
+    
+    for (const auto& [nombre, bandas] : comp.latencias_por_banda) {
+        for (size_t b = 0; b < bandas.size(); ++b) {
+            const HistogramaLatencia& h = bandas[b];
+            if (h.cantidad() == 0) continue;
+            file << nombre << ","
+                 << b << ","
+                 << (b < comp.nombres_bandas.size() ? comp.nombres_bandas[b] : to_string(b)) << ","
+                 << h.cantidad() << ","
+                 << h.promedio_ns() / 1e6 << ","
+                 << h.percentil_ms(50) << ","
+                 << h.percentil_ms(90) << ","
+                 << h.percentil_ms(99) << ","
+                 << h.percentil_ms(99.9) << ","
+                 << h.maximo() / 1e6 << "\n";
+        }
+    }
+    
+    file.close();
+    cout << "Latencia por banda guardada en: " << archivo << endl;
+}
+
 void generar_reporte_html(const ComparacionRendimiento& comp, const string& archivo) {
     ofstream file(archivo);
     
@@ -231,6 +559,9 @@ void generar_reporte_html(const ComparacionRendimiento& comp, const string& arch
     file << "<li><strong>Algoritmo mas rapido:</strong> " << comp.algoritmo_mas_rapido << "</li>\n";
     file << "<li><strong>Mejor uso de memoria:</strong> " << comp.algoritmo_mejor_memoria << "</li>\n";
     file << "<li><strong>Mejor calidad:</strong> " << comp.algoritmo_mejor_calidad << "</li>\n";
+    if (comp.duracion_s > 0) {
+        file << "<li><strong>QPS total:</strong> " << fixed << setprecision(1) << comp.qps_total << "</li>\n";
+    }
     file << "</ul>\n";
     
     file << "<h2>Estadisticas Detalladas</h2>\n";
@@ -249,7 +580,101 @@ void generar_reporte_html(const ComparacionRendimiento& comp, const string& arch
         file << "</tr>\n";
     }
     
-    file << "</table>\n</body>\n</html>";
+    file << "</table>\n";
+    
+    file << "<h2>Latencia (ms)</h2>\n";
+    file << "<table>\n<tr>\n";
+    file << "<th>Algoritmo</th><th>p50</th><th>p90</th><th>p99</th><th>p99.9</th>";
+    file << "<th>Maximo</th><th>QPS por hilo</th>\n</tr>\n";
+    
+    for (const auto& [nombre, stats] : comp.stats) {
+        file << "<tr>\n";
+        file << "<td>" << nombre << "</td>\n";
+        file << "<td>" << fixed << setprecision(3) << stats.tiempo_p50_ms << "</td>\n";
+        file << "<td>" << stats.tiempo_p90_ms << "</td>\n";
+        file << "<td>" << stats.tiempo_p99_ms << "</td>\n";
+        file << "<td>" << stats.tiempo_p999_ms << "</td>\n";
+        file << "<td>" << stats.tiempo_max_ms << "</td>\n";
+        file << "<td>" << setprecision(1) << stats.qps_por_hilo << "</td>\n";
+        file << "</tr>\n";
+    }
+    file << "</table>\n";
+    
+    if (!comp.nombres_bandas.empty()) {
+        file << "<h2>Latencia por Banda (ms)</h2>\n";
+        file << "<table>\n<tr>\n";
+        file << "<th>Algoritmo</th><th>Banda</th><th>Consultas</th><th>Promedio</th>";
+        file << "<th>p50</th><th>p90</th><th>p99</th><th>Maximo</th>\n</tr>\n";
+        
+        for (const auto& [nombre, bandas] : comp.latencias_por_banda) {
+            for (size_t b = 0; b < bandas.size() && b < comp.nombres_bandas.size(); ++b) {
+                const HistogramaLatencia& h = bandas[b];
+                if (h.cantidad() == 0) continue;
+                file << "<tr>\n";
+                file << "<td>" << nombre << "</td>\n";
+                file << "<td>" << comp.nombres_bandas[b] << "</td>\n";
+                file << "<td>" << h.cantidad() << "</td>\n";
+                file << "<td>" << fixed << setprecision(3) << h.promedio_ns() / 1e6 << "</td>\n";
+                file << "<td>" << h.percentil_ms(50) << "</td>\n";
+                file << "<td>" << h.percentil_ms(90) << "</td>\n";
+                file << "<td>" << h.percentil_ms(99) << "</td>\n";
+                file << "<td>" << h.maximo() / 1e6 << "</td>\n";
+                file << "</tr>\n";
+            }
+        }
+        file << "</table>\n";
+    }
+    
+    if (comp.hardware_activo) {
+        file << "<h2>Contadores de Hardware (promedio por consulta)</h2>\n";
+        file << "<table>\n<tr>\n";
+        file << "<th>Algoritmo</th><th>Ciclos</th><th>Instrucciones</th><th>IPC</th>";
+        file << "<th>Fallos L1d</th><th>Fallos LLC</th><th>Fallos dTLB</th><th>Saltos fallidos</th>";
+        file << "<th>L1d / nodo</th><th>LLC / nodo</th><th>dTLB / nodo</th><th>Saltos / nodo</th>\n</tr>\n";
+        
+        for (const auto& [nombre, stats] : comp.stats) {
+            file << "<tr>\n";
+            file << "<td>" << nombre << "</td>\n";
+            file << "<td>" << fixed << setprecision(0) << stats.ciclos_prom << "</td>\n";
+            file << "<td>" << stats.instrucciones_prom << "</td>\n";
+            file << "<td>" << setprecision(2) << stats.ipc << "</td>\n";
+            file << "<td>" << setprecision(0) << stats.l1d_fallos_prom << "</td>\n";
+            file << "<td>" << stats.llc_fallos_prom << "</td>\n";
+            file << "<td>" << stats.dtlb_fallos_prom << "</td>\n";
+            file << "<td>" << stats.saltos_fallidos_prom << "</td>\n";
+            file << "<td>" << setprecision(3) << stats.l1d_por_nodo << "</td>\n";
+            file << "<td>" << stats.llc_por_nodo << "</td>\n";
+            file << "<td>" << stats.dtlb_por_nodo << "</td>\n";
+            file << "<td>" << stats.saltos_por_nodo << "</td>\n";
+            file << "</tr>\n";
+        }
+        file << "</table>\n";
+    }
+    
+    if (comp.contadores_activos) {
+        file << "<h2>Trabajo por Consulta</h2>\n";
+        file << "<table>\n<tr>\n";
+        file << "<th>Algoritmo</th><th>Nodos asentados</th><th>Extracciones obsoletas</th>";
+        file << "<th>Aristas revisadas</th><th>Relajaciones</th><th>Inserciones en cola</th>";
+        file << "<th>Pico de cola</th><th>ns / nodo asentado</th><th>ns / relajacion</th>\n</tr>\n";
+        
+        for (const auto& [nombre, stats] : comp.stats) {
+            file << "<tr>\n";
+            file << "<td>" << nombre << "</td>\n";
+            file << "<td>" << fixed << setprecision(1) << (stats.nodos_extraidos_prom - stats.extracciones_obsoletas_prom) << "</td>\n";
+            file << "<td>" << stats.extracciones_obsoletas_prom << "</td>\n";
+            file << "<td>" << stats.aristas_revisadas_prom << "</td>\n";
+            file << "<td>" << stats.relajaciones_prom << "</td>\n";
+            file << "<td>" << stats.inserciones_cola_prom << "</td>\n";
+            file << "<td>" << stats.pico_cola_max << "</td>\n";
+            file << "<td>" << stats.ns_por_nodo_asentado << "</td>\n";
+            file << "<td>" << stats.ns_por_relajacion << "</td>\n";
+            file << "</tr>\n";
+        }
+        file << "</table>\n";
+    }
+    
+    file << "</body>\n</html>";
     file.close();
     
     cout << "Reporte HTML generado: " << archivo << endl;
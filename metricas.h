@@ -2,6 +2,9 @@
 #include <vector>
 #include <string>
 #include <map>
+#include "contadores_busqueda.h"
+#include "histograma_latencia.h"
+#include "contadores_hardware.h"
 
 // Estructura para pruebas de rendimiento
 struct PruebaRendimiento {
@@ -11,7 +14,11 @@ struct PruebaRendimiento {
     double tiempo_ms;
     int longitud_camino;
     double memoria_mb;
+    size_t asignaciones = 0;         // Llamadas al asignador global durante la busqueda
     bool encontro_camino;
+    int banda = -1;                  // Banda del conjunto de consultas (-1 = sin estratificar)
+    ContadoresBusqueda contadores;   // Ceros si no se compilo con CONTADORES_BUSQUEDA
+    LecturaHardware hardware;        // Invalida si no se pidio --perf o el kernel no lo permite
 };
 
 // Estructura para estadísticas por algoritmo
@@ -22,6 +29,13 @@ struct EstadisticasAlgoritmo {
     double tiempo_max_ms;
     double tiempo_desv_std;
     
+    // Cola de la distribucion de latencias (HistogramaLatencia)
+    double tiempo_p50_ms;
+    double tiempo_p90_ms;
+    double tiempo_p99_ms;
+    double tiempo_p999_ms;
+    double qps_por_hilo;               // Consultas / tiempo de busqueda acumulado
+    
     double memoria_promedio_mb;
     double memoria_max_mb;
     
@@ -32,6 +46,32 @@ struct EstadisticasAlgoritmo {
     double longitud_promedio;
     double longitud_min;
     double longitud_max;
+    
+    // Trabajo por consulta (promedios de ContadoresBusqueda)
+    double nodos_extraidos_prom;
+    double extracciones_obsoletas_prom;
+    double aristas_revisadas_prom;
+    double relajaciones_prom;
+    double inserciones_cola_prom;
+    double pico_cola_prom;
+    double pico_cola_max;
+    
+    // Costo por unidad de trabajo
+    double ns_por_nodo_asentado;
+    double ns_por_relajacion;
+    
+    // Contadores de hardware (promedios por consulta y por nodo asentado)
+    double ciclos_prom;
+    double instrucciones_prom;
+    double ipc;
+    double l1d_fallos_prom;
+    double llc_fallos_prom;
+    double dtlb_fallos_prom;
+    double saltos_fallidos_prom;
+    double l1d_por_nodo;
+    double llc_por_nodo;
+    double dtlb_por_nodo;
+    double saltos_por_nodo;
 };
 
 // Estructura para comparación de algoritmos
@@ -41,17 +81,37 @@ struct ComparacionRendimiento {
     std::string algoritmo_mas_lento;
     std::string algoritmo_mejor_memoria;
     std::string algoritmo_mejor_calidad;
+    bool contadores_activos = false;   // Algun resultado trae contadores de trabajo
+    bool hardware_activo = false;      // Algun resultado trae contadores de hardware
+    
+    std::map<std::string, HistogramaLatencia> latencias;
+    double duracion_s = 0;             // Tiempo de pared de la corrida (0 = desconocido)
+    double qps_total = 0;              // Consultas de todos los algoritmos / duracion_s
+    
+    // Latencia por banda de consultas (rango de Dijkstra o distancia), si las hay
+    std::vector<std::string> nombres_bandas;
+    std::map<std::string, std::vector<HistogramaLatencia>> latencias_por_banda;
 };
 
+// Latencias registradas por cada hilo, un histograma por algoritmo
+using LatenciasPorAlgoritmo = std::map<std::string, HistogramaLatencia>;
+
 // Funciones de análisis
 void analizar_resultados(const std::vector<PruebaRendimiento>& resultados, int num_pruebas);
+void analizar_resultados(const ComparacionRendimiento& comp, size_t total_pruebas, int num_pruebas);
 ComparacionRendimiento calcular_estadisticas(const std::vector<PruebaRendimiento>& resultados);
+// Reemplaza los percentiles con los histogramas de los hilos (resolucion en ns) y calcula QPS
+void aplicar_latencias(ComparacionRendimiento& comp, const std::vector<LatenciasPorAlgoritmo>& por_hilo,
+                       double duracion_s);
 void mostrar_resumen_ejecutivo(const ComparacionRendimiento& comp);
 void mostrar_estadisticas_detalladas(const ComparacionRendimiento& comp);
+void mostrar_latencia_por_banda(const ComparacionRendimiento& comp);
 
 // Funciones de exportación
 void guardar_resultados_csv(const std::vector<PruebaRendimiento>& resultados, 
                            const std::string& archivo);
+void guardar_estadisticas_csv(const ComparacionRendimiento& comp, const std::string& archivo);
+void guardar_latencia_por_banda_csv(const ComparacionRendimiento& comp, const std::string& archivo);
 void generar_reporte_html(const ComparacionRendimiento& comp, 
                          const std::string& archivo);
 
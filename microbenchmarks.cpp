@@ -0,0 +1,328 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <random>
+#include <queue>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include "estructuras_grandes.h"
+#include "grafo_grande.h"
+
+using namespace std;
+using namespace chrono;
+
+// Microbenchmarks de estructuras_grandes.h y de los nucleos de las busquedas.
+//
+// Cada caso se repite varias veces despues de unas repeticiones de calentamiento,
+// y se reporta ns/op (promedio, desviacion estandar, minimo y mediana entre
+// repeticiones). Las trazas de cola de prioridad se graban de corridas reales de
+// Dijkstra sobre la malla, asi que el patron de inserciones/extracciones es el
+// de produccion. Un cambio en una estructura se evalua en segundos, sin la
+// corrida completa de make benchmark.
+
+struct ConfiguracionMicro {
+    int repeticiones = 15;
+    int calentamiento = 3;
+    int consultas_traza = 8;
+    int max_asentados = 1 << 18;     // Corta cada Dijkstra de la traza (consultas de rango <= 2^18)
+    uint32_t semilla = SEMILLA_GRAFO_DEFECTO;
+    string snapshot;
+    string filtro;
+};
+
+struct ResultadoMicro {
+    string nombre;
+    size_t ops;
+    double promedio_ns;
+    double desv_ns;
+    double minimo_ns;
+    double mediana_ns;
+};
+
+// Evita que el compilador elimine el trabajo medido
+static volatile uint64_t sumidero;
+
+static vector<ResultadoMicro> resultados_micro;
+
+template<typename Funcion>
+static void medir(const ConfiguracionMicro& config, const string& nombre, size_t ops, Funcion funcion) {
+    if (!config.filtro.empty() && nombre.find(config.filtro) == string::npos) return;
+
+    for (int r = 0; r < config.calentamiento; ++r) {
+        sumidero = funcion();
+    }
+
+    vector<double> ns_por_op;
+    for (int r = 0; r < config.repeticiones; ++r) {
+        auto inicio = steady_clock::now();
+        sumidero = funcion();
+        auto fin = steady_clock::now();
+        ns_por_op.push_back(duration_cast<nanoseconds>(fin - inicio).count() / (double)ops);
+    }
+
+    ResultadoMicro res;
+    res.nombre = nombre;
+    res.ops = ops;
+    double suma = 0;
+    for (double v : ns_por_op) suma += v;
+    res.promedio_ns = suma / ns_por_op.size();
+    double cuadrados = 0;
+    for (double v : ns_por_op) cuadrados += (v - res.promedio_ns) * (v - res.promedio_ns);
+    res.desv_ns = sqrt(cuadrados / ns_por_op.size());
+    sort(ns_por_op.begin(), ns_por_op.end());
+    res.minimo_ns = ns_por_op.front();
+    res.mediana_ns = ns_por_op[ns_por_op.size() / 2];
+
+    cout << left << setw(40) << res.nombre << right << fixed << setprecision(2)
+         << setw(12) << res.ops
+         << setw(10) << res.promedio_ns
+         << setw(10) << res.desv_ns
+         << setw(8) << setprecision(1) << (res.promedio_ns > 0 ? 100.0 * res.desv_ns / res.promedio_ns : 0.0) << "%"
+         << setw(10) << setprecision(2) << res.minimo_ns
+         << setw(10) << res.mediana_ns << endl;
+    resultados_micro.push_back(res);
+}
+
+// Operacion de una traza de cola de prioridad: id >= 0 inserta, EXTRAER o LIMPIAR
+// (fin de una consulta: la cola se vacia como al empezar la siguiente busqueda)
+const int OP_EXTRAER = -1;
+const int OP_LIMPIAR = -2;
+
+struct OperacionCola {
+    int id;
+    float prioridad;
+};
+
+// Dijkstra desde 'origen' (hasta max_asentados nodos) que graba las operaciones
+// sobre la cola y el orden en que se asientan los nodos.
+static void grabar_traza_dijkstra(const GrafoGrande& grafo, int origen, int max_asentados,
+                                  vector<OperacionCola>& traza, vector<int>& orden_asentados) {
+    int num_nodos = grafo.get_num_nodos_reales();
+    vector<float> distancia(num_nodos, numeric_limits<float>::infinity());
+    vector<char> asentado(num_nodos, 0);
+    ColaPrioridadGrande cola(capacidad_cola_grande(num_nodos));
+
+    distancia[origen] = 0;
+    cola.insertar(origen, 0);
+    traza.push_back({origen, 0});
+
+    int asentados = 0;
+    while (!cola.vacia() && asentados < max_asentados) {
+        int u = cola.extraer_min();
+        traza.push_back({OP_EXTRAER, 0});
+        if (asentado[u]) continue;
+        asentado[u] = 1;
+        asentados++;
+        orden_asentados.push_back(u);
+
+        for (IndiceArista i = grafo.get_offset_inicio(u); i < grafo.get_offset_fin(u); ++i) {
+            int v = grafo.get_vecino(i);
+            float nueva = distancia[u] + grafo.get_peso(i);
+            if (nueva < distancia[v]) {
+                distancia[v] = nueva;
+                cola.insertar(v, nueva);
+                traza.push_back({v, nueva});
+            }
+        }
+    }
+    traza.push_back({OP_LIMPIAR, 0});
+}
+
+static void mostrar_uso() {
+    cout << "Uso: micro_benchmark [--repeticiones N] [--calentamiento N] [--consultas N] [--max-asentados N]\n"
+         << "                      [--semilla N] [--snapshot ARCHIVO] [--filtro TEXTO]\n";
+}
+
+int main(int argc, char* argv[]) {
+    ConfiguracionMicro config;
+    for (int i = 1; i < argc; ++i) {
+        string opcion = argv[i];
+        bool hay_valor = i + 1 < argc;
+        if (opcion == "--repeticiones" && hay_valor) config.repeticiones = max(1, atoi(argv[++i]));
+        else if (opcion == "--calentamiento" && hay_valor) config.calentamiento = max(0, atoi(argv[++i]));
+        else if (opcion == "--consultas" && hay_valor) config.consultas_traza = max(1, atoi(argv[++i]));
+        else if (opcion == "--max-asentados" && hay_valor) config.max_asentados = max(1, atoi(argv[++i]));
+        else if (opcion == "--semilla" && hay_valor) config.semilla = strtoul(argv[++i], nullptr, 10);
+        else if (opcion == "--snapshot" && hay_valor) config.snapshot = argv[++i];
+        else if (opcion == "--filtro" && hay_valor) config.filtro = argv[++i];
+        else {
+            mostrar_uso();
+            return 1;
+        }
+    }
+
+    cout << "=== MICROBENCHMARKS ===" << endl;
+    unique_ptr<GrafoGrande> grafo_micro = config.snapshot.empty() ? generar_grafo_con_malla_obstaculos(config.semilla)
+                                                                  : cargar_grafo_desde_archivo(config.snapshot);
+    if (!grafo_micro) {
+        cerr << "Error al preparar el grafo" << endl;
+        return 1;
+    }
+    const GrafoGrande& grafo = *grafo_micro;
+
+    int num_nodos = grafo.get_num_nodos_reales();
+    int64_t num_aristas = grafo.contar_aristas();
+    mt19937 gen(config.semilla);
+    uniform_int_distribution<> nodo_dist(0, num_nodos - 1);
+
+    // Trazas reales: operaciones de cola y orden de asentamiento de varios Dijkstra
+    vector<OperacionCola> traza;
+    vector<int> orden_asentados;
+    for (int q = 0; q < config.consultas_traza; ++q) {
+        grabar_traza_dijkstra(grafo, nodo_dist(gen), config.max_asentados, traza, orden_asentados);
+    }
+    size_t inserciones = 0, pico = 0, vivos = 0;
+    for (const auto& op : traza) {
+        if (op.id >= 0) { inserciones++; vivos++; pico = max(pico, vivos); }
+        else if (op.id == OP_EXTRAER) vivos--;
+        else vivos = 0;
+    }
+    cout << "\nTraza: " << traza.size() << " operaciones (" << inserciones << " inserciones, pico "
+         << pico << "), " << orden_asentados.size() << " nodos asentados" << endl;
+    cout << "Repeticiones: " << config.repeticiones << " (+" << config.calentamiento << " de calentamiento)\n" << endl;
+
+    cout << left << setw(40) << "Caso" << right
+         << setw(12) << "ops/rep"
+         << setw(10) << "ns/op"
+         << setw(10) << "desv"
+         << setw(9) << "cv"
+         << setw(10) << "min"
+         << setw(10) << "mediana" << endl;
+    cout << string(101, '-') << endl;
+
+    // --- Colas de prioridad sobre la traza real ---
+    ColaPrioridadGrande heap(pico + 1);
+    medir(config, "ColaPrioridadGrande traza Dijkstra", traza.size(), [&]() {
+        uint64_t suma = 0;
+        heap.limpiar();
+        for (const auto& op : traza) {
+            if (op.id >= 0) heap.insertar(op.id, op.prioridad);
+            else if (op.id == OP_EXTRAER) suma += heap.extraer_min();
+            else heap.limpiar();
+        }
+        return suma;
+    });
+
+    medir(config, "std::priority_queue traza (referencia)", traza.size(), [&]() {
+        uint64_t suma = 0;
+        using Par = pair<float, int>;
+        priority_queue<Par, vector<Par>, greater<Par>> pq;
+        for (const auto& op : traza) {
+            if (op.id >= 0) pq.push({op.prioridad, op.id});
+            else if (op.id == OP_EXTRAER) { suma += pq.top().second; pq.pop(); }
+            else pq = decltype(pq)();
+        }
+        return suma;
+    });
+
+    // --- Cola y pila: rafagas de 'lote' operaciones como en un BFS/DFS ---
+    const int TOTAL_OPS = 1 << 22;
+    const int LOTE = 4096;
+    ColaGrande cola(LOTE + 1);
+    medir(config, "ColaGrande encolar+desencolar", 2 * (size_t)TOTAL_OPS, [&]() {
+        uint64_t suma = 0;
+        for (int base = 0; base < TOTAL_OPS; base += LOTE) {
+            for (int k = 0; k < LOTE; ++k) cola.encolar(base + k);
+            while (!cola.vacia()) suma += cola.desencolar();
+        }
+        return suma;
+    });
+
+    StackGrande pila(LOTE + 1);
+    medir(config, "StackGrande apilar+desapilar", 2 * (size_t)TOTAL_OPS, [&]() {
+        uint64_t suma = 0;
+        for (int base = 0; base < TOTAL_OPS; base += LOTE) {
+            for (int k = 0; k < LOTE; ++k) pila.apilar(base + k);
+            while (!pila.vacio()) suma += pila.desapilar();
+        }
+        return suma;
+    });
+
+    // --- Arena: reservas de 64 ints y restauracion al punto de control ---
+    const int TAM_POOL = 1 << 20;
+    const int POR_ARRAY = 64;
+    ArenaBusqueda arena;
+    medir(config, "Arena reservar (64 ints) + restaurar", (size_t)(TAM_POOL / POR_ARRAY), [&]() {
+        uint64_t suma = 0;
+        AlcanceArena alcance(arena);
+        for (int k = 0; k < TAM_POOL / POR_ARRAY; ++k) {
+            int* a = arena.reservar<int>(POR_ARRAY, alignof(int));
+            suma += (uintptr_t)a & 0xff;
+        }
+        return suma;
+    });
+
+    // --- Nucleo CSR: recorrido de vecinos ---
+    medir(config, "CSR scan secuencial (ns/arista)", num_aristas, [&]() {
+        double suma = 0;
+        for (int u = 0; u < num_nodos; ++u) {
+            for (IndiceArista i = grafo.get_offset_inicio(u); i < grafo.get_offset_fin(u); ++i) {
+                suma += grafo.get_peso(i) + grafo.get_vecino(i);
+            }
+        }
+        return (uint64_t)suma;
+    });
+
+    size_t aristas_en_orden = 0;
+    for (int u : orden_asentados) {
+        aristas_en_orden += grafo.get_offset_fin(u) - grafo.get_offset_inicio(u);
+    }
+
+    medir(config, "CSR scan orden Dijkstra (ns/arista)", aristas_en_orden, [&]() {
+        double suma = 0;
+        for (int u : orden_asentados) {
+            for (IndiceArista i = grafo.get_offset_inicio(u); i < grafo.get_offset_fin(u); ++i) {
+                suma += grafo.get_peso(i) + grafo.get_vecino(i);
+            }
+        }
+        return (uint64_t)suma;
+    });
+
+    // Relajacion sin cola: lectura de distancia del vecino, comparacion y escritura
+    vector<float> distancia(num_nodos);
+    vector<int> anterior(num_nodos);
+    medir(config, "Relajacion orden Dijkstra (ns/arista)", aristas_en_orden, [&]() {
+        fill(distancia.begin(), distancia.end(), numeric_limits<float>::infinity());
+        uint64_t mejoras = 0;
+        for (int u : orden_asentados) {
+            float du = distancia[u] == numeric_limits<float>::infinity() ? 0 : distancia[u];
+            for (IndiceArista i = grafo.get_offset_inicio(u); i < grafo.get_offset_fin(u); ++i) {
+                int v = grafo.get_vecino(i);
+                float nueva = du + grafo.get_peso(i);
+                if (nueva < distancia[v]) {
+                    distancia[v] = nueva;
+                    anterior[v] = u;
+                    mejoras++;
+                }
+            }
+        }
+        return mejoras;
+    });
+
+    // --- Heuristica de A* / Best First ---
+    const int NUM_HEURISTICAS = 1 << 22;
+    vector<int> nodos_azar(NUM_HEURISTICAS);
+    for (int& v : nodos_azar) v = nodo_dist(gen);
+    int destino = nodo_dist(gen);
+
+    medir(config, "heuristica_grande nodos al azar", NUM_HEURISTICAS, [&]() {
+        double suma = 0;
+        for (int v : nodos_azar) suma += heuristica_grande(grafo, v, destino);
+        return (uint64_t)suma;
+    });
+
+    medir(config, "heuristica_grande orden Dijkstra", orden_asentados.size(), [&]() {
+        double suma = 0;
+        for (int v : orden_asentados) suma += heuristica_grande(grafo, v, destino);
+        return (uint64_t)suma;
+    });
+
+    if (resultados_micro.empty()) {
+        cout << "Ningun caso coincide con el filtro '" << config.filtro << "'" << endl;
+    }
+    return 0;
+}
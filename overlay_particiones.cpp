@@ -0,0 +1,758 @@
+#include "overlay_particiones.h"
+#include "estructuras_grandes.h"
+#include "contadores_busqueda.h"
+#include "memoria.h"
+#include "arena.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <cmath>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+using namespace std;
+using namespace chrono;
+
+static const float INFINITO_OVERLAY = numeric_limits<float>::infinity();
+
+namespace {
+
+// Un nivel del estado de la consulta: las ranuras de los nodos frontera, con
+// un sello por celda. La primera vez que la consulta toca una celda se
+// reinician sus ranuras, asi las distancias no necesitan sello propio y la
+// fila de la clique se compara contra ellas sin mirar nada mas.
+struct EstadoNivelCRP {
+    vector<uint32_t> sello_celda;
+    vector<float> distancia;
+    vector<int> anterior;                // Id en la cola del nodo previo
+    vector<char> visitado;
+    vector<char> por_clique;             // 1 = se llego por la clique de la celda
+};
+
+// Estado de una consulta, por hilo y reutilizado entre consultas. Los sellos
+// de generacion evitan reiniciar arreglos del tamano del grafo: una consulta
+// cuesta lo que los nodos y celdas que toca, como en hpa_malla.cpp. La cola
+// tambien se conserva (limpiar() es O(1)).
+struct EspacioCRP {
+    uint32_t generacion = 0;
+    vector<uint32_t> sello;              // Nivel 0 (nodos del grafo): == generacion si es valido
+    vector<float> distancia;
+    vector<int> anterior;
+    vector<char> visitado;
+    vector<EstadoNivelCRP> niveles;
+    unique_ptr<ColaPrioridadGrande> cola;
+    int capacidad_cola = 0;
+
+    void nueva_busqueda(int n, const vector<NivelOverlay>& niveles_overlay) {
+        if ((int)sello.size() < n) {
+            sello.resize(n, 0);
+            distancia.resize(n);
+            anterior.resize(n);
+            visitado.resize(n);
+        }
+        if (niveles.size() < niveles_overlay.size()) niveles.resize(niveles_overlay.size());
+        for (size_t l = 0; l < niveles_overlay.size(); ++l) {
+            EstadoNivelCRP& e = niveles[l];
+            const NivelOverlay& nv = niveles_overlay[l];
+            if ((int)e.sello_celda.size() < nv.num_celdas) e.sello_celda.resize(nv.num_celdas, 0);
+            size_t ranuras = nv.nodo_de_ranura.size();
+            if (e.distancia.size() < ranuras) {
+                e.distancia.resize(ranuras);
+                e.anterior.resize(ranuras);
+                e.visitado.resize(ranuras);
+                e.por_clique.resize(ranuras);
+            }
+        }
+        if (++generacion == 0) {
+            fill(sello.begin(), sello.end(), 0);
+            for (EstadoNivelCRP& e : niveles) fill(e.sello_celda.begin(), e.sello_celda.end(), 0);
+            generacion = 1;
+        }
+        if (capacidad_cola < capacidad_cola_grande(n)) {
+            capacidad_cola = capacidad_cola_grande(n);
+            cola = make_unique<ColaPrioridadGrande>(capacidad_cola);
+        }
+        cola->limpiar();
+    }
+
+    // Ranuras de la celda listas para esta consulta
+    void tocar_celda(int nivel, const NivelOverlay& nv, int celda) {
+        EstadoNivelCRP& e = niveles[nivel];
+        if (e.sello_celda[celda] == generacion) return;
+        e.sello_celda[celda] = generacion;
+        const int inicio = nv.inicio_ranura[celda], fin = nv.inicio_ranura[celda + 1];
+        fill(e.distancia.begin() + inicio, e.distancia.begin() + fin, INFINITO_OVERLAY);
+        fill(e.visitado.begin() + inicio, e.visitado.begin() + fin, 0);
+    }
+
+    float dist(int v) const { return sello[v] == generacion ? distancia[v] : INFINITO_OVERLAY; }
+    bool es_visitado(int v) const { return sello[v] == generacion && visitado[v]; }
+    void poner(int v, float d, int ant) {
+        if (sello[v] != generacion) {
+            sello[v] = generacion;
+            visitado[v] = 0;
+        }
+        distancia[v] = d;
+        anterior[v] = ant;
+    }
+};
+
+thread_local EspacioCRP espacio_crp;
+
+} // namespace
+
+void LiberadorAlineado::operator()(float* ptr) const {
+    free(ptr);
+}
+
+OverlayParticiones::OverlayParticiones(const GrafoGrande& g) : grafo(&g) {}
+
+bool OverlayParticiones::construir(const vector<int>& tam_celdas) {
+    int num_nodos = grafo->get_num_nodos_reales();
+    if (num_nodos == 0 || tam_celdas.empty()) {
+        return false;
+    }
+
+    auto inicio = high_resolution_clock::now();
+
+    niveles.clear();
+    niveles.resize(tam_celdas.size());
+    for (size_t l = 0; l < tam_celdas.size(); ++l) {
+        niveles[l].tam_max_celda = tam_celdas[l];
+        niveles[l].num_celdas = 0;
+        niveles[l].celda_de_nodo.assign(num_nodos, -1);
+        niveles[l].total_floats = 0;
+    }
+
+    // 1. Particion recursiva por coordenadas (biseccion en la mediana)
+    cout << "Particionando " << num_nodos << " nodos en " << niveles.size() << " niveles..." << endl;
+    orden.resize(num_nodos);
+    for (int i = 0; i < num_nodos; ++i) orden[i] = i;
+
+    vector<float> clave(num_nodos);
+    particionar(0, num_nodos, niveles.size() - 1, clave);
+
+    posicion.resize(num_nodos);
+    for (int i = 0; i < num_nodos; ++i) posicion[orden[i]] = i;
+
+    // 2. Nodos frontera y reserva de matrices por nivel
+    for (auto& nivel : niveles) {
+        nivel.inicio_celda.push_back(num_nodos);
+        calcular_fronteras(nivel);
+        reservar_matrices(nivel);
+    }
+
+    // Ids de la cola: los nodos y despues las ranuras de cada nivel (la ultima
+    // entrada cierra el rango del nivel mas alto)
+    primer_id.assign(niveles.size() + 2, 0);
+    primer_id[1] = num_nodos;
+    for (size_t l = 0; l < niveles.size(); ++l) {
+        primer_id[l + 2] = primer_id[l + 1] + (int)niveles[l].nodo_de_ranura.size();
+    }
+
+    // 3. Customizacion: matrices frontera-frontera
+    customizar();
+
+    auto fin = high_resolution_clock::now();
+    cout << "Overlay construido en " << duration_cast<milliseconds>(fin - inicio).count() << " ms" << endl;
+    mostrar_estadisticas();
+
+    return true;
+}
+
+void OverlayParticiones::particionar(int inicio, int fin, int nivel, vector<float>& clave) {
+    int tam = fin - inicio;
+
+    if (tam > niveles[nivel].tam_max_celda) {
+        // Cortar por la dimension de mayor extension
+        float min_x = INFINITO_OVERLAY, max_x = -INFINITO_OVERLAY;
+        float min_y = INFINITO_OVERLAY, max_y = -INFINITO_OVERLAY;
+        for (int i = inicio; i < fin; ++i) {
+            float x = grafo->get_pos_x(orden[i]);
+            float y = grafo->get_pos_y(orden[i]);
+            min_x = min(min_x, x); max_x = max(max_x, x);
+            min_y = min(min_y, y); max_y = max(max_y, y);
+        }
+
+        bool por_x = (max_x - min_x) >= (max_y - min_y);
+        for (int i = inicio; i < fin; ++i) {
+            clave[orden[i]] = por_x ? grafo->get_pos_x(orden[i]) : grafo->get_pos_y(orden[i]);
+        }
+
+        int medio = inicio + tam / 2;
+        nth_element(orden.begin() + inicio, orden.begin() + medio, orden.begin() + fin,
+                    [&clave](int a, int b) {
+                        return clave[a] < clave[b] || (clave[a] == clave[b] && a < b);
+                    });
+
+        particionar(inicio, medio, nivel, clave);
+        particionar(medio, fin, nivel, clave);
+        return;
+    }
+
+    // Hoja de este nivel: nueva celda
+    NivelOverlay& nv = niveles[nivel];
+    int celda = nv.num_celdas++;
+    nv.inicio_celda.push_back(inicio);
+    for (int i = inicio; i < fin; ++i) {
+        nv.celda_de_nodo[orden[i]] = celda;
+    }
+
+    // Las celdas del nivel inferior subdividen esta celda
+    if (nivel > 0) {
+        particionar(inicio, fin, nivel - 1, clave);
+    }
+}
+
+void OverlayParticiones::calcular_fronteras(NivelOverlay& nivel) {
+    int num_nodos = grafo->get_num_nodos_reales();
+    vector<char> es_frontera(num_nodos, 0);
+
+    // Un nodo es frontera si tiene una arista (entrante o saliente) que cruza de celda
+    for (int u = 0; u < num_nodos; ++u) {
+        int cu = nivel.celda_de_nodo[u];
+        IndiceArista inicio = grafo->get_offset_inicio(u);
+        IndiceArista fin = grafo->get_offset_fin(u);
+        for (IndiceArista i = inicio; i < fin; ++i) {
+            int w = grafo->get_vecino(i);
+            if (nivel.celda_de_nodo[w] != cu) {
+                es_frontera[u] = 1;
+                es_frontera[w] = 1;
+            }
+        }
+    }
+
+    nivel.indice_frontera.assign(num_nodos, -1);
+    nivel.inicio_frontera.assign(nivel.num_celdas + 1, 0);
+    nivel.nodos_frontera.clear();
+
+    for (int c = 0; c < nivel.num_celdas; ++c) {
+        nivel.inicio_frontera[c] = nivel.nodos_frontera.size();
+        for (int i = nivel.inicio_celda[c]; i < nivel.inicio_celda[c + 1]; ++i) {
+            int v = orden[i];
+            if (es_frontera[v]) {
+                nivel.indice_frontera[v] = nivel.nodos_frontera.size() - nivel.inicio_frontera[c];
+                nivel.nodos_frontera.push_back(v);
+            }
+        }
+    }
+    nivel.inicio_frontera[nivel.num_celdas] = nivel.nodos_frontera.size();
+}
+
+void OverlayParticiones::reservar_matrices(NivelOverlay& nivel) {
+    nivel.inicio_matriz.assign(nivel.num_celdas + 1, 0);
+    nivel.paso_fila.assign(nivel.num_celdas, 0);
+    nivel.inicio_ranura.assign(nivel.num_celdas + 1, 0);
+
+    // Cada fila empieza alineada: el paso se redondea al ancho del tile. Las
+    // ranuras de la consulta siguen el mismo paso (el relleno queda en -1).
+    size_t total = 0;
+    int ranuras = 0;
+    for (int c = 0; c < nivel.num_celdas; ++c) {
+        int b = nivel.inicio_frontera[c + 1] - nivel.inicio_frontera[c];
+        int paso = (b + OVERLAY_ANCHO_TILE - 1) / OVERLAY_ANCHO_TILE * OVERLAY_ANCHO_TILE;
+        nivel.paso_fila[c] = paso;
+        nivel.inicio_matriz[c] = total;
+        nivel.inicio_ranura[c] = ranuras;
+        total += (size_t)b * paso;
+        ranuras += paso;
+    }
+    nivel.inicio_matriz[nivel.num_celdas] = total;
+    nivel.inicio_ranura[nivel.num_celdas] = ranuras;
+    nivel.nodo_de_ranura.assign(ranuras, -1);
+    for (int c = 0; c < nivel.num_celdas; ++c) {
+        for (int k = nivel.inicio_frontera[c]; k < nivel.inicio_frontera[c + 1]; ++k) {
+            nivel.nodo_de_ranura[nivel.inicio_ranura[c] + k - nivel.inicio_frontera[c]] = nivel.nodos_frontera[k];
+        }
+    }
+    nivel.total_floats = total;
+
+    size_t bytes = max<size_t>(total * sizeof(float), OVERLAY_ALINEACION);
+    bytes = (bytes + OVERLAY_ALINEACION - 1) / OVERLAY_ALINEACION * OVERLAY_ALINEACION;
+    float* memoria = static_cast<float*>(aligned_alloc(OVERLAY_ALINEACION, bytes));
+    if (!memoria) {
+        throw bad_alloc();
+    }
+    nivel.matrices.reset(memoria);
+    fill(memoria, memoria + total, INFINITO_OVERLAY);
+}
+
+// Arreglos de trabajo de la customizacion, por hilo: la celda se copia a un
+// CSR local (ids 0..tam-1) y todos los Dijkstra de sus nodos frontera corren
+// sobre esa copia, sin tocar los arreglos globales del grafo
+struct EspacioCustomizacion {
+    vector<float> distancia;
+    vector<char> asentado;
+    vector<int> toque;
+    vector<int> inicio;                  // CSR local de la celda
+    vector<int> vecino;
+    vector<float> peso;
+    vector<int> columna;                 // Indice de frontera de cada nodo local (-1 = interior)
+
+    explicit EspacioCustomizacion(int tam_max)
+        : distancia(tam_max, INFINITO_OVERLAY), asentado(tam_max, 0), inicio(tam_max + 1), columna(tam_max) {
+        toque.reserve(tam_max);
+    }
+};
+
+void OverlayParticiones::customizar() {
+    for (size_t l = 0; l < niveles.size(); ++l) {
+        auto inicio = high_resolution_clock::now();
+        NivelOverlay& nv = niveles[l];
+
+        int tam_max = 0;
+        for (int c = 0; c < nv.num_celdas; ++c) {
+            tam_max = max(tam_max, nv.inicio_celda[c + 1] - nv.inicio_celda[c]);
+        }
+
+        #pragma omp parallel
+        {
+            EspacioCustomizacion espacio(tam_max);
+
+            #pragma omp for schedule(dynamic, 1)
+            for (int c = 0; c < nv.num_celdas; ++c) {
+                customizar_celda(l, c, espacio);
+            }
+        }
+
+        auto fin = high_resolution_clock::now();
+        cout << "Nivel " << (l + 1) << " customizado: " << nv.num_celdas << " celdas en "
+             << duration_cast<milliseconds>(fin - inicio).count() << " ms" << endl;
+    }
+}
+
+void OverlayParticiones::recustomizar_celdas(const vector<int>& nodos_modificados) {
+    const int num_nodos = grafo->get_num_nodos_reales();
+    for (size_t l = 0; l < niveles.size(); ++l) {
+        NivelOverlay& nv = niveles[l];
+
+        vector<int> celdas;
+        for (int v : nodos_modificados) {
+            if (v >= 0 && v < num_nodos) celdas.push_back(nv.celda_de_nodo[v]);
+        }
+        sort(celdas.begin(), celdas.end());
+        celdas.erase(unique(celdas.begin(), celdas.end()), celdas.end());
+
+        int tam_max = 0;
+        for (int c : celdas) {
+            tam_max = max(tam_max, nv.inicio_celda[c + 1] - nv.inicio_celda[c]);
+        }
+
+        #pragma omp parallel
+        {
+            EspacioCustomizacion espacio(tam_max);
+
+            #pragma omp for schedule(dynamic, 1)
+            for (int k = 0; k < (int)celdas.size(); ++k) {
+                customizar_celda(l, celdas[k], espacio);
+            }
+        }
+    }
+}
+
+// Dijkstra restringido a la celda desde cada nodo frontera, sobre la copia
+// local de la celda. Se detiene en cuanto todos los nodos frontera de la
+// celda quedan asentados.
+void OverlayParticiones::customizar_celda(int nivel, int celda, EspacioCustomizacion& espacio) {
+    NivelOverlay& nv = niveles[nivel];
+    int base = nv.inicio_celda[celda];
+    int tam = nv.inicio_celda[celda + 1] - base;
+    int inicio_fr = nv.inicio_frontera[celda];
+    int b = nv.inicio_frontera[celda + 1] - inicio_fr;
+    if (b == 0) return;
+
+    // CSR local: solo las aristas que quedan dentro de la celda
+    vector<int>& inicio_local = espacio.inicio;
+    espacio.vecino.clear();
+    espacio.peso.clear();
+    for (int i = 0; i < tam; ++i) {
+        int nodo = orden[base + i];
+        inicio_local[i] = espacio.vecino.size();
+        espacio.columna[i] = nv.indice_frontera[nodo];
+        for (IndiceArista k = grafo->get_offset_inicio(nodo); k < grafo->get_offset_fin(nodo); ++k) {
+            int w = grafo->get_vecino(k);
+            if (nv.celda_de_nodo[w] != celda) continue;
+            espacio.vecino.push_back(posicion[w] - base);
+            espacio.peso.push_back(grafo->get_peso(k));
+        }
+    }
+    inicio_local[tam] = espacio.vecino.size();
+    const int* vecino = espacio.vecino.data();
+    const float* peso = espacio.peso.data();
+    const int* columna = espacio.columna.data();
+    float* distancia = espacio.distancia.data();
+    char* asentado = espacio.asentado.data();
+    vector<int>& toque = espacio.toque;
+    ColaPrioridadGrande cola(inicio_local[tam] + 1);
+
+    float* matriz = nv.matrices.get() + nv.inicio_matriz[celda];
+    int paso = nv.paso_fila[celda];
+
+    for (int i = 0; i < b; ++i) {
+        int origen_local = posicion[nv.nodos_frontera[inicio_fr + i]] - base;
+        float* fila = matriz + (size_t)i * paso;
+        fill(fila, fila + b, INFINITO_OVERLAY);
+
+        cola.limpiar();
+        distancia[origen_local] = 0.0f;
+        toque.push_back(origen_local);
+        cola.insertar(origen_local, 0.0f);
+
+        int fronteras_pendientes = b;
+        while (!cola.vacia() && fronteras_pendientes > 0) {
+            int actual = cola.extraer_min();
+            if (asentado[actual]) continue;
+            asentado[actual] = 1;
+            const float d = distancia[actual];
+            if (columna[actual] >= 0) {
+                fila[columna[actual]] = d;
+                fronteras_pendientes--;
+            }
+
+            for (int k = inicio_local[actual]; k < inicio_local[actual + 1]; ++k) {
+                int local = vecino[k];
+                float nueva = d + peso[k];
+                if (!asentado[local] && nueva < distancia[local]) {
+                    if (distancia[local] == INFINITO_OVERLAY) toque.push_back(local);
+                    distancia[local] = nueva;
+                    cola.insertar(local, nueva);
+                }
+            }
+        }
+
+        for (int local : toque) {
+            distancia[local] = INFINITO_OVERLAY;
+            asentado[local] = 0;
+        }
+        toque.clear();
+    }
+}
+
+// Nivel en que se escanea un nodo: el mas alto en que su celda no contiene
+// ni al origen ni al destino (0 = aristas originales).
+int OverlayParticiones::nivel_consulta(int nodo, int origen, int destino) const {
+    for (int l = niveles.size() - 1; l >= 0; --l) {
+        const vector<int>& celda = niveles[l].celda_de_nodo;
+        if (celda[nodo] != celda[origen] && celda[nodo] != celda[destino]) {
+            return l + 1;
+        }
+    }
+    return 0;
+}
+
+void OverlayParticiones::buscar(int origen, int destino, ResultadoRuta& ruta) const {
+    CONTAR_REINICIAR();
+    ruta.reiniciar();
+    const int num_nodos = grafo->get_num_nodos_reales();
+    if (!grafo->puede_alcanzar(origen, destino)) {
+        return;
+    }
+
+    // Distancias, padres y cola en el espacio del hilo (sin reiniciar todo el
+    // grafo); el camino desempaquetado usa la arena del hilo
+    ArenaBusqueda& arena = arena_del_hilo();
+    AlcanceArena alcance(arena);
+    EspacioCRP& espacio = espacio_crp;
+    espacio.nueva_busqueda(num_nodos, niveles);
+    ColaPrioridadGrande& pq = *espacio.cola;
+
+    const float factor = grafo->factor_heuristica();
+    const float destino_x = grafo->get_pos_x(destino), destino_y = grafo->get_pos_y(destino);
+    auto h = [&](int v) {
+        float dx = grafo->get_pos_x(v) - destino_x, dy = grafo->get_pos_y(v) - destino_y;
+        return factor * sqrtf(dx * dx + dy * dy);
+    };
+
+    // Llega a v por una arista original desde el id 'previo'. Los nodos que se
+    // escanean en un nivel > 0 son frontera en ese nivel: una arista que no
+    // cruza de celda en ese nivel sale de un nodo que se escanea en el mismo
+    // nivel, y esas se reemplazan por la clique.
+    auto llegar = [&](int v, float nueva, int previo) {
+        const int nivel = nivel_consulta(v, origen, destino);
+        if (nivel == 0) {
+            if (espacio.es_visitado(v) || nueva >= espacio.dist(v)) return;
+            espacio.poner(v, nueva, previo);
+            pq.insertar(v, nueva + h(v));
+        } else {
+            const NivelOverlay& nv = niveles[nivel - 1];
+            const int celda = nv.celda_de_nodo[v];
+            espacio.tocar_celda(nivel - 1, nv, celda);
+            EstadoNivelCRP& e = espacio.niveles[nivel - 1];
+            const int r = nv.inicio_ranura[celda] + nv.indice_frontera[v];
+            if (e.visitado[r] || nueva >= e.distancia[r]) return;
+            e.distancia[r] = nueva;
+            e.anterior[r] = previo;
+            e.por_clique[r] = 0;
+            pq.insertar(primer_id[nivel] + r, nueva + h(v));
+        }
+        CONTAR(relajaciones);
+        CONTAR(inserciones_cola);
+        CONTAR_MAX(pico_cola, pq.tamano());
+    };
+
+    espacio.poner(origen, 0.0f, -1);
+    pq.insertar(origen, h(origen));
+    CONTAR(inserciones_cola);
+
+    bool encontrado = false, agotado = false;
+    int asentados = 0;
+
+    while (!pq.vacia()) {
+        const int id = pq.extraer_min();
+        CONTAR(nodos_extraidos);
+        int nivel = 0;
+        while (nivel < (int)niveles.size() && id >= primer_id[nivel + 1]) nivel++;
+
+        int actual, ranura = -1;
+        float d;
+        if (nivel == 0) {
+            actual = id;
+            if (espacio.visitado[actual]) {
+                CONTAR(extracciones_obsoletas);
+                continue;
+            }
+            d = espacio.distancia[actual];
+        } else {
+            ranura = id - primer_id[nivel];
+            EstadoNivelCRP& e = espacio.niveles[nivel - 1];
+            if (e.visitado[ranura]) {
+                CONTAR(extracciones_obsoletas);
+                continue;
+            }
+            actual = niveles[nivel - 1].nodo_de_ranura[ranura];
+            d = e.distancia[ranura];
+        }
+        if (ruta.presupuesto_agotado(asentados)) {
+            agotado = true;
+            break;
+        }
+        if (nivel == 0) espacio.visitado[actual] = 1;
+        else espacio.niveles[nivel - 1].visitado[ranura] = 1;
+        asentados++;
+
+        if (actual == destino) {
+            encontrado = true;
+            break;
+        }
+
+        // Aristas originales: todas en el nivel 0, solo las que salen de la celda en otro caso
+        const NivelOverlay* nv = nivel > 0 ? &niveles[nivel - 1] : nullptr;
+        const int celda = nv ? nv->celda_de_nodo[actual] : -1;
+        IndiceArista inicio = grafo->get_offset_inicio(actual);
+        IndiceArista fin = grafo->get_offset_fin(actual);
+        CONTAR_N(aristas_revisadas, fin - inicio);
+        for (IndiceArista i = inicio; i < fin; ++i) {
+            int vecino = grafo->get_vecino(i);
+            if (nv && nv->celda_de_nodo[vecino] == celda) continue;
+            llegar(vecino, d + grafo->get_peso(i), id);
+        }
+        if (!nv) continue;
+
+        // Atajos de la clique de la celda: la fila y las distancias de sus
+        // destinos son contiguas; solo las mejoras se miran una por una
+        EstadoNivelCRP& e = espacio.niveles[nivel - 1];
+        const int primera = nv->inicio_ranura[celda];
+        const int paso = nv->paso_fila[celda];
+        const float* fila = nv->matrices.get() + nv->inicio_matriz[celda] +
+                            (size_t)nv->indice_frontera[actual] * paso;
+        float* distancia = e.distancia.data() + primera;
+        auto mejorar = [&](int j) {
+            const int r = primera + j;
+            if (e.visitado[r]) return;           // Solo por redondeo: ya tiene su distancia final
+            const float nueva = d + fila[j];
+            distancia[j] = nueva;
+            e.anterior[r] = id;
+            e.por_clique[r] = 1;
+            pq.insertar(primer_id[nivel] + r, nueva + h(nv->nodo_de_ranura[r]));
+            CONTAR(relajaciones);
+            CONTAR(inserciones_cola);
+            CONTAR_MAX(pico_cola, pq.tamano());
+        };
+        CONTAR_N(aristas_revisadas, nv->inicio_frontera[celda + 1] - nv->inicio_frontera[celda]);
+#ifdef __AVX2__
+        const __m256 base = _mm256_set1_ps(d);
+        for (int j = 0; j < paso; j += 8) {
+            __m256 nueva = _mm256_add_ps(base, _mm256_load_ps(fila + j));
+            int mascara = _mm256_movemask_ps(_mm256_cmp_ps(nueva, _mm256_loadu_ps(distancia + j), _CMP_LT_OQ));
+            while (mascara) {
+                mejorar(j + __builtin_ctz(mascara));
+                mascara &= mascara - 1;
+            }
+        }
+#else
+        for (int j = 0; j < paso; ++j) {
+            if (d + fila[j] < distancia[j]) mejorar(j);
+        }
+#endif
+    }
+
+    // Reconstruir camino desempaquetando los atajos
+    if (encontrado) {
+        // Ids de la cola desde el destino hasta el origen
+        auto previo_de = [&](int id) {
+            int nivel = 0;
+            while (nivel < (int)niveles.size() && id >= primer_id[nivel + 1]) nivel++;
+            return nivel == 0 ? espacio.anterior[id] : espacio.niveles[nivel - 1].anterior[id - primer_id[nivel]];
+        };
+        int num_overlay = 0;
+        for (int id = destino; id != -1; id = previo_de(id)) {
+            num_overlay++;
+        }
+        int* overlay = arena.reservar<int>(num_overlay);
+        int k = num_overlay;
+        for (int id = destino; id != -1; id = previo_de(id)) {
+            overlay[--k] = id;
+        }
+
+        *ruta.extender(1) = origen;
+        ruta.estado = EstadoRuta::ENCONTRADA;
+        ruta.costo = espacio.distancia[destino];
+        int anterior_nodo = origen;
+        for (k = 1; k < num_overlay; ++k) {
+            const int id = overlay[k];
+            int nivel = 0;
+            while (nivel < (int)niveles.size() && id >= primer_id[nivel + 1]) nivel++;
+            const int r = id - primer_id[nivel];
+            const int v = nivel == 0 ? id : niveles[nivel - 1].nodo_de_ranura[r];
+            if (nivel == 0 || !espacio.niveles[nivel - 1].por_clique[r]) {
+                *ruta.extender(1) = v;
+            } else if (!camino_en_celda(nivel - 1, anterior_nodo, v, arena, ruta)) {
+                ruta.reiniciar();
+                break;
+            }
+            anterior_nodo = v;
+        }
+    } else if (agotado) {
+        ruta.estado = EstadoRuta::PRESUPUESTO_AGOTADO;
+    }
+    ruta.nodos_asentados = asentados;
+
+    CONTAR_FIJAR(largo_camino, ruta.largo());
+}
+
+// Desempaqueta un atajo: camino minimo dentro de la celda que contiene a ambos
+// nodos (A* con la misma heuristica que la consulta). Agrega a la ruta los
+// nodos despues de 'desde' (hasta 'hasta' inclusive); false si no hay camino
+// en la celda.
+bool OverlayParticiones::camino_en_celda(int nivel, int desde, int hasta, ArenaBusqueda& arena, ResultadoRuta& ruta) const {
+    const NivelOverlay& nv = niveles[nivel];
+    int celda = nv.celda_de_nodo[desde];
+    int base = nv.inicio_celda[celda];
+    int tam = nv.inicio_celda[celda + 1] - base;
+
+    AlcanceArena alcance(arena);
+    float* distancia = arena.reservar<float>(tam);
+    int* anterior = arena.reservar<int>(tam);
+    char* asentado = arena.reservar<char>(tam);
+    for (int i = 0; i < tam; ++i) {
+        distancia[i] = INFINITO_OVERLAY;
+        anterior[i] = -1;
+        asentado[i] = 0;
+    }
+
+    int aristas_celda = 0;
+    for (int i = base; i < base + tam; ++i) {
+        aristas_celda += grafo->get_offset_fin(orden[i]) - grafo->get_offset_inicio(orden[i]);
+    }
+    ColaPrioridadGrande cola(aristas_celda + 1, &arena);
+
+    const float factor = grafo->factor_heuristica();
+    const float hasta_x = grafo->get_pos_x(hasta), hasta_y = grafo->get_pos_y(hasta);
+    auto h = [&](int v) {
+        float dx = grafo->get_pos_x(v) - hasta_x, dy = grafo->get_pos_y(v) - hasta_y;
+        return factor * sqrtf(dx * dx + dy * dy);
+    };
+
+    int origen_local = posicion[desde] - base;
+    int destino_local = posicion[hasta] - base;
+    distancia[origen_local] = 0.0f;
+    cola.insertar(origen_local, h(desde));
+
+    while (!cola.vacia()) {
+        int actual = cola.extraer_min();
+        if (asentado[actual]) continue;
+        asentado[actual] = 1;
+        if (actual == destino_local) break;
+
+        int nodo = orden[base + actual];
+        IndiceArista inicio = grafo->get_offset_inicio(nodo);
+        IndiceArista fin = grafo->get_offset_fin(nodo);
+        for (IndiceArista k = inicio; k < fin; ++k) {
+            int vecino = grafo->get_vecino(k);
+            if (nv.celda_de_nodo[vecino] != celda) continue;
+
+            int local = posicion[vecino] - base;
+            float nueva = distancia[actual] + grafo->get_peso(k);
+            if (!asentado[local] && nueva < distancia[local]) {
+                distancia[local] = nueva;
+                anterior[local] = actual;
+                cola.insertar(local, nueva + h(vecino));
+            }
+        }
+    }
+
+    if (!asentado[destino_local]) return false;
+
+    int agregados = 0;
+    for (int v = destino_local; v != origen_local; v = anterior[v]) {
+        agregados++;
+    }
+    int* salida = ruta.extender(agregados);
+    for (int v = destino_local; v != origen_local; v = anterior[v]) {
+        salida[--agregados] = orden[base + v];
+    }
+    return true;
+}
+
+size_t OverlayParticiones::memoria_usada() const {
+    size_t memoria = orden.size() * sizeof(int) + posicion.size() * sizeof(int);
+    for (const auto& nv : niveles) {
+        memoria += nv.celda_de_nodo.size() * sizeof(int);
+        memoria += nv.indice_frontera.size() * sizeof(int);
+        memoria += nv.inicio_celda.size() * sizeof(int);
+        memoria += nv.inicio_frontera.size() * sizeof(int);
+        memoria += nv.nodos_frontera.size() * sizeof(int);
+        memoria += nv.inicio_matriz.size() * sizeof(size_t);
+        memoria += nv.paso_fila.size() * sizeof(int);
+        memoria += nv.inicio_ranura.size() * sizeof(int);
+        memoria += nv.nodo_de_ranura.size() * sizeof(int);
+        memoria += nv.total_floats * sizeof(float);
+    }
+    return memoria;
+}
+
+void OverlayParticiones::mostrar_estadisticas() const {
+    cout << "\n=== ESTADISTICAS DEL OVERLAY ===" << endl;
+    cout << fixed << setprecision(2);
+    for (size_t l = 0; l < niveles.size(); ++l) {
+        const NivelOverlay& nv = niveles[l];
+        double fronteras_prom = nv.num_celdas > 0 ? (double)nv.nodos_frontera.size() / nv.num_celdas : 0.0;
+        cout << "Nivel " << (l + 1) << ": " << nv.num_celdas << " celdas (max " << nv.tam_max_celda << " nodos), "
+             << nv.nodos_frontera.size() << " nodos frontera (" << fronteras_prom << " por celda), "
+             << (nv.total_floats * sizeof(float) / 1024.0 / 1024.0) << " MB de matrices" << endl;
+    }
+    cout << "Memoria total del overlay: " << (memoria_usada() / 1024.0 / 1024.0) << " MB" << endl;
+}
+
+unique_ptr<OverlayParticiones> construir_overlay_particiones(const GrafoGrande& grafo) {
+    // Celdas de ~32x32 y ~128x128 sobre la malla
+    return construir_overlay_particiones(grafo, {1024, 16384});
+}
+
+unique_ptr<OverlayParticiones> construir_overlay_particiones(const GrafoGrande& grafo, const vector<int>& tam_celdas) {
+    cout << "=== CONSTRUYENDO OVERLAY MULTINIVEL (CRP) ===" << endl;
+    auto overlay = make_unique<OverlayParticiones>(grafo);
+    if (!overlay->construir(tam_celdas)) {
+        return nullptr;
+    }
+    return overlay;
+}
+
+void buscar_CRP_grande(const OverlayParticiones& overlay, int origen, int destino, ResultadoRuta& ruta) {
+    overlay.buscar(origen, destino, ruta);
+}
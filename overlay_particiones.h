@@ -0,0 +1,85 @@
+#pragma once
+#include "grafo_grande.h"
+#include "arena.h"
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+// Configuración del overlay multinivel (particion estilo CRP)
+constexpr int OVERLAY_ANCHO_TILE = 8;     // Floats por bloque de fila (32 bytes, un registro AVX)
+constexpr int OVERLAY_ALINEACION = 64;    // Alineacion de las matrices en bytes (linea de cache)
+
+// Memoria alineada para las matrices de clique
+struct LiberadorAlineado {
+    void operator()(float* ptr) const;
+};
+using BloqueAlineado = std::unique_ptr<float[], LiberadorAlineado>;
+
+// Un nivel de la particion. Las celdas de cada nivel son rangos contiguos
+// del orden de particion, asi que la celda de un nivel superior contiene
+// exactamente a las celdas del nivel inferior que caen en su rango.
+struct NivelOverlay {
+    int tam_max_celda;
+    int num_celdas;
+    std::vector<int> celda_de_nodo;      // Celda de cada nodo en este nivel
+    std::vector<int> indice_frontera;    // Posicion en la frontera de su celda (-1 si es interior)
+    std::vector<int> inicio_celda;       // Rango de cada celda dentro de 'orden'
+    std::vector<int> inicio_frontera;    // Nodos frontera de cada celda (formato CSR)
+    std::vector<int> nodos_frontera;
+    std::vector<size_t> inicio_matriz;   // Offset (en floats) de la matriz de cada celda
+    std::vector<int> paso_fila;          // Paso de fila, multiplo de OVERLAY_ANCHO_TILE
+    std::vector<int> inicio_ranura;      // Ranuras de la consulta: paso_fila por celda, en orden
+    std::vector<int> nodo_de_ranura;     // Nodo frontera de cada ranura (-1 = relleno)
+    BloqueAlineado matrices;             // Matrices frontera-frontera en tiles contiguos
+    size_t total_floats;
+};
+
+struct EspacioCustomizacion;
+
+// Overlay multinivel sobre GrafoGrande: particion recursiva por coordenadas
+// y matrices de distancias frontera-frontera por celda. Las consultas son un
+// A* (euclidiana por factor_heuristica, consistente tambien sobre las
+// cliques) que recorre aristas reales solo dentro de las celdas de origen y
+// destino y salta el resto del grafo con las cliques del nivel mas alto
+// posible. En cada nivel los nodos frontera de una celda ocupan ranuras
+// contiguas, asi una fila de la clique se relaja contra distancias contiguas
+// (8 por instruccion con AVX2).
+class OverlayParticiones {
+private:
+    const GrafoGrande* grafo;
+    std::vector<NivelOverlay> niveles;
+    std::vector<int> orden;              // Nodos ordenados por celda (todas las celdas son rangos)
+    std::vector<int> posicion;           // Inversa de 'orden'
+    std::vector<int> primer_id;          // Primer id en la cola de cada nivel (0 = nodos del grafo)
+
+    void particionar(int inicio, int fin, int nivel, std::vector<float>& clave);
+    void calcular_fronteras(NivelOverlay& nivel);
+    void reservar_matrices(NivelOverlay& nivel);
+    void customizar_celda(int nivel, int celda, EspacioCustomizacion& espacio);
+    int nivel_consulta(int nodo, int origen, int destino) const;
+    bool camino_en_celda(int nivel, int desde, int hasta, ArenaBusqueda& arena, ResultadoRuta& ruta) const;
+
+public:
+    explicit OverlayParticiones(const GrafoGrande& g);
+    ~OverlayParticiones() = default;
+
+    // Particion + customizacion. 'tam_celdas' va del nivel mas bajo al mas alto.
+    bool construir(const std::vector<int>& tam_celdas);
+    void customizar();
+    // Recalcula solo las celdas (de todos los niveles) que contienen nodos modificados
+    void recustomizar_celdas(const std::vector<int>& nodos_modificados);
+
+    void buscar(int origen, int destino, ResultadoRuta& ruta) const;
+
+    int get_num_niveles() const { return niveles.size(); }
+    size_t memoria_usada() const;
+    void mostrar_estadisticas() const;
+};
+
+// El overlay apunta al grafo sobre el que se construyo: ese grafo debe vivir
+// al menos lo mismo que el overlay (SnapshotGrafo publica ambos juntos).
+// Devuelven nullptr si la construccion falla.
+std::unique_ptr<OverlayParticiones> construir_overlay_particiones(const GrafoGrande& grafo);
+std::unique_ptr<OverlayParticiones> construir_overlay_particiones(const GrafoGrande& grafo,
+                                                                  const std::vector<int>& tam_celdas);
+void buscar_CRP_grande(const OverlayParticiones& overlay, int origen, int destino, ResultadoRuta& ruta);
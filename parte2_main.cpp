@@ -5,75 +5,110 @@
 #include <random>
 #include <fstream>
 #include <memory>
+#include <string>
+#include <cstdlib>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+#include <limits>
 #include "estructuras_grandes.h"
+#include "arena.h"
 #include "grafo_grande.h"
 #include "metricas.h"
+#include "overlay_particiones.h"
+#include "registro_grafos.h"
+#include "carga_trabajo.h"
+#include "contadores_hardware.h"
+#include "ubicacion_memoria.h"
+#include "rutas_alternativas.h"
+#include "isocronas.h"
+#include "instalaciones.h"
+#include "hpa_malla.h"
+#include "importador_json.h"
+#include "malla_implicita.h"
+#include "bfs_bits_malla.h"
 
 using namespace std;
 using namespace chrono;
 
-// Función para generar puntos de prueba aleatorios
-vector<pair<int, int>> generar_puntos_prueba(int cantidad, int max_nodos) {
-    vector<pair<int, int>> puntos;
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<> dis(0, max_nodos - 1);
-    
-    for (int i = 0; i < cantidad; ++i) {
-        int origen = dis(gen);
-        int destino = dis(gen);
-        while (destino == origen) {
-            destino = dis(gen);
-        }
-        puntos.push_back({origen, destino});
-    }
-    return puntos;
-}
-
 // Función para ejecutar pruebas en paralelo
-void ejecutar_pruebas_paralelas(const vector<pair<int, int>>& puntos_prueba,
+void ejecutar_pruebas_paralelas(const SnapshotGrafo& snapshot,
+                                const vector<ConsultaPrueba>& consultas,
+                                const vector<string>& algoritmos,
                                 vector<PruebaRendimiento>& resultados,
+                                LatenciasPorAlgoritmo& latencias,
+                                bool usar_perf, int cpu,
                                 int thread_id, int inicio, int fin) {
     
+    // Fijar el hilo antes de tocar memoria: con replicas, la vista del grafo
+    // que usa cada busqueda depende del nodo NUMA del hilo
+    if (cpu >= 0 && !fijar_hilo_a_cpu(cpu)) {
+        cerr << "Thread " << thread_id << ": no se pudo fijar a la CPU " << cpu << endl;
+    }
+    
+    // Contadores de hardware del hilo (perf_event_open); se abren en este hilo
+    unique_ptr<ContadoresHardware> hardware;
+    if (usar_perf) {
+        hardware = make_unique<ContadoresHardware>();
+    }
+    
+    // Histogramas propios del hilo (sin bloqueos); se combinan al terminar
+    vector<HistogramaLatencia*> histograma_de(algoritmos.size());
+    for (size_t a = 0; a < algoritmos.size(); ++a) {
+        histograma_de[a] = &latencias[algoritmos[a]];
+    }
+    
+    const GrafoGrande& grafo = *snapshot.grafo;
+    
+    // Buffer del camino propio del hilo: crece con las primeras rutas y se reutiliza
+    ResultadoRuta ruta;
+    
     for (int i = inicio; i < fin; ++i) {
-        int origen = puntos_prueba[i].first;
-        int destino = puntos_prueba[i].second;
+        int origen = consultas[i].origen;
+        int destino = consultas[i].destino;
         
         // Probar cada algoritmo
-        vector<string> algoritmos = {"BFS", "DFS", "BestFirst", "Dijkstra", "AStar"};
-        
         for (const string& algo : algoritmos) {
             PruebaRendimiento prueba;
             prueba.origen = origen;
             prueba.destino = destino;
+            prueba.banda = consultas[i].banda;
             prueba.algoritmo = algo;
             
-            int camino[MAX_NODES_LARGE];
-            int largo = 0;
-            
+            // Pico de memoria temporal de este hilo durante la busqueda
+            size_t marca_memoria = iniciar_medicion_memoria();
+            size_t asignaciones_antes = memoria_hilo.asignaciones;
+            if (hardware) hardware->iniciar();
             auto inicio_tiempo = high_resolution_clock::now();
-            double memoria_inicial = obtener_memoria_actual();
             
             // Ejecutar algoritmo correspondiente
             if (algo == "BFS") {
-                buscar_BFS_grande(origen, destino, camino, largo);
+                buscar_BFS_grande(grafo, origen, destino, ruta);
             } else if (algo == "DFS") {
-                buscar_DFS_grande(origen, destino, camino, largo);
+                buscar_DFS_grande(grafo, origen, destino, ruta);
             } else if (algo == "BestFirst") {
-                buscar_BestFirst_grande(origen, destino, camino, largo);
+                buscar_BestFirst_grande(grafo, origen, destino, ruta);
             } else if (algo == "Dijkstra") {
-                buscar_Dijkstra_grande(origen, destino, camino, largo);
+                buscar_Dijkstra_grande(grafo, origen, destino, ruta);
             } else if (algo == "AStar") {
-                buscar_AStar_grande(origen, destino, camino, largo);
+                buscar_AStar_grande(grafo, origen, destino, ruta);
+            } else if (algo == "CRP") {
+                buscar_CRP_grande(*snapshot.overlay, origen, destino, ruta);
             }
             
             auto fin_tiempo = high_resolution_clock::now();
-            double memoria_final = obtener_memoria_actual();
+            if (hardware) prueba.hardware = hardware->detener();
+            
+            uint64_t tiempo_ns = duration_cast<nanoseconds>(fin_tiempo - inicio_tiempo).count();
+            histograma_de[&algo - &algoritmos[0]]->registrar(tiempo_ns);
             
-            prueba.tiempo_ms = duration_cast<microseconds>(fin_tiempo - inicio_tiempo).count() / 1000.0;
-            prueba.longitud_camino = largo;
-            prueba.memoria_mb = memoria_final - memoria_inicial;
-            prueba.encontro_camino = (largo > 0);
+            prueba.tiempo_ms = tiempo_ns / 1e6;
+            prueba.longitud_camino = ruta.largo();
+            prueba.memoria_mb = bytes_pico_desde(marca_memoria) / 1024.0 / 1024.0;
+            prueba.asignaciones = memoria_hilo.asignaciones - asignaciones_antes;
+            prueba.encontro_camino = ruta.encontrada();
+            prueba.contadores = contadores_hilo;
             
             resultados[i * algoritmos.size() + (&algo - &algoritmos[0])] = prueba;
         }
@@ -85,72 +120,1061 @@ void ejecutar_pruebas_paralelas(const vector<pair<int, int>>& puntos_prueba,
     }
 }
 
-int main() {
+// Reparte las consultas entre latencias_por_hilo.size() hilos (fijados a 'cpus'
+// en orden circular si no esta vacio) y espera a que terminen. Devuelve el
+// tiempo de pared en ms.
+static double ejecutar_corrida(const SnapshotGrafo& snapshot,
+                               const vector<ConsultaPrueba>& consultas,
+                               const vector<string>& algoritmos,
+                               vector<PruebaRendimiento>& resultados,
+                               vector<LatenciasPorAlgoritmo>& latencias_por_hilo,
+                               bool usar_perf, const vector<int>& cpus) {
+    const int num_hilos = latencias_por_hilo.size();
+    const int num_pruebas = consultas.size();
+    auto inicio_pruebas = high_resolution_clock::now();
+    
+    vector<thread> threads;
+    int pruebas_por_thread = num_pruebas / num_hilos;
+    
+    for (int t = 0; t < num_hilos; ++t) {
+        int inicio = t * pruebas_por_thread;
+        int fin = (t == num_hilos - 1) ? num_pruebas : (t + 1) * pruebas_por_thread;
+        int cpu = cpus.empty() ? -1 : cpus[t % cpus.size()];
+        
+        threads.emplace_back(ejecutar_pruebas_paralelas, cref(snapshot),
+                           cref(consultas), cref(algoritmos), ref(resultados), ref(latencias_por_hilo[t]),
+                           usar_perf, cpu, t, inicio, fin);
+    }
+    
+    // Esperar a que terminen todos los threads
+    for (auto& t : threads) {
+        t.join();
+    }
+    
+    auto fin_pruebas = high_resolution_clock::now();
+    return duration_cast<microseconds>(fin_pruebas - inicio_pruebas).count() / 1000.0;
+}
+
+// Corre el mismo conjunto de consultas con el grafo ubicado de cada forma y
+// compara latencias y QPS. Deja el grafo con la ultima ubicacion probada.
+static void comparar_ubicaciones(GrafoGrande& grafo_mutable, const SnapshotGrafo& snapshot,
+                                 const vector<UbicacionGrafo>& ubicaciones,
+                                 const vector<ConsultaPrueba>& consultas,
+                                 const vector<string>& algoritmos,
+                                 int num_hilos, const vector<int>& cpus) {
+    ofstream csv("ubicaciones_parte2.csv");
+    csv << "Ubicacion,Algoritmo,Tiempo_Prom_ms,P50_ms,P99_ms,QPS_Hilo,QPS_Total\n";
+    
+    cout << "\n" << left << setw(22) << "Ubicacion" << setw(12) << "Algoritmo" << right
+         << setw(12) << "Prom(ms)" << setw(12) << "p50(ms)" << setw(12) << "p99(ms)"
+         << setw(12) << "QPS total" << endl;
+    for (const UbicacionGrafo& ubicacion : ubicaciones) {
+        if (!grafo_mutable.ubicar(ubicacion)) continue;
+        string nombre = nombre_ubicacion(grafo_mutable.get_ubicacion());
+        
+        vector<PruebaRendimiento> resultados(consultas.size() * algoritmos.size());
+        vector<LatenciasPorAlgoritmo> latencias_por_hilo(num_hilos);
+        double tiempo_ms = ejecutar_corrida(snapshot, consultas, algoritmos, resultados,
+                                            latencias_por_hilo, false, cpus);
+        ComparacionRendimiento comp = calcular_estadisticas(resultados);
+        aplicar_latencias(comp, latencias_por_hilo, tiempo_ms / 1000.0);
+        
+        for (const string& algo : algoritmos) {
+            const EstadisticasAlgoritmo& st = comp.stats.at(algo);
+            cout << left << setw(22) << nombre << setw(12) << algo << right << fixed << setprecision(3)
+                 << setw(12) << st.tiempo_promedio_ms << setw(12) << st.tiempo_p50_ms
+                 << setw(12) << st.tiempo_p99_ms << setprecision(1) << setw(12) << comp.qps_total << endl;
+            csv << nombre << "," << algo << "," << st.tiempo_promedio_ms << "," << st.tiempo_p50_ms << ","
+                << st.tiempo_p99_ms << "," << st.qps_por_hilo << "," << comp.qps_total << "\n";
+        }
+    }
+    cout << "Comparacion guardada en: ubicaciones_parte2.csv" << endl;
+}
+
+// Mide cuanto cuestan K rutas alternativas (Yen y plateaus) frente a una sola
+// consulta de Dijkstra, sobre las consultas que tienen ruta. Las consultas van
+// una por una; los metodos usan 'hilos' hilos cada uno.
+static void comparar_alternativas(const GrafoGrande& grafo, const vector<ConsultaPrueba>& consultas,
+                                  int k, int hilos) {
+    auto motor = construir_motor_alternativas(grafo);
+    if (!motor) {
+        cerr << "No se pudo construir el motor de rutas alternativas" << endl;
+        return;
+    }
+    OpcionesAlternativas opciones;
+    opciones.k = k;
+    opciones.hilos = hilos;
+    
+    const char* nombres[] = {"Dijkstra", "Yen", "Plateaus"};
+    double tiempo_ms[3] = {0, 0, 0}, rutas[3] = {0, 0, 0}, asentados[3] = {0, 0, 0}, estiramiento[3] = {0, 0, 0};
+    int con_ruta = 0;
+    ResultadoRuta ruta;
+    ConjuntoRutas conjunto;
+    for (const ConsultaPrueba& consulta : consultas) {
+        auto t0 = high_resolution_clock::now();
+        buscar_Dijkstra_grande(grafo, consulta.origen, consulta.destino, ruta);
+        auto t1 = high_resolution_clock::now();
+        if (!ruta.encontrada()) continue;
+        con_ruta++;
+        tiempo_ms[0] += duration_cast<nanoseconds>(t1 - t0).count() / 1e6;
+        rutas[0] += 1;
+        asentados[0] += ruta.nodos_asentados;
+        estiramiento[0] += 1.0;
+        
+        for (int m = 1; m <= 2; ++m) {
+            t0 = high_resolution_clock::now();
+            if (m == 1) motor->buscar_yen(consulta.origen, consulta.destino, opciones, conjunto);
+            else motor->buscar_plateaus(consulta.origen, consulta.destino, opciones, conjunto);
+            t1 = high_resolution_clock::now();
+            tiempo_ms[m] += duration_cast<nanoseconds>(t1 - t0).count() / 1e6;
+            rutas[m] += conjunto.cantidad();
+            asentados[m] += conjunto.nodos_asentados;
+            if (conjunto.cantidad() > 0) {
+                estiramiento[m] += conjunto.costo(conjunto.cantidad() - 1) / conjunto.costo(0);
+            }
+        }
+    }
+    if (con_ruta == 0) {
+        cout << "Ninguna consulta tiene ruta, no hay alternativas que medir" << endl;
+        return;
+    }
+    
+    ofstream csv("alternativas_parte2.csv");
+    csv << "Metodo,K,Hilos,Tiempo_Prom_ms,Relativo_Dijkstra,Rutas_Prom,Asentados_Prom,Estiramiento_Ultima\n";
+    cout << "\n" << left << setw(12) << "Metodo" << right << setw(12) << "Prom(ms)" << setw(14) << "x Dijkstra"
+         << setw(10) << "Rutas" << setw(14) << "Asentados" << setw(14) << "Estiramiento" << endl;
+    for (int m = 0; m < 3; ++m) {
+        double prom = tiempo_ms[m] / con_ruta;
+        double relativo = tiempo_ms[0] > 0 ? tiempo_ms[m] / tiempo_ms[0] : 0.0;
+        cout << left << setw(12) << nombres[m] << right << fixed << setprecision(3) << setw(12) << prom
+             << setprecision(2) << setw(14) << relativo << setw(10) << rutas[m] / con_ruta
+             << setprecision(0) << setw(14) << asentados[m] / con_ruta
+             << setprecision(3) << setw(14) << estiramiento[m] / con_ruta << endl;
+        csv << nombres[m] << "," << k << "," << hilos << "," << prom << "," << relativo << ","
+            << rutas[m] / con_ruta << "," << asentados[m] / con_ruta << "," << estiramiento[m] / con_ruta << "\n";
+    }
+    cout << "Alternativas guardadas en: alternativas_parte2.csv (" << con_ruta << " consultas con ruta)" << endl;
+}
+
+// Isocronas desde los origenes de las consultas: la cobertura en lote (un
+// origen por hilo) y, para el origen de la primera consulta, el motor
+// secuencial contra el paralelo con todos los hilos.
+static void medir_isocronas(const GrafoGrande& grafo, const vector<ConsultaPrueba>& consultas,
+                            const vector<float>& presupuestos, int hilos) {
+    OpcionesIsocrona opciones;
+    opciones.presupuestos = presupuestos;
+    opciones.hilos = hilos;
+    vector<int> origenes;
+    for (const ConsultaPrueba& consulta : consultas) origenes.push_back(consulta.origen);
+    
+    vector<ResultadoIsocrona> lote;
+    auto t0 = high_resolution_clock::now();
+    calcular_isocronas(grafo, origenes, opciones, lote);
+    auto t1 = high_resolution_clock::now();
+    double tiempo_lote_ms = duration_cast<nanoseconds>(t1 - t0).count() / 1e6;
+    
+    // Promedios por anillo
+    size_t num_anillos = lote.empty() ? 0 : lote[0].anillos.size();
+    vector<double> nodos(num_anillos, 0.0), vertices(num_anillos, 0.0), poligonos(num_anillos, 0.0);
+    for (const ResultadoIsocrona& r : lote) {
+        for (size_t a = 0; a < r.anillos.size() && a < num_anillos; ++a) {
+            nodos[a] += r.anillos[a].num_nodos;
+            poligonos[a] += r.anillos[a].contorno.size();
+            for (const auto& poligono : r.anillos[a].contorno) vertices[a] += poligono.size();
+        }
+    }
+    
+    // Un origen con ambos motores: umbral 0 fuerza el paralelo
+    ResultadoIsocrona secuencial, paralela;
+    OpcionesIsocrona una = opciones;
+    una.contornos = false;
+    una.hilos = 1;
+    t0 = high_resolution_clock::now();
+    calcular_isocrona(grafo, origenes.empty() ? 0 : origenes[0], una, secuencial);
+    t1 = high_resolution_clock::now();
+    double tiempo_secuencial_ms = duration_cast<nanoseconds>(t1 - t0).count() / 1e6;
+    una.hilos = hilos;
+    una.umbral_paralelo = 1;
+    t0 = high_resolution_clock::now();
+    calcular_isocrona(grafo, origenes.empty() ? 0 : origenes[0], una, paralela);
+    t1 = high_resolution_clock::now();
+    double tiempo_paralelo_ms = duration_cast<nanoseconds>(t1 - t0).count() / 1e6;
+    bool coinciden = secuencial.nodos.size() == paralela.nodos.size();
+    
+    ofstream csv("isocronas_parte2.csv");
+    csv << "Presupuesto,Origenes,Hilos,Nodos_Prom,Poligonos_Prom,Vertices_Prom\n";
+    cout << "\n" << right << setw(12) << "Presupuesto" << setw(14) << "Nodos" << setw(12) << "Poligonos"
+         << setw(12) << "Vertices" << endl;
+    double cantidad = max<size_t>(1, lote.size());
+    for (size_t a = 0; a < num_anillos; ++a) {
+        float presupuesto = lote[0].anillos[a].presupuesto;
+        cout << fixed << setprecision(1) << setw(12) << presupuesto << setprecision(0)
+             << setw(14) << nodos[a] / cantidad << setprecision(2) << setw(12) << poligonos[a] / cantidad
+             << setprecision(1) << setw(12) << vertices[a] / cantidad << endl;
+        csv << presupuesto << "," << lote.size() << "," << hilos << "," << nodos[a] / cantidad << ","
+            << poligonos[a] / cantidad << "," << vertices[a] / cantidad << "\n";
+    }
+    cout << "Lote de " << lote.size() << " isocronas: " << fixed << setprecision(2) << tiempo_lote_ms << " ms ("
+         << tiempo_lote_ms / cantidad << " ms por origen, " << hilos << " hilos)" << endl;
+    if (paralela.paralelo) {
+        cout << "Un origen: secuencial " << tiempo_secuencial_ms << " ms, paralelo " << tiempo_paralelo_ms
+             << " ms con " << hilos << " hilos (" << secuencial.nodos.size() << " nodos"
+             << (coinciden ? ", mismos nodos" : ", DISTINTA CANTIDAD DE NODOS") << ")" << endl;
+    } else {
+        cout << "Un origen: secuencial " << tiempo_secuencial_ms << " ms (el motor paralelo necesita mas de un hilo)"
+             << endl;
+    }
+    cout << "Isocronas guardadas en: isocronas_parte2.csv" << endl;
+}
+
+// Dijkstra completo desde 'nodo' sobre el transpuesto: distancia[v] es la de v
+// hasta 'nodo'. Devuelve los nodos asentados.
+static int distancias_hacia(const GrafoGrande& grafo, int nodo, vector<float>& distancia) {
+    VistaGrande inversa = grafo.vista_inversa();
+    const int n = inversa.num_nodos();
+    distancia.assign(n, numeric_limits<float>::infinity());
+    vector<char> asentado(n, 0);
+    ArenaBusqueda& arena = arena_del_hilo();
+    AlcanceArena alcance(arena);
+    ColaPrioridadGrande cola(capacidad_cola_grande(n), &arena);
+    int asentados = 0;
+    distancia[nodo] = 0.0f;
+    cola.insertar(nodo, 0.0f);
+    while (!cola.vacia()) {
+        int actual = cola.extraer_min();
+        if (asentado[actual]) continue;
+        asentado[actual] = 1;
+        asentados++;
+        inversa.para_cada_vecino(actual, [&](int vecino, float peso) {
+            float nueva = distancia[actual] + peso;
+            if (nueva < distancia[vecino]) {
+                distancia[vecino] = nueva;
+                cola.insertar(vecino, nueva);
+            }
+        });
+    }
+    return asentados;
+}
+
+// Instalacion mas cercana a cada origen de las consultas (el "incidente") entre
+// 'cantidad' instalaciones al azar: etiquetas precalculadas (O(1)), busqueda
+// inversa en consulta y, en pocos incidentes, un Dijkstra completo sobre el
+// transpuesto (minimo entre las instalaciones) como referencia.
+static void medir_instalaciones(const GrafoGrande& grafo, const vector<ConsultaPrueba>& consultas,
+                                int cantidad, uint32_t semilla, int hilos) {
+    // Otra secuencia que la de las consultas: con la misma semilla cada origen seria una instalacion
+    mt19937 gen(semilla ^ 0x9E3779B9u);
+    uniform_int_distribution<> dis(0, grafo.get_num_nodos_reales() - 1);
+    vector<int> nodos_instalaciones(cantidad);
+    for (int& v : nodos_instalaciones) v = dis(gen);
+    
+    auto t0 = high_resolution_clock::now();
+    auto secuencial = construir_indice_instalaciones(grafo, nodos_instalaciones, 1);
+    auto t1 = high_resolution_clock::now();
+    auto indice = construir_indice_instalaciones(grafo, nodos_instalaciones, hilos);
+    auto t2 = high_resolution_clock::now();
+    if (!secuencial || !indice) {
+        cerr << "No se pudo construir el indice de instalaciones" << endl;
+        return;
+    }
+    double construccion_ms[2] = { duration_cast<nanoseconds>(t1 - t0).count() / 1e6,
+                                  duration_cast<nanoseconds>(t2 - t1).count() / 1e6 };
+    int etiquetas_distintas = 0;
+    for (int v = 0; v < grafo.get_num_nodos_reales(); ++v) {
+        InstalacionCercana a = secuencial->mas_cercana(v), b = indice->mas_cercana(v);
+        if (a.instalacion != b.instalacion || a.distancia != b.distancia) etiquetas_distintas++;
+    }
+    
+    const int MAX_REFERENCIA = 5;              // Incidentes con la referencia completa
+    const char* nombres[] = {"Etiquetas", "Inversa", "Dijkstra total"};
+    double tiempo_ms[3] = {0, 0, 0}, asentados[3] = {0, 0, 0};
+    int incidentes[3] = {0, 0, 0}, discrepancias = 0;
+    // Las consultas O(1) se miden juntas: una sola es mas corta que el reloj
+    double suma = 0.0;
+    t0 = high_resolution_clock::now();
+    for (const ConsultaPrueba& consulta : consultas) {
+        suma += indice->mas_cercana(consulta.origen).distancia;
+    }
+    t1 = high_resolution_clock::now();
+    tiempo_ms[0] = duration_cast<nanoseconds>(t1 - t0).count() / 1e6;
+    incidentes[0] = consultas.size();
+    if (suma < 0) cout << suma << endl;        // Evita que el compilador descarte el lazo
+    
+    InstalacionCercana inversa;
+    vector<float> distancia;
+    for (size_t q = 0; q < consultas.size(); ++q) {
+        const int incidente = consultas[q].origen;
+        InstalacionCercana etiqueta = indice->mas_cercana(incidente);
+        t0 = high_resolution_clock::now();
+        indice->buscar_mas_cercana(incidente, inversa);
+        t1 = high_resolution_clock::now();
+        tiempo_ms[1] += duration_cast<nanoseconds>(t1 - t0).count() / 1e6;
+        asentados[1] += inversa.nodos_asentados;
+        incidentes[1]++;
+        if (etiqueta.instalacion >= 0 && fabs(etiqueta.distancia - inversa.distancia) > 1e-3f * max(1.0f, etiqueta.distancia)) {
+            discrepancias++;
+        }
+        
+        if (q >= MAX_REFERENCIA) continue;
+        float mejor = numeric_limits<float>::infinity();
+        t0 = high_resolution_clock::now();
+        asentados[2] += distancias_hacia(grafo, incidente, distancia);
+        for (int v : nodos_instalaciones) mejor = min(mejor, distancia[v]);
+        t1 = high_resolution_clock::now();
+        tiempo_ms[2] += duration_cast<nanoseconds>(t1 - t0).count() / 1e6;
+        incidentes[2]++;
+        if (etiqueta.instalacion >= 0 && fabs(etiqueta.distancia - mejor) > 1e-3f * max(1.0f, mejor)) {
+            discrepancias++;
+        }
+    }
+    
+    ofstream csv("instalaciones_parte2.csv");
+    csv << "Metodo,Instalaciones,Hilos,Incidentes,Tiempo_Prom_ms,Asentados_Prom\n";
+    cout << "\nConstruccion de etiquetas: " << fixed << setprecision(2) << construccion_ms[0] << " ms con 1 hilo, "
+         << construccion_ms[1] << " ms con " << hilos << " hilos"
+         << (etiquetas_distintas == 0 ? " (mismas etiquetas)" : " (ETIQUETAS DISTINTAS)") << endl;
+    cout << left << setw(16) << "Metodo" << right << setw(12) << "Incidentes" << setw(14) << "Prom(ms)"
+         << setw(14) << "Asentados" << endl;
+    for (int m = 0; m < 3; ++m) {
+        if (incidentes[m] == 0) continue;
+        double prom = tiempo_ms[m] / incidentes[m];
+        cout << left << setw(16) << nombres[m] << right << setw(12) << incidentes[m] << setprecision(6)
+             << setw(14) << prom << setprecision(0) << setw(14) << asentados[m] / incidentes[m] << endl;
+        csv << nombres[m] << "," << cantidad << "," << hilos << "," << incidentes[m] << "," << prom << ","
+            << asentados[m] / incidentes[m] << "\n";
+    }
+    csv << "Construccion_1_hilo," << cantidad << ",1,0," << construccion_ms[0] << ",0\n";
+    csv << "Construccion," << cantidad << "," << hilos << ",0," << construccion_ms[1] << ",0\n";
+    if (discrepancias > 0) {
+        cout << "ADVERTENCIA: " << discrepancias << " incidentes con distancias distintas entre metodos" << endl;
+    }
+    cout << "Instalaciones guardadas en: instalaciones_parte2.csv" << endl;
+}
+
+// HPA* frente a A* sobre la malla: tiempo, nodos asentados y sobrecosto de la
+// ruta respecto del optimo. Despues encarece las aristas alrededor de algunos origenes (celdas que
+// cambian), reconstruye solo los clusters tocados y repite la comparacion; al
+// final deja los pesos como estaban.
+static void medir_hpa(GrafoGrande& grafo, const vector<ConsultaPrueba>& consultas, int tam_cluster, int hilos) {
+    auto t0 = high_resolution_clock::now();
+    auto hpa = construir_abstraccion_hpa(grafo, tam_cluster, hilos);
+    auto t1 = high_resolution_clock::now();
+    if (!hpa) {
+        cerr << "No se pudo construir la abstraccion HPA* (requiere --malla)" << endl;
+        return;
+    }
+    double construccion_ms = duration_cast<nanoseconds>(t1 - t0).count() / 1e6;
+    
+    ofstream csv("hpa_parte2.csv");
+    csv << "Fase,Metodo,Tam_Cluster,Consultas,Tiempo_Prom_ms,Asentados_Prom,Sobrecosto_Prom,Sin_Ruta\n";
+    ResultadoRuta ruta;
+    auto comparar = [&](const char* fase) {
+        const char* nombres[] = {"AStar", "HPA*"};
+        double tiempo_ms[2] = {0, 0}, asentados[2] = {0, 0}, sobrecosto[2] = {0, 0};
+        int con_ruta = 0, sin_ruta_hpa = 0;
+        for (const ConsultaPrueba& consulta : consultas) {
+            // El optimo sale de Dijkstra: la heuristica de AStar no es admisible con pesos bajo la distancia
+            buscar_Dijkstra_grande(grafo, consulta.origen, consulta.destino, ruta);
+            if (!ruta.encontrada()) continue;
+            float optimo = ruta.costo;
+            t0 = high_resolution_clock::now();
+            buscar_AStar_grande(grafo, consulta.origen, consulta.destino, ruta);
+            t1 = high_resolution_clock::now();
+            con_ruta++;
+            tiempo_ms[0] += duration_cast<nanoseconds>(t1 - t0).count() / 1e6;
+            asentados[0] += ruta.nodos_asentados;
+            if (optimo > 0) sobrecosto[0] += ruta.costo / optimo - 1.0;
+            
+            t0 = high_resolution_clock::now();
+            hpa->buscar(consulta.origen, consulta.destino, ruta);
+            t1 = high_resolution_clock::now();
+            tiempo_ms[1] += duration_cast<nanoseconds>(t1 - t0).count() / 1e6;
+            asentados[1] += ruta.nodos_asentados;
+            if (!ruta.encontrada()) sin_ruta_hpa++;
+            else if (optimo > 0) sobrecosto[1] += ruta.costo / optimo - 1.0;
+        }
+        if (con_ruta == 0) {
+            cout << "Ninguna consulta tiene ruta" << endl;
+            return;
+        }
+        cout << "\n" << fase << ":" << endl;
+        cout << left << setw(10) << "Metodo" << right << setw(12) << "Prom(ms)" << setw(14) << "Asentados"
+             << setw(14) << "Sobrecosto" << setw(10) << "Sin ruta" << endl;
+        for (int m = 0; m < 2; ++m) {
+            double costo_extra = sobrecosto[m] / max(1, m == 0 ? con_ruta : con_ruta - sin_ruta_hpa);
+            int sin_ruta = m == 0 ? 0 : sin_ruta_hpa;
+            cout << left << setw(10) << nombres[m] << right << fixed << setprecision(3) << setw(12)
+                 << tiempo_ms[m] / con_ruta << setprecision(0) << setw(14) << asentados[m] / con_ruta
+                 << setprecision(2) << setw(13) << costo_extra * 100 << "%" << setw(10) << sin_ruta << endl;
+            csv << fase << "," << nombres[m] << "," << tam_cluster << "," << con_ruta << ","
+                << tiempo_ms[m] / con_ruta << "," << asentados[m] / con_ruta << "," << costo_extra << ","
+                << sin_ruta << "\n";
+        }
+    };
+    comparar("Inicial");
+    
+    // Celdas que cambian: las aristas que salen de un cuadrado de 5x5 nodos
+    // alrededor de cada origen cuestan 10 veces mas
+    vector<int> modificados;
+    vector<pair<IndiceArista, float>> pesos_previos;
+    VistaGrande vista = grafo.vista();
+    for (size_t q = 0; q < consultas.size() && q < 20; ++q) {
+        float cx = vista.x(consultas[q].origen), cy = vista.y(consultas[q].origen);
+        for (int v = 0; v < vista.num_nodos(); ++v) {
+            if (fabs(vista.x(v) - cx) > 2 || fabs(vista.y(v) - cy) > 2) continue;
+            modificados.push_back(v);
+            for (IndiceArista idx = grafo.get_offset_inicio(v); idx < grafo.get_offset_fin(v); ++idx) {
+                pesos_previos.push_back({idx, grafo.get_peso(idx)});
+                grafo.set_peso(idx, grafo.get_peso(idx) * 10.0f);
+            }
+        }
+    }
+    t0 = high_resolution_clock::now();
+    hpa->actualizar_clusters(modificados, hilos);
+    t1 = high_resolution_clock::now();
+    double actualizacion_ms = duration_cast<nanoseconds>(t1 - t0).count() / 1e6;
+    cout << "\nConstruccion completa: " << fixed << setprecision(2) << construccion_ms << " ms; "
+         << modificados.size() << " nodos modificados, clusters actualizados en " << actualizacion_ms << " ms" << endl;
+    csv << "Construccion,HPA*," << tam_cluster << ",0," << construccion_ms << ",0,0,0\n";
+    csv << "Actualizacion,HPA*," << tam_cluster << ",0," << actualizacion_ms << ",0,0,0\n";
+    comparar("Tras cambiar celdas");
+    
+    for (auto it = pesos_previos.rbegin(); it != pesos_previos.rend(); ++it) {
+        grafo.set_peso(it->first, it->second);
+    }
+    cout << "HPA* guardado en: hpa_parte2.csv" << endl;
+}
+
+// Recustomizacion del overlay CRP: encarece las aristas alrededor de algunos
+// origenes (como medir_hpa), recalcula solo las celdas tocadas y lo compara
+// con reconstruir el overlay completo. Las consultas de ambos se validan
+// contra Dijkstra; al final deja los pesos como estaban.
+static void medir_recustomizacion(GrafoGrande& grafo, const vector<ConsultaPrueba>& consultas) {
+    auto t0 = high_resolution_clock::now();
+    auto overlay = construir_overlay_particiones(grafo);
+    auto t1 = high_resolution_clock::now();
+    if (!overlay) {
+        cerr << "No se pudo construir el overlay para recustomizar" << endl;
+        return;
+    }
+    double construccion_ms = duration_cast<nanoseconds>(t1 - t0).count() / 1e6;
+    
+    // Celdas que cambian: las aristas que salen de un cuadrado de 5x5 nodos
+    // alrededor de cada origen cuestan 10 veces mas
+    vector<int> modificados;
+    vector<pair<IndiceArista, float>> pesos_previos;
+    VistaGrande vista = grafo.vista();
+    for (size_t q = 0; q < consultas.size() && q < 20; ++q) {
+        float cx = vista.x(consultas[q].origen), cy = vista.y(consultas[q].origen);
+        for (int v = 0; v < vista.num_nodos(); ++v) {
+            if (fabs(vista.x(v) - cx) > 2 || fabs(vista.y(v) - cy) > 2) continue;
+            modificados.push_back(v);
+            for (IndiceArista idx = grafo.get_offset_inicio(v); idx < grafo.get_offset_fin(v); ++idx) {
+                pesos_previos.push_back({idx, grafo.get_peso(idx)});
+                grafo.set_peso(idx, grafo.get_peso(idx) * 10.0f);
+            }
+        }
+    }
+    t0 = high_resolution_clock::now();
+    overlay->recustomizar_celdas(modificados);
+    t1 = high_resolution_clock::now();
+    double recustomizacion_ms = duration_cast<nanoseconds>(t1 - t0).count() / 1e6;
+    t0 = high_resolution_clock::now();
+    auto reconstruido = construir_overlay_particiones(grafo);
+    t1 = high_resolution_clock::now();
+    double reconstruccion_ms = duration_cast<nanoseconds>(t1 - t0).count() / 1e6;
+    
+    ofstream csv("recustomizacion_parte2.csv");
+    csv << "Fase,Metodo,Consultas,Tiempo_Prom_ms,Asentados_Prom,Costo_Distinto\n";
+    csv << "Construccion,CRP,0," << construccion_ms << ",0,0\n";
+    csv << "Recustomizacion,CRP," << modificados.size() << "," << recustomizacion_ms << ",0,0\n";
+    if (reconstruido) {
+        csv << "Reconstruccion,CRP,0," << reconstruccion_ms << ",0,0\n";
+    }
+    cout << "\nConstruccion completa: " << fixed << setprecision(2) << construccion_ms << " ms; "
+         << modificados.size() << " nodos modificados, celdas recustomizadas en " << recustomizacion_ms
+         << " ms, overlay reconstruido en " << reconstruccion_ms << " ms" << endl;
+    
+    const char* nombres[] = {"Dijkstra", "CRP recust.", "CRP reconstr."};
+    const OverlayParticiones* overlays[] = {nullptr, overlay.get(), reconstruido.get()};
+    double tiempo_ms[3] = {0, 0, 0}, asentados[3] = {0, 0, 0};
+    int distintos[3] = {0, 0, 0}, con_ruta = 0;
+    ResultadoRuta ruta;
+    for (const ConsultaPrueba& consulta : consultas) {
+        t0 = high_resolution_clock::now();
+        buscar_Dijkstra_grande(grafo, consulta.origen, consulta.destino, ruta);
+        t1 = high_resolution_clock::now();
+        if (!ruta.encontrada()) continue;
+        float optimo = ruta.costo;
+        con_ruta++;
+        tiempo_ms[0] += duration_cast<nanoseconds>(t1 - t0).count() / 1e6;
+        asentados[0] += ruta.nodos_asentados;
+        for (int m = 1; m < 3; ++m) {
+            if (!overlays[m]) continue;
+            t0 = high_resolution_clock::now();
+            overlays[m]->buscar(consulta.origen, consulta.destino, ruta);
+            t1 = high_resolution_clock::now();
+            tiempo_ms[m] += duration_cast<nanoseconds>(t1 - t0).count() / 1e6;
+            asentados[m] += ruta.nodos_asentados;
+            if (!ruta.encontrada() || fabs(ruta.costo - optimo) > 1e-4f * max(1.0f, optimo)) distintos[m]++;
+        }
+    }
+    if (con_ruta == 0) {
+        cout << "Ninguna consulta tiene ruta" << endl;
+    } else {
+        cout << left << setw(15) << "Metodo" << right << setw(12) << "Prom(ms)" << setw(14) << "Asentados"
+             << setw(16) << "Costo distinto" << endl;
+        for (int m = 0; m < 3; ++m) {
+            if (m > 0 && !overlays[m]) continue;
+            cout << left << setw(15) << nombres[m] << right << fixed << setprecision(3) << setw(12)
+                 << tiempo_ms[m] / con_ruta << setprecision(0) << setw(14) << asentados[m] / con_ruta
+                 << setw(16) << distintos[m] << endl;
+            csv << "Consultas," << nombres[m] << "," << con_ruta << "," << tiempo_ms[m] / con_ruta << ","
+                << asentados[m] / con_ruta << "," << distintos[m] << "\n";
+        }
+        if (distintos[1] > 0 || distintos[2] > 0) {
+            cout << "ADVERTENCIA: el overlay da costos distintos de Dijkstra" << endl;
+        }
+    }
+    
+    for (auto it = pesos_previos.rbegin(); it != pesos_previos.rend(); ++it) {
+        grafo.set_peso(it->first, it->second);
+    }
+    cout << "Recustomizacion guardada en: recustomizacion_parte2.csv" << endl;
+}
+
+// A* con cota sobre las consultas con ruta: para cada epsilon y variante,
+// nodos asentados, costo relativo al optimo (Dijkstra) y cota informada. El
+// CSV queda listo para graficar asentados y costo relativo contra epsilon.
+static void medir_epsilon(const GrafoGrande& grafo, const vector<ConsultaPrueba>& consultas,
+                          const vector<float>& epsilons, double plazo_ara_ms) {
+    ResultadoRuta ruta;
+    vector<pair<int, float>> optimos;         // (consulta, costo optimo)
+    double asentados_dijkstra = 0;
+    for (size_t q = 0; q < consultas.size(); ++q) {
+        buscar_Dijkstra_grande(grafo, consultas[q].origen, consultas[q].destino, ruta);
+        if (!ruta.encontrada()) continue;
+        optimos.push_back({(int)q, ruta.costo});
+        asentados_dijkstra += ruta.nodos_asentados;
+    }
+    if (optimos.empty()) {
+        cout << "Ninguna consulta tiene ruta" << endl;
+        return;
+    }
+    const double con_ruta = optimos.size();
+    cout << "Factor de la heuristica: " << fixed << setprecision(3) << grafo.factor_heuristica()
+         << "; Dijkstra asienta " << setprecision(0) << asentados_dijkstra / con_ruta << " nodos en promedio" << endl;
+    
+    ofstream csv("epsilon_parte2.csv");
+    csv << "Variante,Epsilon,Consultas,Tiempo_Prom_ms,Asentados_Prom,Costo_Relativo_Prom,Costo_Relativo_Max,"
+           "Cota_Prom,Fuera_De_Cota\n";
+    const pair<const char*, VarianteAStar> variantes[] = {
+        {"Ponderada", VarianteAStar::PONDERADA}, {"ARA*", VarianteAStar::ARA}, {"Focal", VarianteAStar::FOCAL}};
+    cout << left << setw(12) << "Variante" << right << setw(9) << "Epsilon" << setw(12) << "Prom(ms)"
+         << setw(12) << "Asentados" << setw(12) << "Costo rel" << setw(12) << "Max rel" << setw(10) << "Cota"
+         << setw(10) << "Fuera" << endl;
+    for (float epsilon : epsilons) {
+        for (const auto& variante : variantes) {
+            ModoAStar modo;
+            modo.variante = variante.second;
+            modo.epsilon = epsilon;
+            modo.epsilon_inicial = max(modo.epsilon_inicial, epsilon);
+            modo.plazo_ms = plazo_ara_ms;
+            double tiempo_ms = 0, asentados = 0, relativo = 0, relativo_max = 0, cota = 0;
+            int fuera = 0;
+            for (const auto& optimo : optimos) {
+                const ConsultaPrueba& consulta = consultas[optimo.first];
+                auto t0 = high_resolution_clock::now();
+                buscar_AStar_grande(grafo, consulta.origen, consulta.destino, ruta, modo);
+                auto t1 = high_resolution_clock::now();
+                tiempo_ms += duration_cast<nanoseconds>(t1 - t0).count() / 1e6;
+                asentados += ruta.nodos_asentados;
+                double r = optimo.second > 0 ? ruta.costo / optimo.second : 1.0;
+                relativo += r;
+                relativo_max = max(relativo_max, r);
+                cota += ruta.cota;
+                // Margen por el redondeo de sumar pesos en float en distinto orden
+                if (!ruta.encontrada() || r > ruta.cota * 1.0001) fuera++;
+            }
+            cout << left << setw(12) << variante.first << right << fixed << setprecision(2) << setw(9) << epsilon
+                 << setprecision(3) << setw(12) << tiempo_ms / con_ruta << setprecision(0) << setw(12)
+                 << asentados / con_ruta << setprecision(4) << setw(12) << relativo / con_ruta << setw(12)
+                 << relativo_max << setw(10) << cota / con_ruta << setw(10) << fuera << endl;
+            csv << variante.first << "," << epsilon << "," << optimos.size() << "," << tiempo_ms / con_ruta << ","
+                << asentados / con_ruta << "," << relativo / con_ruta << "," << relativo_max << ","
+                << cota / con_ruta << "," << fuera << "\n";
+        }
+    }
+    cout << "A* con cota guardado en: epsilon_parte2.csv" << endl;
+}
+
+// Grafo implicito sobre el mapa de bits de la malla frente al CSR, con las
+// mismas consultas: memoria, tiempo y nodos asentados. Con diagonales
+// parciales el grafo es el mismo, asi que Dijkstra debe dar el mismo costo; las
+// otras conectividades se comparan contra ese optimo.
+static void medir_malla_implicita(const GrafoGrande& grafo, const vector<ConsultaPrueba>& consultas,
+                                  uint32_t semilla, int lado) {
+    auto t0 = high_resolution_clock::now();
+    auto implicita = generar_malla_implicita(semilla, lado, lado);
+    auto t1 = high_resolution_clock::now();
+    if (!implicita || implicita->num_libres() != grafo.get_num_nodos_reales()) {
+        cerr << "La malla implicita no corresponde al grafo (requiere --malla)" << endl;
+        return;
+    }
+    cout << "Malla implicita: " << fixed << setprecision(2) << implicita->memoria_usada() / 1024.0 / 1024.0
+         << " MB (CSR: " << grafo.memoria_usada() / 1024.0 / 1024.0 << " MB), generada en "
+         << duration_cast<nanoseconds>(t1 - t0).count() / 1e6 << " ms" << endl;
+    
+    struct Metodo {
+        const char* nombre;
+        const char* grafo;
+        bool implicita;
+        bool heuristica;
+        Conectividad conectividad;
+    };
+    const Metodo metodos[] = {
+        {"Dijkstra", "CSR", false, false, Conectividad::DIAGONALES_PARCIALES},
+        {"AStar", "CSR", false, true, Conectividad::DIAGONALES_PARCIALES},
+        {"Dijkstra", "Implicita", true, false, Conectividad::DIAGONALES_PARCIALES},
+        {"AStar", "Implicita", true, true, Conectividad::DIAGONALES_PARCIALES},
+        {"AStar", "Implicita-4", true, true, Conectividad::CUATRO},
+        {"AStar", "Implicita-8", true, true, Conectividad::OCHO},
+    };
+    const int num_metodos = sizeof(metodos) / sizeof(metodos[0]);
+    vector<double> tiempo_ms(num_metodos, 0), asentados(num_metodos, 0), relativo(num_metodos, 0);
+    vector<int> distintos(num_metodos, 0);
+    int con_ruta = 0;
+    ResultadoRuta ruta;
+    for (const ConsultaPrueba& consulta : consultas) {
+        buscar_Dijkstra_grande(grafo, consulta.origen, consulta.destino, ruta);
+        if (!ruta.encontrada()) continue;
+        const float optimo = ruta.costo;
+        const int origen = implicita->celda_de_nodo(consulta.origen);
+        const int destino = implicita->celda_de_nodo(consulta.destino);
+        con_ruta++;
+        for (int m = 0; m < num_metodos; ++m) {
+            const Metodo& metodo = metodos[m];
+            t0 = high_resolution_clock::now();
+            if (!metodo.implicita && metodo.heuristica) {
+                buscar_AStar_grande(grafo, consulta.origen, consulta.destino, ruta);
+            } else if (!metodo.implicita) {
+                buscar_Dijkstra_grande(grafo, consulta.origen, consulta.destino, ruta);
+            } else if (metodo.heuristica) {
+                buscar_AStar_implicita(*implicita, metodo.conectividad, origen, destino, ruta);
+            } else {
+                buscar_Dijkstra_implicita(*implicita, metodo.conectividad, origen, destino, ruta);
+            }
+            t1 = high_resolution_clock::now();
+            tiempo_ms[m] += duration_cast<nanoseconds>(t1 - t0).count() / 1e6;
+            asentados[m] += ruta.nodos_asentados;
+            double r = optimo > 0 ? ruta.costo / optimo : 1.0;
+            relativo[m] += r;
+            // Mismo grafo: el costo debe coincidir (margen por sumar en float en otro orden)
+            bool mismo_grafo = metodo.conectividad == Conectividad::DIAGONALES_PARCIALES;
+            if (!ruta.encontrada() || (mismo_grafo && metodo.implicita && fabs(r - 1.0) > 1e-4)) distintos[m]++;
+        }
+    }
+    if (con_ruta == 0) {
+        cout << "Ninguna consulta tiene ruta" << endl;
+        return;
+    }
+    
+    ofstream csv("implicita_parte2.csv");
+    csv << "Metodo,Grafo,Consultas,Tiempo_Prom_ms,Asentados_Prom,Costo_Relativo_Prom,Distintos\n";
+    cout << left << setw(10) << "Metodo" << setw(13) << "Grafo" << right << setw(12) << "Prom(ms)"
+         << setw(12) << "Asentados" << setw(12) << "Costo rel" << setw(11) << "Distintos" << endl;
+    for (int m = 0; m < num_metodos; ++m) {
+        cout << left << setw(10) << metodos[m].nombre << setw(13) << metodos[m].grafo << right << fixed
+             << setprecision(3) << setw(12) << tiempo_ms[m] / con_ruta << setprecision(0) << setw(12)
+             << asentados[m] / con_ruta << setprecision(4) << setw(12) << relativo[m] / con_ruta
+             << setw(11) << distintos[m] << endl;
+        csv << metodos[m].nombre << "," << metodos[m].grafo << "," << con_ruta << "," << tiempo_ms[m] / con_ruta
+            << "," << asentados[m] / con_ruta << "," << relativo[m] / con_ruta << "," << distintos[m] << "\n";
+    }
+    cout << "Malla implicita guardada en: implicita_parte2.csv" << endl;
+}
+
+// BFS por saltos: el de la cola sobre el CSR frente al de mapas de bits, con las
+// mismas consultas (punto a punto y distancias desde el origen). Con
+// diagonales parciales los saltos deben coincidir con los del CSR.
+static void medir_bfs_bits(const GrafoGrande& grafo, const vector<ConsultaPrueba>& consultas,
+                           uint32_t semilla, int lado, int hilos) {
+    auto implicita = generar_malla_implicita(semilla, lado, lado);
+    if (!implicita || implicita->num_libres() != grafo.get_num_nodos_reales()) {
+        cerr << "La malla implicita no corresponde al grafo (requiere --malla)" << endl;
+        return;
+    }
+    BfsBitsMalla bfs(*implicita);
+    cout << "Mapas de bits: " << fixed << setprecision(2) << bfs.memoria_usada() / 1024.0 / 1024.0 << " MB, "
+         << hilos << " hilos" << endl;
+    
+    const char* nombres[] = {"BFS CSR", "Bits", "Bits-4", "Bits-8", "Bits distancias"};
+    const Conectividad conectividades[] = {Conectividad::DIAGONALES_PARCIALES, Conectividad::DIAGONALES_PARCIALES,
+                                           Conectividad::CUATRO, Conectividad::OCHO,
+                                           Conectividad::DIAGONALES_PARCIALES};
+    const int num_metodos = 5;
+    vector<double> tiempo_ms(num_metodos, 0), celdas(num_metodos, 0);
+    int distintos = 0;
+    vector<int> distancia((size_t)implicita->get_ancho() * implicita->get_alto());
+    ResultadoRuta ruta;
+    for (const ConsultaPrueba& consulta : consultas) {
+        const int origen = implicita->celda_de_nodo(consulta.origen);
+        const int destino = implicita->celda_de_nodo(consulta.destino);
+        auto t0 = high_resolution_clock::now();
+        buscar_BFS_grande(grafo, consulta.origen, consulta.destino, ruta);
+        auto t1 = high_resolution_clock::now();
+        tiempo_ms[0] += duration_cast<nanoseconds>(t1 - t0).count() / 1e6;
+        celdas[0] += ruta.nodos_asentados;
+        const int saltos_csr = ruta.encontrada() ? ruta.largo() - 1 : -1;
+        for (int m = 1; m < num_metodos; ++m) {
+            t0 = high_resolution_clock::now();
+            ResultadoBfsBits bits = m < 4 ? bfs.saltos(conectividades[m], origen, destino, hilos)
+                                          : bfs.distancias(conectividades[m], origen, distancia.data(), hilos);
+            t1 = high_resolution_clock::now();
+            tiempo_ms[m] += duration_cast<nanoseconds>(t1 - t0).count() / 1e6;
+            celdas[m] += bits.alcanzadas;
+            if (m == 1 && bits.saltos != saltos_csr) distintos++;
+            if (m == 4 && distancia[destino] != saltos_csr) distintos++;
+        }
+    }
+    
+    const double n = consultas.size();
+    ofstream csv("bfs_bits_parte2.csv");
+    csv << "Metodo,Consultas,Hilos,Tiempo_Prom_ms,Celdas_Prom,Aceleracion\n";
+    cout << left << setw(17) << "Metodo" << right << setw(12) << "Prom(ms)" << setw(12) << "Celdas"
+         << setw(12) << "Aceler." << endl;
+    for (int m = 0; m < num_metodos; ++m) {
+        double aceleracion = tiempo_ms[m] > 0 ? tiempo_ms[0] / tiempo_ms[m] : 0.0;
+        cout << left << setw(17) << nombres[m] << right << fixed << setprecision(3) << setw(12) << tiempo_ms[m] / n
+             << setprecision(0) << setw(12) << celdas[m] / n << setprecision(1) << setw(11) << aceleracion << "x"
+             << endl;
+        csv << nombres[m] << "," << consultas.size() << "," << hilos << "," << tiempo_ms[m] / n << ","
+            << celdas[m] / n << "," << aceleracion << "\n";
+    }
+    cout << "Saltos distintos de los del CSR: " << distintos << endl;
+    cout << "BFS de bits guardado en: bfs_bits_parte2.csv" << endl;
+}
+
+int main(int argc, char* argv[]) {
     cout << "=== PROYECTO RUTAS PARTE II: GRAFOS GRANDES ===" << endl;
     cout << "Iniciando pruebas de rendimiento..." << endl;
     
     // Configuración
-    const int NUM_PRUEBAS = 100;
+    int num_pruebas = 100;
     const int NUM_THREADS = thread::hardware_concurrency();
     
+    // Opciones: --malla usa el grafo con obstaculos, --crp agrega el overlay multinivel.
+    // Las consultas salen de semillas explicitas y pueden estratificarse por bandas.
+    bool usar_malla = false;
+    bool usar_crp = false;
+    bool usar_perf = false;
+    bool paginas_grandes = false;
+    bool fijar_hilos = false;
+    int alternativas = 0;                    // K rutas alternativas a medir (0 = no medir)
+    vector<float> presupuestos_isocrona;     // Anillos de isocrona a medir (vacio = no medir)
+    int instalaciones = 0;                   // Instalaciones para medir la mas cercana (0 = no medir)
+    int tam_cluster_hpa = 0;                 // Lado de los clusters de HPA* (0 = no medir)
+    vector<float> epsilons;                  // Cotas de A* a medir (vacio = no medir)
+    double plazo_ara_ms = 0.0;               // Plazo de ARA* en esa medicion (0 = sin plazo)
+    bool medir_implicita = false;            // Grafo implicito sobre la malla frente al CSR
+    bool medir_bits = false;                 // BFS de mapas de bits frente al del CSR
+    bool medir_recustomizar = false;         // Recustomizar celdas del overlay frente a reconstruirlo
+    UbicacionGrafo ubicacion;
+    vector<UbicacionGrafo> ubicaciones_comparar;
+    uint32_t semilla_grafo = SEMILLA_GRAFO_DEFECTO;
+    int64_t nodos_objetivo = 0;              // Tamano del grafo generado (0 = el por defecto)
+    uint32_t semilla_consultas = SEMILLA_CONSULTAS_DEFECTO;
+    CriterioConsultas criterio = CriterioConsultas::UNIFORME;
+    int por_banda = 20;
+    int banda_min = 4, banda_max = 0;        // 0 = hasta log2(nodos)
+    double distancia_base = 8.0;
+    int num_bandas = 8;
+    string archivo_guardar, archivo_cargar;
+    string archivo_json;                     // Grafo importado del JSON de calles (vacio = generarlo)
+    
+    for (int i = 1; i < argc; ++i) {
+        string opcion = argv[i];
+        bool hay_valor = i + 1 < argc;
+        if (opcion == "--malla") usar_malla = true;
+        else if (opcion == "--crp") usar_crp = true;
+        else if (opcion == "--importar" && hay_valor) archivo_json = argv[++i];
+        else if (opcion == "--perf") usar_perf = true;
+        else if (opcion == "--paginas-grandes") paginas_grandes = true;
+        else if (opcion == "--fijar-hilos") fijar_hilos = true;
+        else if (opcion == "--alternativas" && hay_valor) alternativas = max(1, atoi(argv[++i]));
+        else if (opcion == "--hpa" && hay_valor) tam_cluster_hpa = max(2, atoi(argv[++i]));
+        else if (opcion == "--implicita") medir_implicita = true;
+        else if (opcion == "--bfs-bits") medir_bits = true;
+        else if (opcion == "--recustomizar") medir_recustomizar = true;
+        else if (opcion == "--plazo-ara" && hay_valor) plazo_ara_ms = max(0.0, atof(argv[++i]));
+        else if (opcion == "--epsilon" && hay_valor) {
+            stringstream partes(argv[++i]);
+            string parte;
+            while (getline(partes, parte, ',')) epsilons.push_back(max(1.0f, (float)atof(parte.c_str())));
+        }
+        else if (opcion == "--instalaciones" && hay_valor) instalaciones = max(1, atoi(argv[++i]));
+        else if (opcion == "--isocronas" && hay_valor) {
+            stringstream partes(argv[++i]);
+            string parte;
+            while (getline(partes, parte, ',')) presupuestos_isocrona.push_back(atof(parte.c_str()));
+        }
+        else if (opcion == "--ubicacion" && hay_valor && parsear_ubicacion(argv[i + 1], ubicacion)) ++i;
+        else if (opcion == "--comparar-ubicaciones" && hay_valor) {
+            string lista = argv[++i];
+            stringstream partes(lista);
+            string parte;
+            UbicacionGrafo u;
+            while (getline(partes, parte, ',')) {
+                if (!parsear_ubicacion(parte, u)) {
+                    cerr << "Ubicacion desconocida: " << parte << endl;
+                    return 1;
+                }
+                ubicaciones_comparar.push_back(u);
+            }
+        }
+        else if (opcion == "--semilla-grafo" && hay_valor) semilla_grafo = strtoul(argv[++i], nullptr, 10);
+        else if (opcion == "--nodos" && hay_valor) nodos_objetivo = max(0LL, atoll(argv[++i]));
+        else if (opcion == "--semilla-consultas" && hay_valor) semilla_consultas = strtoul(argv[++i], nullptr, 10);
+        else if (opcion == "--consultas" && hay_valor && parsear_criterio(argv[i + 1], criterio)) ++i;
+        else if (opcion == "--pruebas" && hay_valor) num_pruebas = max(1, atoi(argv[++i]));
+        else if (opcion == "--por-banda" && hay_valor) por_banda = max(1, atoi(argv[++i]));
+        else if (opcion == "--banda-min" && hay_valor) banda_min = max(0, atoi(argv[++i]));
+        else if (opcion == "--banda-max" && hay_valor) banda_max = max(0, atoi(argv[++i]));
+        else if (opcion == "--distancia-base" && hay_valor) distancia_base = atof(argv[++i]);
+        else if (opcion == "--bandas" && hay_valor) num_bandas = max(1, atoi(argv[++i]));
+        else if (opcion == "--guardar-consultas" && hay_valor) archivo_guardar = argv[++i];
+        else if (opcion == "--cargar-consultas" && hay_valor) archivo_cargar = argv[++i];
+        else {
+            cout << "Uso: parte2_benchmark [--malla | --importar ARCHIVO.json] [--crp] [--perf]\n"
+                 << "       [--paginas-grandes] [--fijar-hilos]\n"
+                 << "       [--ubicacion normal|thp|hugetlb|entrelazada|replicas|thp+replicas...]\n"
+                 << "       [--comparar-ubicaciones U1,U2,...] [--alternativas K]\n"
+                 << "       [--isocronas C1,C2,...] [--instalaciones N]\n"
+                 << "       [--hpa TAM_CLUSTER] [--epsilon E1,E2,...] [--plazo-ara MS]\n"
+                 << "       [--implicita] [--bfs-bits] [--recustomizar]\n"
+                 << "       [--semilla-grafo N] [--nodos N] [--semilla-consultas N]\n"
+                 << "       [--consultas uniforme|rango|distancia] [--pruebas N] [--por-banda N]\n"
+                 << "       [--banda-min K] [--banda-max K] [--distancia-base D] [--bandas N]\n"
+                 << "       [--guardar-consultas ARCHIVO] [--cargar-consultas ARCHIVO]\n";
+            return 1;
+        }
+    }
+    
+    vector<string> algoritmos = {"BFS", "DFS", "BestFirst", "Dijkstra", "AStar"};
+    
     cout << "Threads disponibles: " << NUM_THREADS << endl;
-    cout << "Numero de pruebas: " << NUM_PRUEBAS << endl;
+    // Arenas por hilo para la memoria temporal de las busquedas
+    configurar_arenas(TAM_BLOQUE_ARENA, paginas_grandes);
+    if (usar_perf) {
+        ContadoresHardware sonda;
+        // Una medicion corta: el grupo puede abrir y aun asi no entrar en el PMU
+        bool grupo_corre = false;
+        if (sonda.disponible()) {
+            sonda.iniciar();
+            volatile uint64_t suma = 0;
+            for (int i = 0; i < 100000; ++i) suma += i;
+            grupo_corre = sonda.detener().valida;
+        }
+        if (!sonda.disponible()) {
+            cout << "Contadores de hardware no disponibles (sin PMU o perf_event_paranoid), se desactivan" << endl;
+            usar_perf = false;
+        } else if (!grupo_corre) {
+            cout << "El grupo de contadores de hardware no entra en el PMU, se desactivan" << endl;
+            usar_perf = false;
+        } else {
+            cout << "Contadores de hardware:";
+            for (int e = 0; e < NUM_EVENTOS_HARDWARE; ++e) {
+                if (sonda.evento_disponible(e)) cout << " " << nombre_evento_hardware(e);
+            }
+            cout << endl;
+        }
+    }
+    cout << "Semilla del grafo: " << semilla_grafo << endl;
     
     // Generar grafo grande
     cout << "\n1. Generando grafo grande..." << endl;
     auto inicio_construccion = high_resolution_clock::now();
     
-    if (!generar_grafo_grande()) {
+    SnapshotGrafo snapshot;
+    snapshot.nombre = !archivo_json.empty() ? "importado" : usar_malla ? "malla" : "sintetico";
+    // Referencia mutable solo para cambiar la ubicacion entre corridas
+    shared_ptr<GrafoGrande> grafo_mutable;
+    if (!archivo_json.empty()) grafo_mutable = importar_grafo_json(archivo_json);
+    else grafo_mutable = generar_grafo_de_tamano(semilla_grafo, usar_malla, nodos_objetivo);
+    if (!grafo_mutable) {
         cerr << "Error al generar el grafo grande" << endl;
         return 1;
     }
+    snapshot.grafo = grafo_mutable;
     
     auto fin_construccion = high_resolution_clock::now();
     double tiempo_construccion = duration_cast<milliseconds>(fin_construccion - inicio_construccion).count();
     
     cout << "Grafo generado exitosamente!" << endl;
     cout << "Tiempo de construccion: " << tiempo_construccion << " ms" << endl;
-    cout << "Nodos: " << MAX_NODES_LARGE << endl;
-    cout << "Aristas aproximadas: " << contar_aristas_grandes() << endl;
+    const GrafoGrande& grafo = *snapshot.grafo;
+    cout << "Nodos: " << grafo.get_num_nodos_reales() << endl;
+    cout << "Aristas aproximadas: " << grafo.contar_aristas() << endl;
+    grafo.mostrar_componentes();
     
-    // Generar puntos de prueba
-    cout << "\n2. Generando puntos de prueba..." << endl;
-    vector<pair<int, int>> puntos_prueba = generar_puntos_prueba(NUM_PRUEBAS, MAX_NODES_LARGE);
+    // Ubicacion de los arreglos del grafo y afinidad de los hilos de prueba
+    cout << "Nodos NUMA: " << num_nodos_numa() << endl;
+    if (ubicacion.paginas != PaginasGrafo::NORMALES || ubicacion.numa != DistribucionNuma::PRIMER_TOQUE) {
+        grafo_mutable->ubicar(ubicacion);
+    }
+    cout << "Ubicacion del grafo: " << nombre_ubicacion(grafo.get_ubicacion()) << endl;
+    vector<int> cpus;
+    if (fijar_hilos) {
+        cpus = cpus_del_proceso();
+        cout << "Hilos fijados a " << cpus.size() << " CPUs" << endl;
+    }
     
-    // Preparar resultados
-    vector<PruebaRendimiento> resultados(NUM_PRUEBAS * 5); // 5 algoritmos
+    if (usar_crp) {
+        snapshot.overlay = construir_overlay_particiones(grafo);
+        if (snapshot.overlay) {
+            algoritmos.push_back("CRP");
+        } else {
+            cerr << "No se pudo construir el overlay, se omite CRP" << endl;
+        }
+    }
     
-    // Ejecutar pruebas en paralelo
-    cout << "\n3. Ejecutando pruebas en paralelo..." << endl;
-    auto inicio_pruebas = high_resolution_clock::now();
+    // Memoria estable tras la construccion (la de cada consulta se mide por hilo)
+    cout << "\nMemoria tras la construccion:" << endl;
+    mostrar_uso_memoria();
+    cout << "Grafo: " << (grafo.memoria_usada() / 1024.0 / 1024.0) << " MB";
+    if (snapshot.overlay) {
+        cout << ", overlay: " << (snapshot.overlay->memoria_usada() / 1024.0 / 1024.0) << " MB";
+    }
+    cout << endl;
     
-    vector<thread> threads;
-    int pruebas_por_thread = NUM_PRUEBAS / NUM_THREADS;
+    // Generar (o cargar) el conjunto de consultas
+    cout << "\n2. Preparando consultas de prueba..." << endl;
+    ConjuntoConsultas conjunto;
+    if (!archivo_cargar.empty()) {
+        if (!cargar_consultas(conjunto, archivo_cargar, grafo.get_num_nodos_reales())) {
+            return 1;
+        }
+        cout << "Consultas cargadas de: " << archivo_cargar << endl;
+    } else if (criterio == CriterioConsultas::RANGO) {
+        if (banda_max == 0) {
+            banda_max = 31 - __builtin_clz(max(1, grafo.get_num_nodos_reales()));
+        }
+        conjunto = generar_consultas_por_rango(grafo, por_banda, banda_min, max(banda_min, banda_max), semilla_consultas);
+    } else if (criterio == CriterioConsultas::DISTANCIA) {
+        conjunto = generar_consultas_por_distancia(grafo, por_banda, distancia_base, num_bandas, semilla_consultas);
+    } else {
+        conjunto = generar_consultas_uniformes(grafo, num_pruebas, semilla_consultas);
+    }
+    if (!archivo_guardar.empty() && guardar_consultas(conjunto, archivo_guardar)) {
+        cout << "Consultas guardadas en: " << archivo_guardar << endl;
+    }
     
-    for (int t = 0; t < NUM_THREADS; ++t) {
-        int inicio = t * pruebas_por_thread;
-        int fin = (t == NUM_THREADS - 1) ? NUM_PRUEBAS : (t + 1) * pruebas_por_thread;
-        
-        threads.emplace_back(ejecutar_pruebas_paralelas, 
-                           ref(puntos_prueba), ref(resultados), t, inicio, fin);
+    const vector<ConsultaPrueba>& consultas = conjunto.consultas;
+    num_pruebas = consultas.size();
+    cout << "Criterio: " << nombre_criterio(conjunto.criterio) << ", semilla: " << conjunto.semilla
+         << ", consultas: " << num_pruebas << endl;
+    if (num_pruebas == 0) {
+        cerr << "El conjunto de consultas esta vacio" << endl;
+        return 1;
     }
+    int descartables = 0;
+    for (const ConsultaPrueba& consulta : consultas) {
+        if (!grafo.puede_alcanzar(consulta.origen, consulta.destino)) descartables++;
+    }
+    cout << "Consultas sin camino segun las componentes (se descartan en O(1)): " << descartables << endl;
     
-    // Esperar a que terminen todos los threads
-    for (auto& t : threads) {
-        t.join();
+    // Comparar ubicaciones del grafo con las mismas consultas, luego volver a la elegida
+    if (!ubicaciones_comparar.empty()) {
+        cout << "\n3a. Comparando ubicaciones del grafo..." << endl;
+        comparar_ubicaciones(*grafo_mutable, snapshot, ubicaciones_comparar, consultas, algoritmos,
+                             NUM_THREADS, cpus);
+        grafo_mutable->ubicar(ubicacion);
     }
     
-    auto fin_pruebas = high_resolution_clock::now();
-    double tiempo_total_pruebas = duration_cast<milliseconds>(fin_pruebas - inicio_pruebas).count();
+    if (alternativas > 0) {
+        cout << "\n3b. Midiendo rutas alternativas (K = " << alternativas << ")..." << endl;
+        comparar_alternativas(grafo, consultas, alternativas, NUM_THREADS);
+    }
+    
+    if (!presupuestos_isocrona.empty()) {
+        cout << "\n3c. Midiendo isocronas..." << endl;
+        medir_isocronas(grafo, consultas, presupuestos_isocrona, NUM_THREADS);
+    }
+    
+    if (instalaciones > 0) {
+        cout << "\n3d. Midiendo instalacion mas cercana (" << instalaciones << " instalaciones)..." << endl;
+        medir_instalaciones(grafo, consultas, instalaciones, semilla_consultas, NUM_THREADS);
+    }
+    
+    if (tam_cluster_hpa > 0) {
+        cout << "\n3e. Midiendo HPA* (clusters de " << tam_cluster_hpa << "x" << tam_cluster_hpa << ")..." << endl;
+        medir_hpa(*grafo_mutable, consultas, tam_cluster_hpa, NUM_THREADS);
+    }
+    
+    if (!epsilons.empty()) {
+        cout << "\n3f. Midiendo A* con cota de suboptimalidad..." << endl;
+        medir_epsilon(grafo, consultas, epsilons, plazo_ara_ms);
+    }
+    
+    if (medir_implicita) {
+        cout << "\n3g. Midiendo la malla implicita (sin CSR)..." << endl;
+        if (usar_malla && archivo_json.empty()) {
+            medir_malla_implicita(grafo, consultas, semilla_grafo, lado_malla_de_tamano(nodos_objetivo));
+        } else {
+            cerr << "La malla implicita requiere --malla" << endl;
+        }
+    }
+    
+    if (medir_bits) {
+        cout << "\n3h. Midiendo BFS sobre mapas de bits..." << endl;
+        if (usar_malla && archivo_json.empty()) {
+            medir_bfs_bits(grafo, consultas, semilla_grafo, lado_malla_de_tamano(nodos_objetivo), NUM_THREADS);
+        } else {
+            cerr << "El BFS de mapas de bits requiere --malla" << endl;
+        }
+    }
+    
+    if (medir_recustomizar) {
+        cout << "\n3i. Midiendo la recustomizacion del overlay CRP..." << endl;
+        medir_recustomizacion(*grafo_mutable, consultas);
+    }
+    
+    // Preparar resultados
+    vector<PruebaRendimiento> resultados(num_pruebas * algoritmos.size());
+    vector<LatenciasPorAlgoritmo> latencias_por_hilo(NUM_THREADS);
+    
+    // Ejecutar pruebas en paralelo
+    cout << "\n3. Ejecutando pruebas en paralelo..." << endl;
+    double tiempo_total_pruebas = ejecutar_corrida(snapshot, consultas, algoritmos, resultados,
+                                                   latencias_por_hilo, usar_perf, cpus);
     
     cout << "\nPruebas completadas en: " << tiempo_total_pruebas << " ms" << endl;
     
     // Analizar y mostrar resultados
     cout << "\n4. Analizando resultados..." << endl;
-    analizar_resultados(resultados, NUM_PRUEBAS);
+    ComparacionRendimiento comparacion = calcular_estadisticas(resultados);
+    comparacion.nombres_bandas = conjunto.nombres_bandas();
+    aplicar_latencias(comparacion, latencias_por_hilo, tiempo_total_pruebas / 1000.0);
+    analizar_resultados(comparacion, resultados.size(), num_pruebas);
+    
+    // En regimen estable las busquedas no deberian llamar al asignador global:
+    // solo las primeras consultas de cada hilo mapean bloques de la arena.
+    size_t asignaciones_totales = 0;
+    int consultas_con_asignaciones = 0;
+    for (const auto& prueba : resultados) {
+        asignaciones_totales += prueba.asignaciones;
+        if (prueba.asignaciones > 0) consultas_con_asignaciones++;
+    }
+    cout << "\nAsignaciones globales durante las busquedas: " << asignaciones_totales
+         << " (en " << consultas_con_asignaciones << " de " << resultados.size() << " consultas)" << endl;
     
     // Guardar resultados en archivo
     guardar_resultados_csv(resultados, "resultados_parte2.csv");
+    guardar_estadisticas_csv(comparacion, "estadisticas_parte2.csv");
+    if (!comparacion.nombres_bandas.empty()) {
+        guardar_latencia_por_banda_csv(comparacion, "bandas_parte2.csv");
+    }
+    generar_reporte_html(comparacion, "reporte_parte2.html");
     
     cout << "\n=== PRUEBAS COMPLETADAS ===" << endl;
     cout << "Resultados guardados en: resultados_parte2.csv" << endl;
@@ -0,0 +1,110 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cerrno>
+#include <unistd.h>
+#include <poll.h>
+
+// Protocolo binario del servidor de rutas (servidor_rutas.cpp / cliente_rutas.cpp).
+// Mensajes de tamano fijo en el orden de bytes del host (solo uso local).
+// El cliente puede enviar varias solicitudes sin esperar respuesta (pipelining);
+// las respuestas llevan el mismo 'id' y pueden llegar en otro orden.
+
+constexpr uint32_t PROTOCOLO_MAGIA = 0x52544131;   // "RTA1"
+
+// Algoritmos disponibles
+enum class AlgoritmoRuta : uint8_t {
+    BFS = 0,
+    DFS = 1,
+    BEST_FIRST = 2,
+    DIJKSTRA = 3,
+    ASTAR = 4,
+    CRP = 5
+};
+
+// Opciones de la solicitud
+constexpr uint8_t SOLICITUD_INCLUIR_CAMINO = 0x01;  // Devolver los nodos de la ruta
+
+// Estados de la respuesta
+enum class EstadoRespuesta : uint8_t {
+    ENCONTRADO = 0,
+    SIN_CAMINO = 1,
+    SOLICITUD_INVALIDA = 2,
+    NO_DISPONIBLE = 3,   // Algoritmo no cargado en el servidor (ej. CRP sin overlay)
+    PRESUPUESTO_AGOTADO = 4   // La busqueda llego al limite de nodos del servidor (--max-nodos)
+};
+
+#pragma pack(push, 1)
+struct SolicitudRuta {
+    uint32_t magia;
+    uint32_t id;           // Elegido por el cliente, se devuelve en la respuesta
+    uint8_t algoritmo;     // AlgoritmoRuta
+    uint8_t opciones;      // SOLICITUD_*
+    uint16_t grafo;        // Id del grafo en el registro del servidor (0: principal)
+    int32_t origen;
+    int32_t destino;
+};
+
+struct RespuestaRuta {
+    uint32_t id;
+    uint8_t estado;        // EstadoRespuesta
+    uint8_t reservado[3];
+    float costo;           // Suma de pesos de la ruta
+    uint32_t largo;        // Nodos en la ruta
+    uint32_t tiempo_us;    // Tiempo de busqueda dentro del servidor
+    uint32_t nodos_enviados;  // Nodos que siguen a la cabecera (0 si no se pidio el camino)
+};
+#pragma pack(pop)
+
+static_assert(sizeof(SolicitudRuta) == 20, "SolicitudRuta debe medir 20 bytes");
+static_assert(sizeof(RespuestaRuta) == 24, "RespuestaRuta debe medir 24 bytes");
+
+// Lectura/escritura completas sobre un descriptor (reintenta lecturas parciales)
+inline bool leer_completo(int fd, void* buffer, size_t bytes) {
+    char* ptr = static_cast<char*>(buffer);
+    while (bytes > 0) {
+        ssize_t n = ::read(fd, ptr, bytes);
+        if (n == 0) return false;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        ptr += n;
+        bytes -= n;
+    }
+    return true;
+}
+
+inline bool escribir_completo(int fd, const void* buffer, size_t bytes) {
+    const char* ptr = static_cast<const char*>(buffer);
+    while (bytes > 0) {
+        ssize_t n = ::write(fd, ptr, bytes);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        ptr += n;
+        bytes -= n;
+    }
+    return true;
+}
+
+// Para descriptores no bloqueantes: espera a poder escribir y falla si el otro
+// extremo no acepta datos durante 'plazo_ms' (un cliente que no lee)
+inline bool escribir_con_plazo(int fd, const void* buffer, size_t bytes, int plazo_ms) {
+    const char* ptr = static_cast<const char*>(buffer);
+    while (bytes > 0) {
+        ssize_t n = ::write(fd, ptr, bytes);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) return false;
+            pollfd pfd = {fd, POLLOUT, 0};
+            int listos = ::poll(&pfd, 1, plazo_ms);
+            if (listos == 0 || (listos < 0 && errno != EINTR)) return false;
+            continue;
+        }
+        ptr += n;
+        bytes -= n;
+    }
+    return true;
+}
@@ -0,0 +1,50 @@
+#include "registro_grafos.h"
+
+using namespace std;
+
+int RegistroGrafos::publicar(const string& nombre, shared_ptr<const GrafoGrande> grafo,
+                             shared_ptr<const OverlayParticiones> overlay) {
+    if (!grafo) return -1;
+
+    lock_guard<mutex> lock(mutex_publicar);
+
+    int id = buscar_id(nombre);
+    if (id < 0) {
+        id = num_entradas.load(memory_order_relaxed);
+        if (id >= MAX_GRAFOS_REGISTRO) return -1;
+        entradas[id].nombre = nombre;
+    }
+    Entrada& entrada = entradas[id];
+
+    auto snapshot = make_shared<SnapshotGrafo>();
+    snapshot->nombre = nombre;
+    snapshot->id = id;
+    snapshot->version = ++entrada.versiones;
+    snapshot->grafo = move(grafo);
+    snapshot->overlay = move(overlay);
+
+    atomic_store_explicit(&entrada.actual, shared_ptr<const SnapshotGrafo>(move(snapshot)),
+                          memory_order_release);
+    if (id == num_entradas.load(memory_order_relaxed)) {
+        // La entrada ya tiene nombre y snapshot antes de hacerse visible
+        num_entradas.store(id + 1, memory_order_release);
+    }
+    return id;
+}
+
+ManejadorGrafo RegistroGrafos::obtener(int id) const {
+    if (id < 0 || id >= cantidad()) return nullptr;
+    return atomic_load_explicit(&entradas[id].actual, memory_order_acquire);
+}
+
+ManejadorGrafo RegistroGrafos::obtener(const string& nombre) const {
+    return obtener(buscar_id(nombre));
+}
+
+int RegistroGrafos::buscar_id(const string& nombre) const {
+    int n = cantidad();
+    for (int i = 0; i < n; ++i) {
+        if (entradas[i].nombre == nombre) return i;
+    }
+    return -1;
+}
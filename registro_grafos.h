@@ -0,0 +1,61 @@
+#pragma once
+#include "grafo_grande.h"
+#include "overlay_particiones.h"
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Registro de grafos cargados en el proceso.
+//
+// Cada nombre (una ciudad, o una variante de pesos: auto, peaton...) tiene un
+// id estable y apunta a su version actual, un SnapshotGrafo inmutable. Una
+// consulta toma el snapshot con obtener() y lo mantiene vivo mientras corre;
+// publicar() reemplaza el puntero de forma atomica, asi que las consultas
+// nuevas ven la version nueva, las que estaban en curso terminan con la
+// anterior y esta se libera cuando la suelta la ultima. No hay bloqueo en la
+// lectura ni espera al recargar.
+
+constexpr int MAX_GRAFOS_REGISTRO = 64;
+
+// Version publicada de un grafo. El overlay (si existe) se construyo sobre
+// este mismo grafo y guarda un puntero a el: por eso viajan juntos.
+struct SnapshotGrafo {
+    std::string nombre;
+    int id = -1;
+    uint64_t version = 0;                                   // 1 para la primera publicacion
+    std::shared_ptr<const GrafoGrande> grafo;
+    std::shared_ptr<const OverlayParticiones> overlay;      // nullptr sin CRP
+};
+
+// Referencia contada a un snapshot: mientras exista, el grafo no se libera
+using ManejadorGrafo = std::shared_ptr<const SnapshotGrafo>;
+
+class RegistroGrafos {
+private:
+    struct Entrada {
+        std::string nombre;
+        std::shared_ptr<const SnapshotGrafo> actual;   // Solo via atomic_load / atomic_store
+        uint64_t versiones = 0;
+    };
+
+    // Arreglo fijo: las entradas nunca se mueven, asi que leer no necesita bloqueo
+    Entrada entradas[MAX_GRAFOS_REGISTRO];
+    std::atomic<int> num_entradas{0};
+    std::mutex mutex_publicar;                        // Serializa publicaciones
+
+public:
+    // Publica (o reemplaza) la version de 'nombre'. Devuelve su id, o -1 si el
+    // registro esta lleno o falta el grafo.
+    int publicar(const std::string& nombre, std::shared_ptr<const GrafoGrande> grafo,
+                 std::shared_ptr<const OverlayParticiones> overlay = nullptr);
+
+    // Version actual; nullptr si el id o el nombre no existen
+    ManejadorGrafo obtener(int id) const;
+    ManejadorGrafo obtener(const std::string& nombre) const;
+
+    int buscar_id(const std::string& nombre) const;   // -1 si no existe
+    int cantidad() const { return num_entradas.load(std::memory_order_acquire); }
+};
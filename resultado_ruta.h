@@ -0,0 +1,72 @@
+#pragma once
+
+// Resultado de una busqueda de ruta (Parte I y Parte II).
+//
+// Lo crea quien llama y se reutiliza entre consultas: el buffer del camino
+// solo crece, asi que despues de las primeras rutas largas no se vuelve a
+// reservar memoria y no hace falta un arreglo de MAX_NODES en la pila. Las
+// busquedas escriben el camino ya en orden (origen primero).
+
+enum class EstadoRuta {
+    ENCONTRADA,
+    SIN_CAMINO,             // Destino inalcanzable o nodos fuera de rango
+    PRESUPUESTO_AGOTADO     // Se asentaron limite_nodos nodos sin llegar al destino
+};
+
+class ResultadoRuta {
+private:
+    int* nodos = nullptr;
+    int capacidad = 0;
+    int cantidad = 0;
+
+    // Conserva los nodos ya escritos
+    void crecer(int minimo) {
+        int nueva_capacidad = capacidad > 32 ? capacidad * 2 : 64;
+        if (nueva_capacidad < minimo) nueva_capacidad = minimo;
+        int* nuevos = new int[nueva_capacidad];
+        for (int i = 0; i < cantidad; ++i) {
+            nuevos[i] = nodos[i];
+        }
+        delete[] nodos;
+        nodos = nuevos;
+        capacidad = nueva_capacidad;
+    }
+
+public:
+    EstadoRuta estado = EstadoRuta::SIN_CAMINO;
+    float costo = 0.0f;             // Suma de pesos de la ruta (0 sin ruta)
+    int nodos_asentados = 0;        // Nodos que la busqueda expandio
+    int limite_nodos = 0;           // Presupuesto de nodos asentados, lo fija quien llama (0: sin limite)
+    float cota = 0.0f;              // Busquedas acotadas: costo <= cota * optimo (0: sin garantia)
+
+    ResultadoRuta() = default;
+    ~ResultadoRuta() { delete[] nodos; }
+
+    ResultadoRuta(const ResultadoRuta&) = delete;
+    ResultadoRuta& operator=(const ResultadoRuta&) = delete;
+
+    // Al empezar una busqueda: vacia el camino, conserva buffer y limite
+    void reiniciar() {
+        cantidad = 0;
+        estado = EstadoRuta::SIN_CAMINO;
+        costo = 0.0f;
+        nodos_asentados = 0;
+        cota = 0.0f;
+    }
+
+    // Agrega 'n' nodos al final y devuelve donde escribirlos
+    int* extender(int n) {
+        if (cantidad + n > capacidad) crecer(cantidad + n);
+        int* inicio = nodos + cantidad;
+        cantidad += n;
+        return inicio;
+    }
+
+    void vaciar_camino() { cantidad = 0; }
+
+    bool encontrada() const { return estado == EstadoRuta::ENCONTRADA; }
+    bool presupuesto_agotado(int asentados) const { return limite_nodos > 0 && asentados >= limite_nodos; }
+    int largo() const { return cantidad; }
+    const int* camino() const { return nodos; }
+    int operator[](int i) const { return nodos[i]; }
+};
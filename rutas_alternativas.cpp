@@ -0,0 +1,538 @@
+#include "rutas_alternativas.h"
+#include "estructuras_grandes.h"
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <unordered_set>
+#include <cstdint>
+#include <limits>
+#include <omp.h>
+
+using namespace std;
+
+static const float INFINITO_ALTERNATIVAS = numeric_limits<float>::infinity();
+
+namespace {
+
+// Arbol de caminos minimos acotado. 'padre' apunta hacia la raiz: en el arbol
+// desde el origen es el predecesor, en el arbol hacia el destino es el
+// siguiente nodo de la ruta. Solo los nodos asentados tienen distancia final
+// (y solo de ellos se leen distancia y padre fuera de construir_arbol). Se
+// reutiliza entre consultas con sellos de generacion, como EspacioHPA; el
+// sello va junto al resto del estado del nodo para que relajar una arista
+// toque una sola linea de cache.
+struct NodoArbol {
+    uint32_t sello;                // == generacion: el resto es de esta busqueda
+    uint32_t asentado;
+    float distancia;
+    int padre;
+};
+
+struct ArbolCaminos {
+    uint32_t generacion = 0;
+    vector<NodoArbol> nodo;
+    vector<int> orden;             // Nodos en el orden en que se asentaron
+    int num_asentados = 0;
+    unique_ptr<ColaPrioridadGrande> cola;
+    int capacidad_cola = 0;
+
+    void nueva_busqueda(int n) {
+        if ((int)nodo.size() < n) {
+            nodo.resize(n, NodoArbol{0, 0, 0.0f, -1});
+            orden.resize(n);
+        }
+        if (++generacion == 0) {
+            for (NodoArbol& e : nodo) e.sello = 0;
+            generacion = 1;
+        }
+        if (capacidad_cola < capacidad_cola_grande(n)) {
+            capacidad_cola = capacidad_cola_grande(n);
+            cola = make_unique<ColaPrioridadGrande>(capacidad_cola);
+        }
+        cola->limpiar();
+        num_asentados = 0;
+    }
+
+    float dist(int v) const { return nodo[v].sello == generacion ? nodo[v].distancia : INFINITO_ALTERNATIVAS; }
+    bool es_asentado(int v) const { return nodo[v].sello == generacion && nodo[v].asentado; }
+    void poner(int v, float d, int p) {
+        NodoArbol& e = nodo[v];
+        if (e.sello != generacion) {
+            e.sello = generacion;
+            e.asentado = 0;
+        }
+        e.distancia = d;
+        e.padre = p;
+    }
+
+    // Solo para nodos asentados en esta busqueda
+    float distancia(int v) const { return nodo[v].distancia; }
+    int padre(int v) const { return nodo[v].padre; }
+};
+
+// Estado de una consulta en el hilo que la atiende, reutilizado entre
+// consultas. 'posicion' vale INT_MAX fuera de la ruta previa de Yen (cada
+// iteracion la vuelve a dejar asi); 'cruce', 'inicio' y 'fin' solo se leen
+// donde la consulta ya escribio.
+struct EspacioAlternativas {
+    ArbolCaminos desde_origen;
+    ArbolCaminos hacia_destino;
+    vector<int> cruce;
+    vector<int> posicion;
+    vector<int> inicio;
+    vector<int> fin;
+
+    void preparar(int n) {
+        if ((int)cruce.size() < n) {
+            cruce.resize(n);
+            posicion.resize(n, numeric_limits<int>::max());
+            inicio.resize(n);
+            fin.resize(n);
+        }
+    }
+};
+
+thread_local EspacioAlternativas espacio_alternativas;
+
+void bajar_limite(atomic<float>& limite, float valor) {
+    float actual = limite.load(memory_order_relaxed);
+    while (valor < actual && !limite.compare_exchange_weak(actual, valor, memory_order_relaxed)) {
+    }
+}
+
+// Dijkstra desde 'raiz' hasta que la menor clave supera 'limite'. Al asentar
+// 'otro_extremo' a distancia d baja el limite a estiramiento * d; con dos
+// arboles en paralelo, el primero que llega lo baja para ambos.
+void construir_arbol(const VistaGrande& vista, int raiz, int otro_extremo, float estiramiento,
+                     atomic<float>& limite, ArbolCaminos& arbol) {
+    arbol.nueva_busqueda(vista.num_nodos());
+    ColaPrioridadGrande& cola = *arbol.cola;
+
+    arbol.poner(raiz, 0.0f, -1);
+    cola.insertar(raiz, 0.0f);
+    while (!cola.vacia()) {
+        int actual = cola.extraer_min();
+        NodoArbol& estado = arbol.nodo[actual];         // Esta en la cola: su sello es valido
+        if (estado.asentado) continue;
+        const float d = estado.distancia;
+        if (d > limite.load(memory_order_relaxed)) break;
+        estado.asentado = 1;
+        arbol.orden[arbol.num_asentados++] = actual;
+        if (actual == otro_extremo) bajar_limite(limite, estiramiento * d);
+
+        const float tope = limite.load(memory_order_relaxed);
+        vista.para_cada_vecino(actual, [&](int vecino, float peso) {
+            float nueva = d + peso;
+            if (nueva <= tope && nueva < arbol.dist(vecino) && !arbol.es_asentado(vecino)) {
+                arbol.poner(vecino, nueva, actual);
+                cola.insertar(vecino, nueva);
+            }
+        });
+    }
+}
+
+// Ruta de Yen: 'desvio' es el primer indice en que difiere de la ruta de la
+// que salio (los desvios de la siguiente iteracion empiezan ahi)
+struct Candidato {
+    float costo = 0.0f;
+    int desvio = 0;
+    vector<int> nodos;
+    vector<float> acumulado;       // Costo desde el origen hasta cada nodo
+};
+
+uint64_t huella(const vector<int>& nodos) {
+    uint64_t h = 1469598103934665603ULL;
+    for (int v : nodos) {
+        h = (h ^ (uint32_t)v) * 1099511628211ULL;
+    }
+    return h ^ nodos.size();
+}
+
+// Rutas ya vistas: la huella solo elige el balde, dos rutas son la misma si
+// tienen los mismos nodos
+struct HuellaRuta {
+    size_t operator()(const vector<int>& nodos) const { return huella(nodos); }
+};
+
+// Estado de un nodo en un desvio, junto para que cada arista relajada toque
+// una sola entrada
+struct NodoDesvio {
+    uint32_t tocado;               // == generacion: g y anterior son de este desvio
+    uint32_t cerrado;              // == generacion: asentado en este desvio
+    uint32_t bloqueado;            // == generacion: nodo de la raiz
+    float g;
+    int anterior;
+};
+
+// Espacio de desvios de un hilo del pool de OpenMP, reutilizado entre
+// iteraciones y consultas. Cada desvio usa una generacion nueva, asi que los
+// sellos solo se ponen en cero al crecer o cuando la generacion da la vuelta.
+struct EspacioDesvio {
+    vector<NodoDesvio> nodo;
+    unique_ptr<ColaPrioridadGrande> cola;
+    int capacidad_cola = 0;
+    uint32_t generacion = 0;
+    int asentados = 0;
+    vector<int> prohibidos;        // Siguientes nodos ya usados desde la raiz
+
+    void preparar(int n) {
+        if ((int)nodo.size() < n) nodo.resize(n, NodoDesvio{0, 0, 0, 0.0f, -1});
+        if (capacidad_cola < capacidad_cola_grande(n)) {
+            capacidad_cola = capacidad_cola_grande(n);
+            cola = make_unique<ColaPrioridadGrande>(capacidad_cola);
+        }
+        asentados = 0;
+    }
+
+    uint32_t nuevo_desvio() {
+        if (++generacion == 0) {
+            for (NodoDesvio& d : nodo) d.tocado = d.cerrado = d.bloqueado = 0;
+            generacion = 1;
+        }
+        return generacion;
+    }
+};
+
+thread_local EspacioDesvio espacio_desvio;
+
+// Desvio 'i' de Yen: A* desde previa.nodos[i] con h = distancia exacta del
+// arbol hacia el destino, que sigue siendo admisible y consistente al quitar
+// nodos y aristas. No entra a la raiz, no usa las aristas prohibidas desde el
+// nodo de desvio y descarta lo que no cabe en el limite. Se detiene en el
+// primer nodo asentado cuyo camino en el arbol esta libre (cruce > i): con h
+// exacta el resto de la ruta es ese camino, sin buscarlo.
+bool buscar_desvio(const VistaGrande& vista, const ArbolCaminos& hacia_destino, const int* cruce,
+                   const Candidato& previa, int i, float limite, EspacioDesvio& e, Candidato& salida) {
+    const uint32_t generacion = e.nuevo_desvio();
+    for (int j = 0; j < i; ++j) {
+        e.nodo[previa.nodos[j]].bloqueado = generacion;
+    }
+    const int desvio = previa.nodos[i];
+    const float base = previa.acumulado[i];
+    const float presupuesto = limite - base;
+    auto h = [&](int v) { return hacia_destino.distancia(v); };
+    auto siguiente = [&](int v) { return hacia_destino.padre(v); };
+    ColaPrioridadGrande& cola = *e.cola;
+    auto prohibido = [&](int v) {
+        return find(e.prohibidos.begin(), e.prohibidos.end(), v) != e.prohibidos.end();
+    };
+
+    e.nodo[desvio].tocado = generacion;
+    e.nodo[desvio].g = 0.0f;
+    e.nodo[desvio].anterior = -1;
+    cola.limpiar();
+    cola.insertar(desvio, h(desvio));
+
+    int enlace = -1;               // Nodo donde la ruta se une al arbol
+    while (!cola.vacia()) {
+        int actual = cola.extraer_min();
+        if (e.nodo[actual].cerrado == generacion) continue;
+        e.nodo[actual].cerrado = generacion;
+        e.asentados++;
+
+        bool libre = actual == desvio
+            ? siguiente(desvio) >= 0 && cruce[siguiente(desvio)] > i && !prohibido(siguiente(desvio))
+            : cruce[actual] > i;
+        if (libre) {
+            enlace = actual;
+            break;
+        }
+
+        const float g_actual = e.nodo[actual].g;
+        vista.para_cada_vecino(actual, [&](int vecino, float peso) {
+            NodoDesvio& estado = e.nodo[vecino];
+            if (!hacia_destino.es_asentado(vecino) || estado.bloqueado == generacion ||
+                estado.cerrado == generacion) {
+                return;
+            }
+            if (actual == desvio && prohibido(vecino)) return;
+            float nuevo = g_actual + peso;
+            if (nuevo + h(vecino) > presupuesto) return;
+            if (estado.tocado != generacion || nuevo < estado.g) {
+                estado.tocado = generacion;
+                estado.g = nuevo;
+                estado.anterior = actual;
+                cola.insertar(vecino, nuevo + h(vecino));
+            }
+        });
+    }
+    if (enlace < 0) return false;
+
+    // Raiz + tramo buscado (desvio..enlace) + camino del arbol (enlace..destino)
+    int largo_tramo = 0;
+    for (int v = enlace; v != -1; v = e.nodo[v].anterior) {
+        largo_tramo++;
+    }
+    salida.nodos.assign(previa.nodos.begin(), previa.nodos.begin() + i);
+    salida.acumulado.assign(previa.acumulado.begin(), previa.acumulado.begin() + i);
+    salida.nodos.resize(i + largo_tramo);
+    salida.acumulado.resize(i + largo_tramo);
+    int k = i + largo_tramo;
+    for (int v = enlace; v != -1; v = e.nodo[v].anterior) {
+        --k;
+        salida.nodos[k] = v;
+        salida.acumulado[k] = base + e.nodo[v].g;
+    }
+    const float costo_enlace = base + e.nodo[enlace].g;
+    for (int v = siguiente(enlace); v != -1; v = siguiente(v)) {
+        salida.nodos.push_back(v);
+        salida.acumulado.push_back(costo_enlace + h(enlace) - h(v));
+    }
+    salida.costo = salida.acumulado.back();
+    salida.desvio = i;
+    return true;
+}
+
+} // namespace
+
+MotorAlternativas::MotorAlternativas(const GrafoGrande& g) : grafo(&g) {}
+
+bool MotorAlternativas::construir() {
+    if (grafo->get_num_nodos_reales() == 0) return false;
+    grafo->vista_inversa();              // Arma el transpuesto del grafo si nadie lo pidio antes
+    return true;
+}
+
+void MotorAlternativas::buscar_yen(int origen, int destino, const OpcionesAlternativas& opciones,
+                                   ConjuntoRutas& rutas) const {
+    rutas.reiniciar();
+    VistaGrande vista = grafo->vista();
+    const int n = vista.num_nodos();
+    if (opciones.k < 1 || !grafo->puede_alcanzar(origen, destino)) return;
+
+    // Referencia tomada fuera de las regiones paralelas: dentro, el nombre
+    // thread_local seria el espacio de cada hilo del pool
+    EspacioAlternativas& espacio = espacio_alternativas;
+    espacio.preparar(n);
+
+    // Estado compartido por todos los desvios: distancias exactas al destino
+    // dentro del radio permitido
+    ArbolCaminos& hacia_destino = espacio.hacia_destino;
+    atomic<float> limite(INFINITO_ALTERNATIVAS);
+    construir_arbol(grafo->vista_inversa(), destino, origen, max(1.0f, opciones.estiramiento_max),
+                    limite, hacia_destino);
+    rutas.nodos_asentados = hacia_destino.num_asentados;
+    if (!hacia_destino.es_asentado(origen)) return;
+    const float tope = limite.load();
+
+    vector<Candidato> elegidas;
+    elegidas.reserve(opciones.k);
+    Candidato primera;
+    const float d = hacia_destino.distancia(origen);
+    for (int v = origen; v != -1; v = hacia_destino.padre(v)) {
+        primera.nodos.push_back(v);
+        primera.acumulado.push_back(d - hacia_destino.distancia(v));
+    }
+    primera.costo = d;
+    elegidas.push_back(move(primera));
+
+    // cruce[v]: menor indice de la ruta previa en el camino de v por el arbol
+    // (v incluido). Un desvio i puede seguir el arbol desde v si cruce[v] > i.
+    int* cruce = espacio.cruce.data();
+    int* posicion = espacio.posicion.data();
+
+    const int hilos = max(1, opciones.hilos);
+    vector<vector<Candidato>> encontrados(hilos);  // Por hilo del pool
+    int asentados_desvios = 0;
+    vector<Candidato> candidatos;
+    unordered_set<vector<int>, HuellaRuta> vistas;
+    vector<int> comun;             // Prefijo comun de cada ruta elegida con la previa
+
+    while ((int)elegidas.size() < opciones.k) {
+        const Candidato& previa = elegidas.back();
+        const int ultimo = previa.nodos.size() - 1;
+
+        for (int j = 0; j <= ultimo; ++j) {
+            posicion[previa.nodos[j]] = j;
+        }
+        for (int k = 0; k < hacia_destino.num_asentados; ++k) {
+            int v = hacia_destino.orden[k];
+            int p = hacia_destino.padre(v);
+            cruce[v] = p < 0 ? posicion[v] : min(posicion[v], cruce[p]);
+        }
+        for (int j = 0; j <= ultimo; ++j) {
+            posicion[previa.nodos[j]] = numeric_limits<int>::max();
+        }
+
+        comun.assign(elegidas.size(), 0);
+        for (size_t r = 0; r < elegidas.size(); ++r) {
+            const vector<int>& nodos = elegidas[r].nodos;
+            int c = 0;
+            while (c < (int)nodos.size() && c <= ultimo && nodos[c] == previa.nodos[c]) c++;
+            comun[r] = c;
+        }
+
+        // Desvios desde el punto donde la previa se separo de su ruta de
+        // origen, repartidos entre los hilos del pool de OpenMP
+        atomic<int> proximo(previa.desvio);
+        #pragma omp parallel num_threads(hilos) reduction(+ : asentados_desvios)
+        {
+            EspacioDesvio& e = espacio_desvio;
+            e.preparar(n);
+            vector<Candidato>& propios = encontrados[omp_get_thread_num()];
+            Candidato candidato;
+            int i;
+            while ((i = proximo.fetch_add(1)) < ultimo) {
+                e.prohibidos.clear();
+                for (size_t r = 0; r < elegidas.size(); ++r) {
+                    if (comun[r] > i) e.prohibidos.push_back(elegidas[r].nodos[i + 1]);
+                }
+                if (buscar_desvio(vista, hacia_destino, cruce, previa, i, tope, e, candidato)) {
+                    propios.push_back(move(candidato));
+                }
+            }
+            asentados_desvios += e.asentados;
+        }
+
+        // La misma ruta puede salir de desvios de rutas distintas
+        for (vector<Candidato>& propios : encontrados) {
+            for (Candidato& c : propios) {
+                if (vistas.insert(c.nodos).second) candidatos.push_back(move(c));
+            }
+            propios.clear();
+        }
+        if (candidatos.empty()) break;
+
+        auto mejor = min_element(candidatos.begin(), candidatos.end(), [](const Candidato& a, const Candidato& b) {
+            return a.costo < b.costo || (a.costo == b.costo && a.nodos < b.nodos);
+        });
+        elegidas.push_back(move(*mejor));
+        candidatos.erase(mejor);
+    }
+
+    rutas.nodos_asentados += asentados_desvios;
+    for (const Candidato& c : elegidas) {
+        rutas.agregar(c.nodos.data(), c.nodos.size(), c.costo);
+    }
+}
+
+void MotorAlternativas::buscar_plateaus(int origen, int destino, const OpcionesAlternativas& opciones,
+                                        ConjuntoRutas& rutas) const {
+    rutas.reiniciar();
+    VistaGrande vista = grafo->vista();
+    const int n = vista.num_nodos();
+    if (opciones.k < 1 || !grafo->puede_alcanzar(origen, destino)) return;
+
+    EspacioAlternativas& espacio = espacio_alternativas;
+    espacio.preparar(n);
+    ArbolCaminos& desde_origen = espacio.desde_origen;
+    ArbolCaminos& hacia_destino = espacio.hacia_destino;
+
+    // Los dos arboles comparten el limite: el primero que alcanza el otro extremo lo fija
+    const float estiramiento = max(1.0f, opciones.estiramiento_max);
+    const VistaGrande inversa = grafo->vista_inversa();
+    atomic<float> limite(INFINITO_ALTERNATIVAS);
+    if (opciones.hilos > 1) {
+        #pragma omp parallel sections num_threads(2)
+        {
+            #pragma omp section
+            construir_arbol(inversa, destino, origen, estiramiento, limite, hacia_destino);
+            #pragma omp section
+            construir_arbol(vista, origen, destino, estiramiento, limite, desde_origen);
+        }
+    } else {
+        construir_arbol(inversa, destino, origen, estiramiento, limite, hacia_destino);
+        construir_arbol(vista, origen, destino, estiramiento, limite, desde_origen);
+    }
+    rutas.nodos_asentados = desde_origen.num_asentados + hacia_destino.num_asentados;
+    if (!hacia_destino.es_asentado(origen) || !desde_origen.es_asentado(destino)) return;
+
+    const float d = hacia_destino.distancia(origen);
+    const float tope = limite.load();
+    auto df = [&](int v) { return desde_origen.distancia(v); };
+    auto db = [&](int v) { return hacia_destino.distancia(v); };
+
+    // Una arista u -> v esta en un plateau si es del arbol desde el origen
+    // (padre de v) y del arbol hacia el destino (siguiente de u). En orden de
+    // asentamiento el padre va antes, asi que cada nodo hereda el inicio de su
+    // plateau y el ultimo en llegar queda como fin.
+    int* inicio = espacio.inicio.data();
+    int* fin = espacio.fin.data();
+    for (int k = 0; k < desde_origen.num_asentados; ++k) {
+        int v = desde_origen.orden[k];
+        if (!hacia_destino.es_asentado(v) || df(v) + db(v) > tope) {
+            inicio[v] = -1;
+            continue;
+        }
+        int u = desde_origen.padre(v);
+        inicio[v] = (u >= 0 && inicio[u] >= 0 && hacia_destino.padre(u) == v) ? inicio[u] : v;
+        fin[inicio[v]] = v;
+    }
+
+    struct Plateau {
+        float costo;
+        int inicio;
+    };
+    vector<Plateau> plateaus;
+    for (int k = 0; k < desde_origen.num_asentados; ++k) {
+        int v = desde_origen.orden[k];
+        if (inicio[v] != v) continue;
+        if (df(fin[v]) - df(v) < opciones.plateau_min * d) continue;
+        plateaus.push_back({ df(v) + db(v), v });
+    }
+    sort(plateaus.begin(), plateaus.end(), [](const Plateau& a, const Plateau& b) {
+        return a.costo < b.costo || (a.costo == b.costo && a.inicio < b.inicio);
+    });
+
+    // Rutas por el inicio de cada plateau: arbol desde el origen hasta el, arbol
+    // hacia el destino desde ahi. Aristas de las elegidas ordenadas por clave.
+    auto clave = [](int u, int v) { return ((uint64_t)(uint32_t)u << 32) | (uint32_t)v; };
+    vector<vector<uint64_t>> aristas_elegidas;
+    vector<int> camino, ordenados;
+    for (const Plateau& p : plateaus) {
+        if (rutas.cantidad() >= opciones.k) break;
+
+        camino.clear();
+        for (int v = p.inicio; v != -1; v = desde_origen.padre(v)) {
+            camino.push_back(v);
+        }
+        reverse(camino.begin(), camino.end());
+        const int union_arboles = camino.size() - 1;
+        for (int v = hacia_destino.padre(p.inicio); v != -1; v = hacia_destino.padre(v)) {
+            camino.push_back(v);
+        }
+
+        // Los dos arboles pueden cruzarse: la ruta no seria simple
+        ordenados = camino;
+        sort(ordenados.begin(), ordenados.end());
+        if (adjacent_find(ordenados.begin(), ordenados.end()) != ordenados.end()) continue;
+
+        bool aceptada = true;
+        for (const vector<uint64_t>& elegida : aristas_elegidas) {
+            float compartido = 0.0f;
+            for (size_t q = 0; q + 1 < camino.size(); ++q) {
+                int a = camino[q], b = camino[q + 1];
+                if (binary_search(elegida.begin(), elegida.end(), clave(a, b))) {
+                    compartido += (int)q < union_arboles ? df(b) - df(a) : db(a) - db(b);
+                }
+            }
+            if (compartido > opciones.compartido_max * p.costo) {
+                aceptada = false;
+                break;
+            }
+        }
+        if (!aceptada) continue;
+
+        rutas.agregar(camino.data(), camino.size(), p.costo);
+        vector<uint64_t> aristas;
+        for (size_t q = 0; q + 1 < camino.size(); ++q) {
+            aristas.push_back(clave(camino[q], camino[q + 1]));
+        }
+        sort(aristas.begin(), aristas.end());
+        aristas_elegidas.push_back(move(aristas));
+    }
+}
+
+size_t MotorAlternativas::memoria_usada() const {
+    return grafo->memoria_transpuesto();
+}
+
+unique_ptr<MotorAlternativas> construir_motor_alternativas(const GrafoGrande& grafo) {
+    cout << "=== CONSTRUYENDO MOTOR DE RUTAS ALTERNATIVAS ===" << endl;
+    auto motor = make_unique<MotorAlternativas>(grafo);
+    if (!motor->construir()) {
+        return nullptr;
+    }
+    cout << "Grafo transpuesto: " << (motor->memoria_usada() / 1024.0 / 1024.0) << " MB" << endl;
+    return motor;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "grafo_grande.h"
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+// Rutas alternativas sobre GrafoGrande.
+//
+// Los dos metodos parten del mismo estado: un arbol de caminos minimos hacia el
+// destino (Dijkstra sobre el grafo transpuesto) acotado al radio
+// estiramiento_max * d(origen, destino). Ninguna ruta aceptable sale de ese radio.
+//  - Yen: las K rutas simples mas cortas dentro del radio. Cada desvio es un A*
+//    con la distancia exacta del arbol como heuristica, asi que sin bloqueos
+//    avanza en linea recta hacia el destino. Los desvios de una iteracion son
+//    independientes y se reparten en el pool de OpenMP; cada hilo reutiliza
+//    su espacio entre iteraciones y consultas (sellos de generacion).
+//  - Plateaus: un arbol desde el origen y otro hacia el destino, en paralelo.
+//    Los tramos que ambos arboles comparten ("plateaus") definen rutas por un
+//    nodo intermedio; se aceptan en orden de costo si cumplen los limites de
+//    estiramiento, de costo compartido con las ya elegidas y de largo minimo
+//    del plateau (rutas que no son un rodeo local). Cuesta unas dos consultas.
+
+struct OpcionesAlternativas {
+    int k = 3;                       // Rutas pedidas, incluida la mas corta
+    float estiramiento_max = 1.3f;   // Costo maximo relativo a la ruta mas corta
+    float compartido_max = 0.6f;     // Plateaus: fraccion del costo compartida con una ruta ya elegida
+    float plateau_min = 0.1f;        // Plateaus: largo minimo del plateau relativo a la ruta mas corta
+    int hilos = 1;                   // Hilos por consulta (desvios de Yen, arboles de plateaus)
+};
+
+// Rutas de una consulta, de menor a mayor costo. Lo crea quien llama y se
+// reutiliza: los buffers solo crecen.
+class ConjuntoRutas {
+private:
+    std::vector<int> nodos;          // Rutas concatenadas
+    std::vector<int> inicios{0};     // Ruta r: nodos[inicios[r], inicios[r + 1])
+    std::vector<float> costos;
+
+public:
+    int nodos_asentados = 0;         // Suma de todas las busquedas de la consulta
+
+    void reiniciar() {
+        nodos.clear();
+        inicios.assign(1, 0);
+        costos.clear();
+        nodos_asentados = 0;
+    }
+
+    void agregar(const int* camino, int largo, float costo) {
+        nodos.insert(nodos.end(), camino, camino + largo);
+        inicios.push_back(nodos.size());
+        costos.push_back(costo);
+    }
+
+    int cantidad() const { return costos.size(); }
+    const int* ruta(int r) const { return nodos.data() + inicios[r]; }
+    int largo(int r) const { return inicios[r + 1] - inicios[r]; }
+    float costo(int r) const { return costos[r]; }
+};
+
+// Busca hacia atras sobre el transpuesto del grafo (GrafoGrande::vista_inversa,
+// la mitad del costo de memoria del grafo y compartido con instalaciones.h).
+// Apunta al grafo sobre el que se construyo.
+class MotorAlternativas {
+private:
+    const GrafoGrande* grafo;
+
+public:
+    explicit MotorAlternativas(const GrafoGrande& g);
+
+    bool construir();
+
+    void buscar_yen(int origen, int destino, const OpcionesAlternativas& opciones, ConjuntoRutas& rutas) const;
+    void buscar_plateaus(int origen, int destino, const OpcionesAlternativas& opciones, ConjuntoRutas& rutas) const;
+
+    size_t memoria_usada() const;
+};
+
+// nullptr si la construccion falla. El grafo debe vivir al menos lo mismo que el motor.
+std::unique_ptr<MotorAlternativas> construir_motor_alternativas(const GrafoGrande& grafo);
@@ -0,0 +1,576 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "grafo_grande.h"
+#include "importador_json.h"
+#include "overlay_particiones.h"
+#include "registro_grafos.h"
+#include "protocolo_rutas.h"
+#include "arena.h"
+#include "ubicacion_memoria.h"
+
+using namespace std;
+using namespace chrono;
+
+// Servidor de rutas de larga duracion: carga los grafos una vez y atiende
+// solicitudes binarias (protocolo_rutas.h) por un socket Unix o por stdin/stdout.
+//
+//  - Un hilo lector por conexion; las solicitudes se encolan sin esperar
+//    respuesta, asi que el cliente puede mandar muchas seguidas (pipelining).
+//    La cola global tiene tope (--max-cola): cuando se llena los lectores dejan
+//    de leer y el cliente queda frenado por su propio socket.
+//  - Los descriptores son no bloqueantes. Si un cliente no lee sus respuestas
+//    durante --plazo-escritura ms se cierra su conexion y sus solicitudes
+//    pendientes se descartan, en vez de dejar a un trabajador bloqueado.
+//  - Un pool fijo de trabajadores toma lotes de la cola global. Un lote mezcla
+//    solicitudes de varios clientes y las respuestas de cada conexion se
+//    escriben juntas con una sola llamada.
+//  - Los grafos viven en un RegistroGrafos (registro_grafos.h): el principal
+//    (id 0) y los que se agregan con --grafo NOMBRE=SNAPSHOT (ids 1, 2...), por
+//    ejemplo otra ciudad o los mismos nodos con pesos de peaton. Cada solicitud
+//    indica el id en su campo 'grafo'.
+//  - SIGHUP recarga todos los grafos en segundo plano y publica cada version
+//    nueva de forma atomica: las solicitudes siguen atendiendose, las que estaban
+//    en curso terminan con la version anterior y esta se libera al final.
+//  - SIGINT/SIGTERM: deja de aceptar, atiende lo encolado y termina. Con
+//    --stdio es igual: SIGHUP recarga y SIGTERM deja de leer stdin.
+
+// Grafo adicional servido desde un snapshot (--grafo NOMBRE=ARCHIVO)
+struct FuenteGrafo {
+    string nombre;
+    string archivo;
+};
+
+struct ConfiguracionServidor {
+    string socket = "/tmp/rutas.sock";
+    string snapshot;             // Cargar grafo desde snapshot en vez de generarlo
+    string importar;             // O importarlo del JSON de calles (importador_json.h)
+    string guardar_snapshot;     // Guardar el grafo generado para arranques rapidos
+    vector<FuenteGrafo> grafos_extra;
+    bool malla = false;
+    bool crp = false;
+    bool stdio = false;
+    bool paginas_grandes = false;  // Arenas de los trabajadores con paginas de 2 MB (THP)
+    bool fijar_hilos = false;      // Un trabajador por CPU, en orden circular
+    UbicacionGrafo ubicacion;      // Donde quedan los arreglos de cada grafo publicado
+    uint32_t semilla = SEMILLA_GRAFO_DEFECTO;   // Grafo generado (sin snapshot)
+    int64_t nodos = 0;           // Tamano del grafo generado (0: el por defecto)
+    int hilos = max(1u, thread::hardware_concurrency());
+    int tam_lote = 32;
+    int max_cola = 4096;         // Solicitudes encoladas antes de frenar a los lectores
+    int plazo_escritura_ms = 2000;  // Sin poder escribir a un cliente este tiempo se lo desconecta
+    int max_nodos = 0;           // Nodos asentados por busqueda antes de abandonarla (0: sin limite)
+};
+
+// Los descriptores pasan a no bloqueantes; los de stdin/stdout recuperan sus
+// banderas al final porque se comparten con el proceso que lanzo al servidor.
+struct Conexion {
+    int fd_entrada;
+    int fd_salida;
+    int banderas_entrada, banderas_salida;
+    mutex escritura;
+    atomic<bool> activa{true};
+
+    Conexion(int entrada, int salida) : fd_entrada(entrada), fd_salida(salida) {
+        banderas_entrada = fcntl(fd_entrada, F_GETFL);
+        banderas_salida = fcntl(fd_salida, F_GETFL);
+        fcntl(fd_entrada, F_SETFL, banderas_entrada | O_NONBLOCK);
+        fcntl(fd_salida, F_SETFL, banderas_salida | O_NONBLOCK);
+    }
+    ~Conexion() {
+        if (fd_entrada > 2) close(fd_entrada);
+        else fcntl(fd_entrada, F_SETFL, banderas_entrada);
+        if (fd_salida > 2 && fd_salida != fd_entrada) close(fd_salida);
+        else if (fd_salida <= 2) fcntl(fd_salida, F_SETFL, banderas_salida);
+    }
+
+    // Corta la conexion: el lector sale de su espera y las respuestas se descartan
+    void cerrar() {
+        activa = false;
+        ::shutdown(fd_entrada, SHUT_RDWR);
+    }
+};
+
+struct SolicitudPendiente {
+    shared_ptr<Conexion> conexion;
+    SolicitudRuta solicitud;
+};
+
+// Cola global de solicitudes compartida por todas las conexiones. Con
+// 'capacidad' solicitudes encoladas, agregar() espera a que los trabajadores
+// saquen un lote (un bloque de un lector puede pasarse del tope).
+class ColaSolicitudes {
+private:
+    mutex m;
+    condition_variable cv;
+    condition_variable cv_espacio;
+    deque<SolicitudPendiente> cola;
+    size_t capacidad;
+    bool cerrada = false;
+
+public:
+    explicit ColaSolicitudes(size_t capacidad) : capacidad(capacidad) {}
+
+    void agregar(vector<SolicitudPendiente>& nuevas) {
+        {
+            unique_lock<mutex> lock(m);
+            cv_espacio.wait(lock, [this] { return cola.size() < capacidad || cerrada; });
+            for (auto& s : nuevas) cola.push_back(move(s));
+        }
+        if (nuevas.size() > 1) cv.notify_all();
+        else cv.notify_one();
+        nuevas.clear();
+    }
+
+    // Bloquea hasta tener al menos una solicitud; devuelve false si la cola se cerro y esta vacia
+    bool extraer_lote(vector<SolicitudPendiente>& lote, size_t max_lote) {
+        unique_lock<mutex> lock(m);
+        cv.wait(lock, [this] { return !cola.empty() || cerrada; });
+        if (cola.empty()) return false;
+
+        size_t n = min(max_lote, cola.size());
+        for (size_t i = 0; i < n; ++i) {
+            lote.push_back(move(cola.front()));
+            cola.pop_front();
+        }
+        lock.unlock();
+        cv_espacio.notify_all();
+        return true;
+    }
+
+    void cerrar() {
+        {
+            lock_guard<mutex> lock(m);
+            cerrada = true;
+        }
+        cv.notify_all();
+        cv_espacio.notify_all();
+    }
+};
+
+// Estado global del servidor
+static volatile sig_atomic_t senal_detener = 0;
+static volatile sig_atomic_t senal_recargar = 0;
+static RegistroGrafos registro;
+static const char* NOMBRE_GRAFO_PRINCIPAL = "principal";
+static atomic<bool> recarga_en_curso{false};
+static atomic<uint64_t> solicitudes_atendidas{0};
+
+static void manejar_senal(int senal) {
+    if (senal == SIGHUP) senal_recargar = 1;
+    else senal_detener = 1;
+}
+
+static AlgoritmoRuta parsear_algoritmo(uint8_t codigo, bool& valido) {
+    valido = codigo <= static_cast<uint8_t>(AlgoritmoRuta::CRP);
+    return static_cast<AlgoritmoRuta>(codigo);
+}
+
+// Atiende una solicitud y agrega la respuesta (cabecera + camino opcional) al buffer
+static void procesar_solicitud(const SolicitudRuta& sol, ResultadoRuta& ruta, vector<char>& salida) {
+    RespuestaRuta resp;
+    memset(&resp, 0, sizeof(resp));
+    resp.id = sol.id;
+
+    bool valido = false;
+    AlgoritmoRuta algoritmo = parsear_algoritmo(sol.algoritmo, valido);
+
+    // El snapshot queda vivo hasta terminar esta solicitud aunque se publique otro
+    ManejadorGrafo snapshot = registro.obtener(sol.grafo);
+    int num_nodos = snapshot ? snapshot->grafo->get_num_nodos_reales() : 0;
+
+    if (!valido || sol.origen < 0 || sol.origen >= num_nodos || sol.destino < 0 || sol.destino >= num_nodos) {
+        resp.estado = static_cast<uint8_t>(EstadoRespuesta::SOLICITUD_INVALIDA);
+    } else if (algoritmo == AlgoritmoRuta::CRP && !snapshot->overlay) {
+        resp.estado = static_cast<uint8_t>(EstadoRespuesta::NO_DISPONIBLE);
+    } else {
+        const GrafoGrande& grafo = *snapshot->grafo;
+        auto inicio = steady_clock::now();
+
+        switch (algoritmo) {
+            case AlgoritmoRuta::BFS:        buscar_BFS_grande(grafo, sol.origen, sol.destino, ruta); break;
+            case AlgoritmoRuta::DFS:        buscar_DFS_grande(grafo, sol.origen, sol.destino, ruta); break;
+            case AlgoritmoRuta::BEST_FIRST: buscar_BestFirst_grande(grafo, sol.origen, sol.destino, ruta); break;
+            case AlgoritmoRuta::DIJKSTRA:   buscar_Dijkstra_grande(grafo, sol.origen, sol.destino, ruta); break;
+            case AlgoritmoRuta::ASTAR:      buscar_AStar_grande(grafo, sol.origen, sol.destino, ruta); break;
+            case AlgoritmoRuta::CRP:        buscar_CRP_grande(*snapshot->overlay, sol.origen, sol.destino, ruta); break;
+        }
+
+        auto fin = steady_clock::now();
+        resp.tiempo_us = duration_cast<microseconds>(fin - inicio).count();
+        resp.largo = ruta.largo();
+        resp.costo = ruta.costo;
+        switch (ruta.estado) {
+            case EstadoRuta::ENCONTRADA:          resp.estado = static_cast<uint8_t>(EstadoRespuesta::ENCONTRADO); break;
+            case EstadoRuta::SIN_CAMINO:          resp.estado = static_cast<uint8_t>(EstadoRespuesta::SIN_CAMINO); break;
+            case EstadoRuta::PRESUPUESTO_AGOTADO: resp.estado = static_cast<uint8_t>(EstadoRespuesta::PRESUPUESTO_AGOTADO); break;
+        }
+        if (sol.opciones & SOLICITUD_INCLUIR_CAMINO) {
+            resp.nodos_enviados = ruta.largo();
+        }
+    }
+
+    const char* cabecera = reinterpret_cast<const char*>(&resp);
+    salida.insert(salida.end(), cabecera, cabecera + sizeof(resp));
+    if (resp.nodos_enviados > 0) {
+        const char* nodos = reinterpret_cast<const char*>(ruta.camino());
+        salida.insert(salida.end(), nodos, nodos + resp.nodos_enviados * sizeof(int32_t));
+    }
+}
+
+static void trabajador(ColaSolicitudes& cola, const ConfiguracionServidor& config, int cpu) {
+    if (cpu >= 0) fijar_hilo_a_cpu(cpu);
+
+    // Espacio de trabajo propio del hilo, reutilizado entre solicitudes
+    ResultadoRuta ruta;
+    ruta.limite_nodos = config.max_nodos;
+    vector<char> salida;
+    vector<SolicitudPendiente> lote;
+    lote.reserve(config.tam_lote);
+
+    while (cola.extraer_lote(lote, config.tam_lote)) {
+        // Agrupar por conexion para escribir una sola vez a cada cliente
+        stable_sort(lote.begin(), lote.end(), [](const SolicitudPendiente& a, const SolicitudPendiente& b) {
+            return a.conexion.get() < b.conexion.get();
+        });
+
+        size_t i = 0;
+        while (i < lote.size()) {
+            Conexion* conexion = lote[i].conexion.get();
+            salida.clear();
+
+            // Las solicitudes de una conexion ya cerrada se descartan sin buscar
+            size_t j = i;
+            for (; j < lote.size() && lote[j].conexion.get() == conexion; ++j) {
+                if (conexion->activa) procesar_solicitud(lote[j].solicitud, ruta, salida);
+            }
+
+            if (conexion->activa) {
+                lock_guard<mutex> escritura(conexion->escritura);
+                if (!escribir_con_plazo(conexion->fd_salida, salida.data(), salida.size(),
+                                        config.plazo_escritura_ms)) {
+                    cerr << "Cliente sin leer sus respuestas, se cierra la conexion" << endl;
+                    conexion->cerrar();
+                }
+                solicitudes_atendidas += j - i;
+            }
+            i = j;
+        }
+
+        lote.clear();
+    }
+}
+
+struct HiloLector {
+    thread hilo;
+    shared_ptr<atomic<bool>> terminado;
+};
+
+// Lee solicitudes de una conexion por bloques y las encola sin esperar
+// respuestas. Revisa senal_detener cada 200 ms aunque el cliente no mande nada.
+static void lector(shared_ptr<Conexion> conexion, ColaSolicitudes& cola, shared_ptr<atomic<bool>> terminado) {
+    vector<char> buffer(64 * sizeof(SolicitudRuta));
+    vector<SolicitudPendiente> nuevas;
+    size_t pendientes = 0;
+
+    while (conexion->activa && !senal_detener) {
+        pollfd pfd = {conexion->fd_entrada, POLLIN, 0};
+        if (poll(&pfd, 1, 200) <= 0) continue;
+        ssize_t n = ::read(conexion->fd_entrada, buffer.data() + pendientes, buffer.size() - pendientes);
+        if (n < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) continue;
+        if (n <= 0) break;
+        pendientes += n;
+
+        size_t completas = pendientes / sizeof(SolicitudRuta);
+        for (size_t k = 0; k < completas; ++k) {
+            SolicitudRuta sol;
+            memcpy(&sol, buffer.data() + k * sizeof(SolicitudRuta), sizeof(sol));
+            if (sol.magia != PROTOCOLO_MAGIA) {
+                cerr << "Solicitud con firma invalida, cerrando conexion" << endl;
+                conexion->activa = false;
+                break;
+            }
+            nuevas.push_back({conexion, sol});
+        }
+        if (!nuevas.empty()) cola.agregar(nuevas);
+
+        size_t consumidos = completas * sizeof(SolicitudRuta);
+        memmove(buffer.data(), buffer.data() + consumidos, pendientes - consumidos);
+        pendientes -= consumidos;
+    }
+    *terminado = true;
+}
+
+// Construye el grafo principal segun la configuracion (snapshot, JSON, malla o sintetico)
+static unique_ptr<GrafoGrande> construir_grafo_principal(const ConfiguracionServidor& config) {
+    if (!config.snapshot.empty()) {
+        return cargar_grafo_desde_archivo(config.snapshot);
+    } else if (!config.importar.empty()) {
+        return importar_grafo_json(config.importar);
+    }
+    return generar_grafo_de_tamano(config.semilla, config.malla, config.nodos);
+}
+
+// Arma el overlay (si se pidio CRP) y publica el par como nueva version de 'nombre'
+static bool publicar_grafo(const string& nombre, unique_ptr<GrafoGrande> grafo, const ConfiguracionServidor& config) {
+    if (!grafo) return false;
+
+    const UbicacionGrafo& ubicacion = config.ubicacion;
+    if (ubicacion.paginas != PaginasGrafo::NORMALES || ubicacion.numa != DistribucionNuma::PRIMER_TOQUE) {
+        grafo->ubicar(ubicacion);
+    }
+    bool crp = config.crp;
+    shared_ptr<const GrafoGrande> compartido = move(grafo);
+    shared_ptr<const OverlayParticiones> overlay;
+    if (crp) {
+        overlay = construir_overlay_particiones(*compartido);
+        if (!overlay) {
+            cerr << "No se pudo construir el overlay de '" << nombre << "', CRP no disponible" << endl;
+        }
+    }
+
+    int id = registro.publicar(nombre, compartido, overlay);
+    if (id < 0) {
+        cerr << "No se pudo registrar el grafo '" << nombre << "' (maximo " << MAX_GRAFOS_REGISTRO << ")" << endl;
+        return false;
+    }
+    ManejadorGrafo snapshot = registro.obtener(id);
+    cout << "Grafo " << id << " '" << nombre << "' v" << snapshot->version << ": "
+         << snapshot->grafo->get_num_nodos_reales() << " nodos"
+         << (snapshot->overlay ? ", con CRP" : "") << ", memoria " << nombre_ubicacion(snapshot->grafo->get_ubicacion()) << endl;
+    return true;
+}
+
+// Carga (o recarga) todos los grafos. El principal se publica primero para que tenga el id 0.
+static bool cargar_grafos(const ConfiguracionServidor& config) {
+    bool ok = publicar_grafo(NOMBRE_GRAFO_PRINCIPAL, construir_grafo_principal(config), config);
+    for (const FuenteGrafo& fuente : config.grafos_extra) {
+        ok = publicar_grafo(fuente.nombre, cargar_grafo_desde_archivo(fuente.archivo), config) && ok;
+    }
+    return ok;
+}
+
+// Se construye todo fuera de cualquier bloqueo mientras se siguen atendiendo
+// solicitudes; si un grafo falla se mantiene su version anterior.
+static void recargar_grafos(const ConfiguracionServidor& config) {
+    cout << "\n=== RECARGANDO GRAFOS ===" << endl;
+    auto inicio = steady_clock::now();
+
+    if (!cargar_grafos(config)) {
+        cerr << "Error al recargar algun grafo, se mantiene su version anterior" << endl;
+    }
+
+    auto fin = steady_clock::now();
+    cout << "Recarga completada en " << duration_cast<milliseconds>(fin - inicio).count() << " ms" << endl;
+    recarga_en_curso = false;
+}
+
+static int crear_socket(const string& ruta) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+
+    sockaddr_un direccion;
+    memset(&direccion, 0, sizeof(direccion));
+    direccion.sun_family = AF_UNIX;
+    if (ruta.size() >= sizeof(direccion.sun_path)) {
+        cerr << "Ruta de socket demasiado larga: " << ruta << endl;
+        close(fd);
+        return -1;
+    }
+    strncpy(direccion.sun_path, ruta.c_str(), sizeof(direccion.sun_path) - 1);
+
+    unlink(ruta.c_str());
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&direccion), sizeof(direccion)) < 0 || listen(fd, 128) < 0) {
+        perror("bind/listen");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void mostrar_uso() {
+    cout << "Uso: servidor_rutas [opciones]\n"
+         << "  --socket RUTA          Socket Unix (por defecto /tmp/rutas.sock)\n"
+         << "  --stdio                Atender por stdin/stdout en vez de socket\n"
+         << "  --snapshot ARCHIVO     Cargar grafo desde snapshot binario\n"
+         << "  --importar ARCHIVO     Importar el grafo del JSON de calles (nodes/edges)\n"
+         << "  --guardar-snapshot AR  Guardar el grafo generado en un snapshot\n"
+         << "  --grafo NOMBRE=AR      Servir tambien el snapshot AR como grafo NOMBRE (ids 1, 2...)\n"
+         << "  --malla                Generar el grafo con malla de obstaculos\n"
+         << "  --crp                  Construir el overlay multinivel (algoritmo CRP)\n"
+         << "  --semilla N            Semilla del grafo generado (por defecto " << SEMILLA_GRAFO_DEFECTO << ")\n"
+         << "  --nodos N              Nodos del grafo generado (malla: lado para unos N libres)\n"
+         << "  --hilos N              Trabajadores (por defecto: nucleos)\n"
+         << "  --lote N               Maximo de solicitudes por lote (por defecto 32)\n"
+         << "  --max-cola N           Solicitudes encoladas antes de dejar de leer (por defecto 4096)\n"
+         << "  --plazo-escritura MS   Desconectar al cliente que no lee sus respuestas en MS (por defecto 2000)\n"
+         << "  --paginas-grandes      Memoria temporal de las busquedas en paginas de 2 MB\n"
+         << "  --ubicacion U          Memoria de los grafos: normal, thp, hugetlb, entrelazada,\n"
+         << "                         replicas o combinaciones (thp+replicas)\n"
+         << "  --fijar-hilos          Fijar cada trabajador a una CPU\n"
+         << "  --max-nodos N          Abandonar la busqueda tras asentar N nodos (por defecto sin limite)\n";
+}
+
+int main(int argc, char* argv[]) {
+    ConfiguracionServidor config;
+
+    for (int i = 1; i < argc; ++i) {
+        string opcion = argv[i];
+        bool hay_valor = i + 1 < argc;
+        if (opcion == "--socket" && hay_valor) config.socket = argv[++i];
+        else if (opcion == "--snapshot" && hay_valor) config.snapshot = argv[++i];
+        else if (opcion == "--importar" && hay_valor) config.importar = argv[++i];
+        else if (opcion == "--guardar-snapshot" && hay_valor) config.guardar_snapshot = argv[++i];
+        else if (opcion == "--grafo" && hay_valor && strchr(argv[i + 1], '=')) {
+            string valor = argv[++i];
+            size_t igual = valor.find('=');
+            config.grafos_extra.push_back({valor.substr(0, igual), valor.substr(igual + 1)});
+        }
+        else if (opcion == "--hilos" && hay_valor) config.hilos = max(1, atoi(argv[++i]));
+        else if (opcion == "--lote" && hay_valor) config.tam_lote = max(1, atoi(argv[++i]));
+        else if (opcion == "--max-cola" && hay_valor) config.max_cola = max(1, atoi(argv[++i]));
+        else if (opcion == "--plazo-escritura" && hay_valor) config.plazo_escritura_ms = max(1, atoi(argv[++i]));
+        else if (opcion == "--max-nodos" && hay_valor) config.max_nodos = max(0, atoi(argv[++i]));
+        else if (opcion == "--semilla" && hay_valor) config.semilla = strtoul(argv[++i], nullptr, 10);
+        else if (opcion == "--nodos" && hay_valor) config.nodos = max(0LL, atoll(argv[++i]));
+        else if (opcion == "--malla") config.malla = true;
+        else if (opcion == "--crp") config.crp = true;
+        else if (opcion == "--stdio") config.stdio = true;
+        else if (opcion == "--paginas-grandes") config.paginas_grandes = true;
+        else if (opcion == "--fijar-hilos") config.fijar_hilos = true;
+        else if (opcion == "--ubicacion" && hay_valor && parsear_ubicacion(argv[i + 1], config.ubicacion)) ++i;
+        else {
+            mostrar_uso();
+            return 1;
+        }
+    }
+
+    // En modo stdio la salida estandar es el canal binario: los mensajes van a stderr
+    if (config.stdio) {
+        cout.rdbuf(cerr.rdbuf());
+    }
+
+    cout << "=== SERVIDOR DE RUTAS ===" << endl;
+    if (!cargar_grafos(config)) {
+        cerr << "Error al cargar los grafos" << endl;
+        return 1;
+    }
+    if (!config.guardar_snapshot.empty()) {
+        guardar_grafo_en_archivo(*registro.obtener(0)->grafo, config.guardar_snapshot);
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    struct sigaction accion;
+    memset(&accion, 0, sizeof(accion));
+    accion.sa_handler = manejar_senal;
+    sigaction(SIGINT, &accion, nullptr);
+    sigaction(SIGTERM, &accion, nullptr);
+    sigaction(SIGHUP, &accion, nullptr);
+
+    configurar_arenas(TAM_BLOQUE_ARENA, config.paginas_grandes);
+    ColaSolicitudes cola(config.max_cola);
+    vector<thread> trabajadores;
+    vector<int> cpus;
+    if (config.fijar_hilos) cpus = cpus_del_proceso();
+    for (int t = 0; t < config.hilos; ++t) {
+        int cpu = cpus.empty() ? -1 : cpus[t % cpus.size()];
+        trabajadores.emplace_back(trabajador, ref(cola), cref(config), cpu);
+    }
+
+    auto inicio_servicio = steady_clock::now();
+
+    // En modo stdio la unica conexion es stdin/stdout y el servidor termina
+    // cuando se cierra; el resto (senales, recargas) es igual que con socket
+    int fd_escucha = -1;
+    vector<HiloLector> lectores;
+    thread hilo_recarga;
+    if (config.stdio) {
+        cout << "Atendiendo por stdin/stdout con " << config.hilos << " trabajadores" << endl;
+        auto conexion = make_shared<Conexion>(STDIN_FILENO, STDOUT_FILENO);
+        auto terminado = make_shared<atomic<bool>>(false);
+        lectores.push_back({thread(lector, conexion, ref(cola), terminado), terminado});
+    } else {
+        fd_escucha = crear_socket(config.socket);
+        if (fd_escucha < 0) {
+            cola.cerrar();
+            for (auto& t : trabajadores) t.join();
+            return 1;
+        }
+        cout << "Escuchando en " << config.socket << " con " << config.hilos
+             << " trabajadores (lote maximo " << config.tam_lote << ")" << endl;
+    }
+
+    while (!senal_detener) {
+        if (senal_recargar) {
+            senal_recargar = 0;
+            if (!recarga_en_curso.exchange(true)) {
+                if (hilo_recarga.joinable()) hilo_recarga.join();
+                hilo_recarga = thread(recargar_grafos, cref(config));
+            }
+        }
+
+        // Liberar lectores de conexiones cerradas
+        for (size_t k = 0; k < lectores.size();) {
+            if (*lectores[k].terminado) {
+                lectores[k].hilo.join();
+                lectores[k] = move(lectores.back());
+                lectores.pop_back();
+            } else {
+                ++k;
+            }
+        }
+
+        if (config.stdio) {
+            if (lectores.empty()) break;     // stdin se cerro
+            poll(nullptr, 0, 200);           // Una senal la interrumpe antes
+            continue;
+        }
+
+        pollfd pfd = {fd_escucha, POLLIN, 0};
+        if (poll(&pfd, 1, 200) <= 0) continue;
+
+        int fd_cliente = accept(fd_escucha, nullptr, nullptr);
+        if (fd_cliente < 0) continue;
+
+        auto conexion = make_shared<Conexion>(fd_cliente, fd_cliente);
+        auto terminado = make_shared<atomic<bool>>(false);
+        lectores.push_back({thread(lector, conexion, ref(cola), terminado), terminado});
+    }
+
+    cout << "\nDeteniendo servidor..." << endl;
+    if (fd_escucha >= 0) {
+        close(fd_escucha);
+        unlink(config.socket.c_str());
+    }
+
+    // Los lectores ven senal_detener en su proxima espera (200 ms como maximo)
+    for (auto& l : lectores) l.hilo.join();
+    if (hilo_recarga.joinable()) hilo_recarga.join();
+
+    // Atender lo que quede en la cola y terminar
+    cola.cerrar();
+    for (auto& t : trabajadores) t.join();
+
+    double segundos = duration_cast<milliseconds>(steady_clock::now() - inicio_servicio).count() / 1000.0;
+    cout << "Solicitudes atendidas: " << solicitudes_atendidas << " en " << segundos << " s" << endl;
+
+    return 0;
+}
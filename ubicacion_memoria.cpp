@@ -0,0 +1,230 @@
+#include "ubicacion_memoria.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sched.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+const size_t PAGINA_GRANDE = (size_t)2 << 20;
+
+// Modos de mbind (linux/mempolicy.h); se definen aqui para no depender de libnuma
+const int MPOL_BIND_LOCAL = 2;
+const int MPOL_INTERLEAVE_LOCAL = 3;
+const int MAX_NODOS_MASCARA = 64;
+
+size_t redondear(size_t bytes, size_t multiplo) {
+    return (bytes + multiplo - 1) / multiplo * multiplo;
+}
+
+thread_local int nodo_hilo = -1;
+
+#ifndef _WIN32
+// Nodo NUMA de la CPU en la que corre el hilo ahora mismo
+int consultar_nodo_actual() {
+#ifdef SYS_getcpu
+    unsigned cpu = 0, nodo = 0;
+    if (syscall(SYS_getcpu, &cpu, &nodo, nullptr) == 0) {
+        return (int)nodo;
+    }
+#endif
+    return 0;
+}
+
+bool aplicar_mbind(void* base, size_t bytes, int modo, unsigned long mascara) {
+#ifdef SYS_mbind
+    return syscall(SYS_mbind, base, bytes, modo, &mascara, MAX_NODOS_MASCARA + 1, 0) == 0;
+#else
+    return false;
+#endif
+}
+#endif
+
+} // namespace
+
+bool parsear_ubicacion(const string& texto, UbicacionGrafo& ubicacion) {
+    UbicacionGrafo resultado;
+    stringstream partes(texto);
+    string parte;
+    bool alguna = false;
+    while (getline(partes, parte, '+')) {
+        if (parte == "normal") { /* valores por defecto */ }
+        else if (parte == "thp") resultado.paginas = PaginasGrafo::TRANSPARENTES;
+        else if (parte == "hugetlb") resultado.paginas = PaginasGrafo::EXPLICITAS;
+        else if (parte == "entrelazada") resultado.numa = DistribucionNuma::ENTRELAZADA;
+        else if (parte == "replicas") resultado.numa = DistribucionNuma::REPLICAS;
+        else return false;
+        alguna = true;
+    }
+    if (!alguna) return false;
+    ubicacion = resultado;
+    return true;
+}
+
+string nombre_ubicacion(const UbicacionGrafo& ubicacion) {
+    string nombre;
+    switch (ubicacion.paginas) {
+        case PaginasGrafo::NORMALES:      break;
+        case PaginasGrafo::TRANSPARENTES: nombre = "thp"; break;
+        case PaginasGrafo::EXPLICITAS:    nombre = "hugetlb"; break;
+    }
+    const char* numa = nullptr;
+    switch (ubicacion.numa) {
+        case DistribucionNuma::PRIMER_TOQUE: break;
+        case DistribucionNuma::ENTRELAZADA:  numa = "entrelazada"; break;
+        case DistribucionNuma::REPLICAS:     numa = "replicas"; break;
+    }
+    if (numa) nombre += nombre.empty() ? numa : string("+") + numa;
+    return nombre.empty() ? "normal" : nombre;
+}
+
+unique_ptr<RegionMemoria> RegionMemoria::crear(size_t bytes, PaginasGrafo paginas,
+                                               DistribucionNuma numa, int nodo) {
+    unique_ptr<RegionMemoria> region(new RegionMemoria());
+#ifdef _WIN32
+    (void)numa;
+    (void)nodo;
+    region->bytes = redondear(bytes, 64 * 1024);
+    region->base = VirtualAlloc(nullptr, region->bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if (!region->base) return nullptr;
+    region->paginas_efectivas = PaginasGrafo::NORMALES;
+#else
+    void* base = MAP_FAILED;
+    if (paginas == PaginasGrafo::EXPLICITAS) {
+#ifdef MAP_HUGETLB
+        region->bytes = redondear(bytes, PAGINA_GRANDE);
+        base = mmap(nullptr, region->bytes, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+        if (base == MAP_FAILED) {
+            cerr << "Sin paginas grandes reservadas (nr_hugepages), se usan paginas transparentes" << endl;
+            paginas = PaginasGrafo::TRANSPARENTES;
+        }
+    }
+    if (base == MAP_FAILED) {
+        size_t multiplo = paginas == PaginasGrafo::NORMALES ? (size_t)sysconf(_SC_PAGESIZE) : PAGINA_GRANDE;
+        region->bytes = redondear(bytes, multiplo);
+        base = mmap(nullptr, region->bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) return nullptr;
+#ifdef MADV_HUGEPAGE
+        if (paginas == PaginasGrafo::TRANSPARENTES) madvise(base, region->bytes, MADV_HUGEPAGE);
+#endif
+    }
+    region->base = base;
+    region->paginas_efectivas = paginas;
+
+    // La politica NUMA tiene que estar puesta antes del primer toque
+    int nodos = num_nodos_numa();
+    if (nodos > 1) {
+        bool ok = true;
+        if (numa == DistribucionNuma::ENTRELAZADA) {
+            unsigned long mascara = nodos >= MAX_NODOS_MASCARA ? ~0UL : (1UL << nodos) - 1;
+            ok = aplicar_mbind(base, region->bytes, MPOL_INTERLEAVE_LOCAL, mascara);
+        } else if (numa == DistribucionNuma::REPLICAS && nodo >= 0 && nodo < MAX_NODOS_MASCARA) {
+            ok = aplicar_mbind(base, region->bytes, MPOL_BIND_LOCAL, 1UL << nodo);
+        }
+        if (!ok) {
+            cerr << "mbind fallo (" << strerror(errno) << "), la region queda con la politica por defecto" << endl;
+        }
+    }
+#endif
+    return region;
+}
+
+RegionMemoria::~RegionMemoria() {
+    if (!base) return;
+#ifdef _WIN32
+    VirtualFree(base, 0, MEM_RELEASE);
+#else
+    munmap(base, bytes);
+#endif
+}
+
+void RegionMemoria::proteger_lectura() {
+#ifndef _WIN32
+    mprotect(base, bytes, PROT_READ);
+#endif
+}
+
+void RegionMemoria::permitir_escritura() {
+#ifndef _WIN32
+    mprotect(base, bytes, PROT_READ | PROT_WRITE);
+#endif
+}
+
+int num_nodos_numa() {
+#ifdef _WIN32
+    return 1;
+#else
+    // Formato de la lista: "0", "0-1", "0,2-3"...
+    static const int nodos = []() {
+        ifstream archivo("/sys/devices/system/node/online");
+        string lista;
+        if (!(archivo >> lista)) return 1;
+        int maximo = 0;
+        stringstream rangos(lista);
+        string rango;
+        while (getline(rangos, rango, ',')) {
+            size_t guion = rango.find('-');
+            int fin = atoi(guion == string::npos ? rango.c_str() : rango.c_str() + guion + 1);
+            if (fin > maximo) maximo = fin;
+        }
+        return maximo + 1;
+    }();
+    return nodos;
+#endif
+}
+
+vector<int> cpus_del_proceso() {
+    vector<int> cpus;
+#ifndef _WIN32
+    cpu_set_t mascara;
+    CPU_ZERO(&mascara);
+    if (sched_getaffinity(0, sizeof(mascara), &mascara) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &mascara)) cpus.push_back(cpu);
+        }
+    }
+#endif
+    return cpus;
+}
+
+bool fijar_hilo_a_cpu(int cpu) {
+#ifdef _WIN32
+    (void)cpu;
+    return false;
+#else
+    cpu_set_t mascara;
+    CPU_ZERO(&mascara);
+    CPU_SET(cpu, &mascara);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(mascara), &mascara) != 0) {
+        return false;
+    }
+    // El kernel ya migro el hilo: el nodo actual es el definitivo
+    nodo_hilo = consultar_nodo_actual();
+    return true;
+#endif
+}
+
+int nodo_numa_del_hilo() {
+#ifdef _WIN32
+    return 0;
+#else
+    if (nodo_hilo < 0) nodo_hilo = consultar_nodo_actual();
+    return nodo_hilo;
+#endif
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Ubicacion de los arreglos grandes en memoria fisica y afinidad de hilos.
+//
+// El grafo se construye en un solo hilo, asi que con la politica por defecto
+// del kernel (primer toque) todas sus paginas quedan en el nodo NUMA de ese
+// hilo y los trabajadores del otro socket leen cada arista de memoria remota.
+// Las politicas de aqui se aplican al terminar la construccion:
+//  - paginas: normales (4 KB), transparentes (THP, madvise) o explicitas
+//    (MAP_HUGETLB, requiere paginas reservadas en /proc/sys/vm/nr_hugepages;
+//    si no hay, se cae a THP),
+//  - NUMA: primer toque, entrelazada (las paginas rotan entre nodos) o una
+//    replica de solo lectura por nodo (cada hilo lee la de su nodo).
+// No usa libnuma: mbind y getcpu se llaman directamente. En un sistema de un
+// solo nodo (o sin soporte) las politicas NUMA no cambian nada.
+
+enum class PaginasGrafo {
+    NORMALES,
+    TRANSPARENTES,
+    EXPLICITAS
+};
+
+enum class DistribucionNuma {
+    PRIMER_TOQUE,
+    ENTRELAZADA,
+    REPLICAS
+};
+
+struct UbicacionGrafo {
+    PaginasGrafo paginas = PaginasGrafo::NORMALES;
+    DistribucionNuma numa = DistribucionNuma::PRIMER_TOQUE;
+};
+
+// Formato: "normal", "thp", "hugetlb", "entrelazada", "replicas" o
+// combinaciones con '+' (ej. "thp+replicas")
+bool parsear_ubicacion(const std::string& texto, UbicacionGrafo& ubicacion);
+std::string nombre_ubicacion(const UbicacionGrafo& ubicacion);
+
+// Bloque de memoria mapeado con una politica. Los datos se copian despues de
+// fijar la politica, que es cuando se asignan las paginas fisicas.
+class RegionMemoria {
+private:
+    void* base = nullptr;
+    size_t bytes = 0;
+    PaginasGrafo paginas_efectivas = PaginasGrafo::NORMALES;
+
+    RegionMemoria() = default;
+
+public:
+    // nodo >= 0 liga la region a ese nodo (replicas); con ENTRELAZADA se
+    // reparte entre todos. nullptr si el sistema no da la memoria.
+    static std::unique_ptr<RegionMemoria> crear(size_t bytes, PaginasGrafo paginas,
+                                                DistribucionNuma numa, int nodo = -1);
+    ~RegionMemoria();
+
+    RegionMemoria(const RegionMemoria&) = delete;
+    RegionMemoria& operator=(const RegionMemoria&) = delete;
+
+    char* datos() const { return static_cast<char*>(base); }
+    size_t tamano() const { return bytes; }
+    PaginasGrafo paginas() const { return paginas_efectivas; }
+
+    void proteger_lectura();     // Replicas: cualquier escritura posterior es un error
+    void permitir_escritura();   // Deshace proteger_lectura (GrafoGrande::set_peso)
+};
+
+// Topologia y afinidad
+int num_nodos_numa();                 // 1 si no hay informacion
+std::vector<int> cpus_del_proceso();  // CPUs permitidas por la mascara actual
+bool fijar_hilo_a_cpu(int cpu);       // Hilo actual; actualiza su nodo NUMA
+
+// Nodo NUMA del hilo actual (se consulta una vez por hilo y al fijarlo)
+int nodo_numa_del_hilo();
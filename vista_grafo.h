@@ -0,0 +1,86 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+
+// Concepto de grafo para las busquedas genericas (busqueda_generica.h).
+//
+// Un tipo Grafo sirve si ofrece:
+//   int num_nodos() const;
+//   template<typename F> void para_cada_vecino(int v, F&& f) const;   // f(vecino, peso)
+//   float x(int v) const;  float y(int v) const;                       // para heuristicas
+//
+// Los algoritmos solo ven ese contrato, asi que el mismo codigo recorre el CSR
+// de la Parte II, los arreglos constexpr del mapa de Arequipa (Parte I) o un
+// grafo implicito. Todo es inline: el compilador elimina la indireccion.
+
+// Indice de arista del CSR de la Parte II. Los nodos siguen siendo int; los
+// offsets son de 64 bits para pasar de 2^31 aristas. Con -DGRAFO_OFFSETS_32
+// (make ... OFFSETS32=1) vuelven a int: la mitad de memoria en offset cuando
+// se sabe que el grafo entra.
+#ifdef GRAFO_OFFSETS_32
+using IndiceArista = int32_t;
+#else
+using IndiceArista = int64_t;
+#endif
+
+// Vista de solo lectura sobre arreglos CSR (offset[n + 1], vecinos, pesos, x, y).
+// No es duena de los datos y no comprueba nada en el lazo caliente. Offset es
+// el tipo de los indices de arista: int para los arreglos fijos de la Parte I,
+// IndiceArista para GrafoGrande (VistaGrande).
+template<typename Peso, typename Offset = int>
+struct VistaCSR {
+    const Offset* offset;
+    const int* vecinos;
+    const Peso* pesos;
+    const float* pos_x;
+    const float* pos_y;
+    int n;
+
+    int num_nodos() const { return n; }
+    int grado(int v) const { return (int)(offset[v + 1] - offset[v]); }
+    float x(int v) const { return pos_x[v]; }
+    float y(int v) const { return pos_y[v]; }
+
+    template<typename F>
+    void para_cada_vecino(int v, F&& f) const {
+        const Offset fin = offset[v + 1];
+        for (Offset i = offset[v]; i < fin; ++i) {
+            f(vecinos[i], static_cast<float>(pesos[i]));
+        }
+    }
+};
+
+// Politicas de heuristica: h(v) estima la distancia de v al destino fijado
+
+struct HeuristicaCero {
+    float operator()(int) const { return 0.0f; }
+};
+
+template<typename Grafo>
+struct HeuristicaEuclidiana {
+    const Grafo& grafo;
+    float destino_x;
+    float destino_y;
+
+    HeuristicaEuclidiana(const Grafo& g, int destino)
+        : grafo(g), destino_x(g.x(destino)), destino_y(g.y(destino)) {}
+
+    float operator()(int v) const {
+        float dx = grafo.x(v) - destino_x;
+        float dy = grafo.y(v) - destino_y;
+        return std::sqrt(dx * dx + dy * dy);
+    }
+};
+
+// h * factor. Con factor = minimo de peso / largo entre las aristas, la
+// euclidiana es admisible y consistente aunque los pesos no sean distancias
+// (lo necesitan las busquedas con cota de busqueda_acotada.h)
+template<typename Heuristica>
+struct HeuristicaEscalada {
+    Heuristica h;
+    float factor;
+
+    HeuristicaEscalada(const Heuristica& h, float factor) : h(h), factor(factor) {}
+
+    float operator()(int v) const { return h(v) * factor; }
+};